@@ -29,6 +29,8 @@
 #include "OrbitOled.h"
 #include "OrbitOledChar.h"
 #include "OrbitOledGrph.h"
+#include "profile.h"
+#include "inc/hw_ssi.h"
 
 /* ------------------------------------------------------------ */
 /*				Local Type Definitions							*/
@@ -76,6 +78,30 @@ char *	pbOledFontUser;
 */
 char	rgbOledBmp[cbOledDispMax];
 
+/* Region of each display memory page that has changed since it was last
+** sent to the display, as an inclusive range of columns. A page is clean
+** when its first dirty column is past its last.
+*/
+unsigned char	rgcolOledDirtyFirst[cpagOledMax];
+unsigned char	rgcolOledDirtyLast[cpagOledMax];
+
+/* Running count of display data bytes sent, for measuring update cost.
+*/
+uint32_t	cbOledSent;
+
+#if defined(OLED_UPDATE_ASYNC)
+/* Column ranges being sent by the interrupt driven update. They are
+** claimed from the dirty ranges when the update starts, so drawing into
+** the buffer can carry on while the transfer runs.
+*/
+unsigned char	rgcolOledXferFirst[cpagOledMax];
+unsigned char	rgcolOledXferLast[cpagOledMax];
+
+volatile int	ipagOledXfer = cpagOledMax;	//page being sent, cpagOledMax when idle
+volatile int	icolOledXfer;		//next column of the page to send
+volatile int	fOledXferData;		//page address sent, now sending data
+#endif
+
 /* ------------------------------------------------------------ */
 /*				Forward Declarations							*/
 /* ------------------------------------------------------------ */
@@ -159,6 +185,14 @@ OrbitOledHostInit()
 	GPIOPinConfigure(SCK_OLED);
 	SSIClockSourceSet(SSI3_BASE, SSI_CLOCK_SYSTEM);
 	SSIConfigSetExpClk(SSI3_BASE, SysCtlClockGet(), SSI_FRF_MOTO_MODE_0, SSI_MODE_MASTER, 8000000, 8);
+#if defined(OLED_UPDATE_ASYNC)
+	/* Raise the transmit interrupt only once the FIFO has emptied and
+	** the last bit has been shifted out, so the Data/Cmd line can be
+	** changed safely from the interrupt handler.
+	*/
+	HWREG(SSI3_BASE + SSI_O_CR1) |= SSI_CR1_EOT;
+	SSIIntRegister(SSI3_BASE, OrbitOledSsiIntHandler);
+#endif
 	SSIEnable(SSI3_BASE);
 
 	/* Make power control pins be outputs with the supplies off
@@ -238,6 +272,11 @@ OrbitOledDvrInit()
 	*/
 	fOledCharUpdate = 1;
 
+	/* The display contents are unknown, so the first update must
+	** send the whole buffer.
+	*/
+	OrbitOledMarkAllDirty();
+
 }
 
 /* ------------------------------------------------------------ */
@@ -361,7 +400,7 @@ OrbitOledClearBuffer()
 	/* Fill the memory buffer with 0.
 	*/
 	for (ib = 0; ib < cbOledDispMax; ib++) {
-		*pb++ = 0x00;
+		OrbitOledWriteByte(pb++, 0x00);
 	}
 
 }
@@ -379,19 +418,175 @@ OrbitOledClearBuffer()
 **		none
 **
 **	Description:
-**		Update the OLED display with the contents of the memory buffer
+**		Update the OLED display with the contents of the memory buffer.
+**		Only the dirty columns of each page are sent.
 */
 
+#if defined(OLED_UPDATE_ASYNC)
 void
 OrbitOledUpdate()
 	{
+	PROFILE_START(PROF_OLED_UPDATE);
 	int		ipag;
-//	int		icol;
-	char *	pb;
+	int		fDirty;
 
-	pb = rgbOledBmp;
+	/* If the previous update is still being sent, leave the dirty
+	** ranges marked and pick them up on the next update.
+	*/
+	if (OrbitOledUpdateBusy()) {
+		PROFILE_END(PROF_OLED_UPDATE);
+		return;
+	}
 
+	/* Claim the dirty ranges for this transfer.
+	*/
+	fDirty = 0;
 	for (ipag = 0; ipag < cpagOledMax; ipag++) {
+		rgcolOledXferFirst[ipag] = rgcolOledDirtyFirst[ipag];
+		rgcolOledXferLast[ipag] = rgcolOledDirtyLast[ipag];
+		if (rgcolOledXferFirst[ipag] <= rgcolOledXferLast[ipag]) {
+			cbOledSent += rgcolOledXferLast[ipag] - rgcolOledXferFirst[ipag] + 1;
+			fDirty = 1;
+		}
+		rgcolOledDirtyFirst[ipag] = ccolOledMax;
+		rgcolOledDirtyLast[ipag] = 0;
+	}
+
+	if (fDirty) {
+		/* The transmitter is idle, so enabling its interrupt starts
+		** the transfer straight away.
+		*/
+		icolOledXfer = 0;
+		fOledXferData = 0;
+		ipagOledXfer = 0;
+		GPIOPinWrite(nCS_OLEDPort, nCS_OLED, LOW);
+		SSIIntEnable(SSI3_BASE, SSI_TXFF);
+	}
+
+	PROFILE_END(PROF_OLED_UPDATE);
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledUpdateBusy
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		nonzero while a display update is being sent
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Report whether the last display update has completed.
+*/
+
+int
+OrbitOledUpdateBusy()
+	{
+
+	return ipagOledXfer < cpagOledMax;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledSsiIntHandler
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		SSI3 end of transmission interrupt. Sends the page address
+**		for the next dirty page, then its data a FIFO load at a
+**		time, and stops the interrupt when all pages are sent.
+*/
+
+void
+OrbitOledSsiIntHandler()
+	{
+	uint32_t	bRx;
+	int			cb;
+	char *		pb;
+
+	/* Throw away the bytes clocked in by the last transmission.
+	*/
+	while (SSIDataGetNonBlocking(SSI3_BASE, &bRx));
+
+	if (fOledXferData) {
+		GPIOPinWrite(nDC_OLEDPort, nDC_OLED, nDC_OLED);
+
+		/* Send the next FIFO load of this page.
+		*/
+		cb = rgcolOledXferLast[ipagOledXfer] - icolOledXfer + 1;
+		if (cb > cbOledSsiFifo) {
+			cb = cbOledSsiFifo;
+		}
+		pb = &rgbOledBmp[ipagOledXfer * ccolOledMax + icolOledXfer];
+		icolOledXfer += cb;
+		while (cb-- > 0) {
+			SSIDataPut(SSI3_BASE, (uint32_t)*pb++);
+		}
+
+		if (icolOledXfer > rgcolOledXferLast[ipagOledXfer]) {
+			fOledXferData = 0;
+			ipagOledXfer++;
+		}
+		return;
+	}
+
+	/* Find the next page with something to send.
+	*/
+	while ((ipagOledXfer < cpagOledMax) &&
+		   (rgcolOledXferFirst[ipagOledXfer] > rgcolOledXferLast[ipagOledXfer])) {
+		ipagOledXfer++;
+	}
+
+	if (ipagOledXfer >= cpagOledMax) {
+		/* All done.
+		*/
+		SSIIntDisable(SSI3_BASE, SSI_TXFF);
+		GPIOPinWrite(nCS_OLEDPort, nCS_OLED, nCS_OLED);
+		return;
+	}
+
+	GPIOPinWrite(nDC_OLEDPort, nDC_OLED, LOW);
+
+	/* Set the page address and start at the first dirty column
+	*/
+	icolOledXfer = rgcolOledXferFirst[ipagOledXfer];
+	SSIDataPut(SSI3_BASE, 0x22);							//Set page command
+	SSIDataPut(SSI3_BASE, ipagOledXfer);					//page number
+	SSIDataPut(SSI3_BASE, 0x00 | (icolOledXfer & 0x0F));	//set low nibble of column
+	SSIDataPut(SSI3_BASE, 0x10 | (icolOledXfer >> 4));		//set high nibble of column
+	fOledXferData = 1;
+
+}
+
+#else
+void
+OrbitOledUpdate()
+	{
+	PROFILE_START(PROF_OLED_UPDATE);
+	int		ipag;
+	int		icolFirst;
+	int		icolLast;
+
+	for (ipag = 0; ipag < cpagOledMax; ipag++) {
+
+		icolFirst = rgcolOledDirtyFirst[ipag];
+		icolLast = rgcolOledDirtyLast[ipag];
+		if (icolFirst > icolLast) {
+			continue;
+		}
+		rgcolOledDirtyFirst[ipag] = ccolOledMax;
+		rgcolOledDirtyLast[ipag] = 0;
 
 		GPIOPinWrite(nDC_OLEDPort, nDC_OLED, LOW);
 
@@ -400,18 +595,116 @@ OrbitOledUpdate()
 		Ssi3PutByte(0x22);		//Set page command
 		Ssi3PutByte(ipag);		//page number
 
-		/* Start at the left column
+		/* Start at the first dirty column
 		*/
-		Ssi3PutByte(0x00);		//set low nibble of column
-		Ssi3PutByte(0x10);		//set high nibble of column
+		Ssi3PutByte(0x00 | (icolFirst & 0x0F));	//set low nibble of column
+		Ssi3PutByte(0x10 | (icolFirst >> 4));	//set high nibble of column
 
 		GPIOPinWrite(nDC_OLEDPort, nDC_OLED, nDC_OLED);
 
-		/* Copy this memory page of display data.
+		/* Copy the dirty part of this memory page of display data.
 		*/
-		OrbitOledPutBuffer(ccolOledMax, pb);
-		pb += ccolOledMax;
+		OrbitOledPutBuffer(icolLast - icolFirst + 1,
+						   &rgbOledBmp[ipag * ccolOledMax + icolFirst]);
+		cbOledSent += icolLast - icolFirst + 1;
+
+	}
+
+	PROFILE_END(PROF_OLED_UPDATE);
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledUpdateBusy
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		always zero, the blocking update completes before returning
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Report whether the last display update has completed.
+*/
+
+int
+OrbitOledUpdateBusy()
+	{
+
+	return 0;
+
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledWriteByte
+**
+**	Parameters:
+**		pb		- pointer to the byte in the display buffer
+**		bVal	- value to write
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Write a byte of the display buffer, marking its column
+**		dirty if the value changes.
+*/
 
+void
+OrbitOledWriteByte(char * pb, char bVal)
+	{
+	int		ib;
+	int		ipag;
+	int		icol;
+
+	if (*pb == bVal) {
+		return;
+	}
+	*pb = bVal;
+
+	ib = pb - rgbOledBmp;
+	ipag = ib / ccolOledMax;
+	icol = ib & (ccolOledMax - 1);
+	if (icol < rgcolOledDirtyFirst[ipag]) {
+		rgcolOledDirtyFirst[ipag] = icol;
+	}
+	if (icol > rgcolOledDirtyLast[ipag]) {
+		rgcolOledDirtyLast[ipag] = icol;
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledMarkAllDirty
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Mark the whole display buffer dirty so the next update
+**		sends all of it.
+*/
+
+void
+OrbitOledMarkAllDirty()
+	{
+	int		ipag;
+
+	for (ipag = 0; ipag < cpagOledMax; ipag++) {
+		rgcolOledDirtyFirst[ipag] = 0;
+		rgcolOledDirtyLast[ipag] = ccolOledMax - 1;
 	}
 
 }
@@ -35,6 +35,14 @@
 #define	chOledUserMax	0x20	//number of character defs in user font table
 #define	cbOledFontUser	(chOledUserMax*cbOledChar)
 
+/* Send display updates from the SSI3 interrupt so that OrbitOledUpdate
+** returns without waiting for the transfer. Comment out to use the
+** original blocking transfer.
+*/
+#define	OLED_UPDATE_ASYNC
+
+#define	cbOledSsiFifo	8		//depth of the SSI transmit FIFO
+
 /* Graphics drawing modes.
 */
 #define	modOledSet		0
@@ -66,6 +74,10 @@ void	OrbitOledInit();
 void	OrbitOledClear();
 void	OrbitOledClearBuffer();
 void	OrbitOledUpdate();
+void	OrbitOledWriteByte(char * pb, char bVal);
+void	OrbitOledMarkAllDirty();
+int		OrbitOledUpdateBusy();
+void	OrbitOledSsiIntHandler();
 
 /* ------------------------------------------------------------ */
 
@@ -339,7 +339,7 @@ OrbitOledDrawGlyph(char ch)
 	pbBmp = pbOledCur;
 
 	for (ib = 0; ib < dxcoOledFontCur; ib++) {
-		*pbBmp++ = *pbFont++;
+		OrbitOledWriteByte(pbBmp++, *pbFont++);
 	}
 
 }
@@ -23,6 +23,8 @@
 /*				Include File Definitions						*/
 /* ------------------------------------------------------------ */
 
+#include <stdlib.h>
+
 #include "FillPat.h"
 #include "LaunchPad.h"
 #include "OrbitBoosterPackDefs.h"
@@ -304,7 +306,8 @@ void
 OrbitOledDrawPixel()
 	{
 
-	*pbOledCur = (*pfnDoRop)((clrOledCur << bnOledCur), *pbOledCur, (1<<bnOledCur));
+	OrbitOledWriteByte(pbOledCur,
+		(*pfnDoRop)((clrOledCur << bnOledCur), *pbOledCur, (1<<bnOledCur)));
 
 }
 
@@ -559,7 +562,8 @@ OrbitOledFillRect(int xco, int yco)
 		** of the rectangle.
 		*/
 		while (xcoCur <= xcoRight) {
-			*pbCur = (*pfnDoRop)(*(pbOledPatCur+ibPat), *pbCur, ~mskPat);
+			OrbitOledWriteByte(pbCur,
+				(*pfnDoRop)(*(pbOledPatCur+ibPat), *pbCur, ~mskPat));
 			xcoCur += 1;
 			pbCur += 1;
 			ibPat += 1;
@@ -763,7 +767,8 @@ OrbitOledPutBmp(int dxco, int dyco, char * pbBits)
 		*/
 		if (bnAlign == 0) {
 			while (xcoCur < xcoRight) {
-				*pbDspCur = (*pfnDoRop)(*pbBmpCur, *pbDspCur, mskEnd);
+				OrbitOledWriteByte(pbDspCur,
+					(*pfnDoRop)(*pbBmpCur, *pbDspCur, mskEnd));
 				xcoCur += 1;
 				pbDspCur += 1;
 				pbBmpCur += 1;
@@ -776,7 +781,8 @@ OrbitOledPutBmp(int dxco, int dyco, char * pbBits)
 					bBmp |= ((*(pbBmpCur - dxco) >> (8-bnAlign)) & ~mskLower);
 				}
 				bBmp &= mskEnd;
-				*pbDspCur = (*pfnDoRop)(bBmp, *pbDspCur, mskEnd);
+				OrbitOledWriteByte(pbDspCur,
+					(*pfnDoRop)(bBmp, *pbDspCur, mskEnd));
 				xcoCur += 1;
 				pbDspCur += 1;
 				pbBmpCur += 1;
@@ -12,92 +12,173 @@
 //*****************************************************************************
 
 #include "PID.h"
+#include "pid_gains.h"
 
 //*****************************************************************************
-// Constants
+// Gains, from pid_gains.h. They are variables so a test harness can set them
+// before the controllers are set up from them.
 //*****************************************************************************
-float ALT_KP = 0.6;
-float ALT_KI = 0.0093;
-float ALT_KD = 0.5;
-float YAW_KP = 1.0;
-float YAW_KI = 0.0009;
-float YAW_KD = 2.0;
+pidval_t ALT_KP = PID_FROM_FLOAT(PID_GAIN_ALT_KP);
+pidval_t ALT_KI = PID_FROM_FLOAT(PID_GAIN_ALT_KI);
+pidval_t ALT_KD = PID_FROM_FLOAT(PID_GAIN_ALT_KD);
+pidval_t YAW_KP = PID_FROM_FLOAT(PID_GAIN_YAW_KP);
+pidval_t YAW_KI = PID_FROM_FLOAT(PID_GAIN_YAW_KI);
+pidval_t YAW_KD = PID_FROM_FLOAT(PID_GAIN_YAW_KD);
+pidval_t ALT_KB = PID_FROM_FLOAT(PID_ALT_KB);
+pidval_t YAW_KB = PID_FROM_FLOAT(PID_YAW_KB);
+uint8_t ALT_ANTI_WINDUP = PID_ALT_ANTI_WINDUP;
+uint8_t YAW_ANTI_WINDUP = PID_YAW_ANTI_WINDUP;
+uint8_t ALT_D_SOURCE = PID_ALT_D_SOURCE;
+uint8_t YAW_D_SOURCE = PID_YAW_D_SOURCE;
+uint8_t ALT_D_FILTER = PID_ALT_D_FILTER;
+uint8_t YAW_D_FILTER = PID_YAW_D_FILTER;
+pidval_t ALT_D_CUTOFF = PID_FROM_FLOAT(PID_ALT_D_CUTOFF);
+pidval_t YAW_D_CUTOFF = PID_FROM_FLOAT(PID_YAW_D_CUTOFF);
 
 //*****************************************************************************
-// Initiaslise yaw error control gains within a given yaw struct. For use
-// within the main gadfly loop.
+// Set up a controller for use within the main gadfly loop
 //*****************************************************************************
-void initYawPID(PIDError *yawState)
+void pidInit(PIDController *pid, pidval_t kp, pidval_t ki, pidval_t kd,
+             pidval_t outMin, pidval_t outMax, pidval_t dt)
 {
-	yawState->derivative = 0.0;
-	yawState->integrated = 0.0;
-	yawState->previous = 0.0;
+	pid->kp = kp;
+	pid->ki = ki;
+	pid->kd = kd;
+	pid->outMin = outMin;
+	pid->outMax = outMax;
+	pid->dt = dt;
+	pid->feedforward = 0;
+	pidSetAntiWindup(pid, PID_AW_NONE, 0);
+	pidSetDerivative(pid, PID_D_ON_ERROR, PID_DF_NONE, 0);
+	pidReset(pid);
 }
 
-//*****************************************************************************
-// Initiaslise yaw error control gains within a given alt struct. For use
-// within the main gadfly loop.
-//*****************************************************************************
-void initAltPID(PIDError *altState)
+void pidReset(PIDController *pid)
 {
-	altState->derivative = 0.0;
-	altState->integrated = 0.0;
-	altState->previous = 0.0;
+	pid->derivative = 0;
+	pid->integrated = 0;
+	pid->bias = 0;
+	pid->previous = 0;
+	pid->output = 0;
+	pid->x1 = 0;
+	pid->x2 = 0;
+	pid->y2 = 0;
+	pid->primed = false;
 }
 
 //*****************************************************************************
-// Return adjustment PID controls for current yaw and altitude based on the 
-// current state and variable values of the heli-rig. Essentially produces
-// and error control PWM value for altitude and yaw which pushes/maintains
-// the helicopter towards it's current set points.
+// Integrated error at which the integral term alone reaches output. Without
+// an integral gain there is no limit.
 //*****************************************************************************
-float * PIDUpdate(uint32_t deltaT, int16_t actualAlt, float actualYaw,
-                  uint8_t desiredAlt, int16_t desiredYaw, 
-                  PIDError *yawErrorState,
-                  PIDError *altErrorState)
+static pidval_t pidIntegralLimit(pidval_t output, pidval_t ki)
+{
+#ifdef PID_FIXED_POINT
+	int64_t limit = ((int64_t)output << PID_Q_BITS) / ki;
+	return (limit > INT32_MAX) ? INT32_MAX
+		: (limit < INT32_MIN) ? INT32_MIN : (pidval_t)limit;
+#else
+	return output / ki;
+#endif
+}
+
+void pidSetGains(PIDController *pid, pidval_t kp, pidval_t ki, pidval_t kd)
 {
+	pidacc_t term;
+#ifdef PID_FIXED_POINT
+	pidacc_t integrated = 0;
+#endif
+
+	pid->kp = kp;
+	pid->kd = kd;
+	if (ki == pid->ki) {
+		return;
+	}
+
+	// The integral term, with any bias, goes back into the integrated error
+	// at the new KI. Without a KI, or in fixed point if the integrated error
+	// would not fit, the term is held as the bias instead.
+#ifdef PID_FIXED_POINT
+	term = (int64_t)pid->integrated * pid->ki
+		+ ((int64_t)pid->bias << PID_Q_BITS);		// Q32.32
+	if (ki != 0) {
+		integrated = term / ki;
+	}
+	if (ki != 0 && integrated >= INT32_MIN && integrated <= INT32_MAX) {
+		pid->integrated = (pidval_t)integrated;
+		pid->bias = 0;
+	} else {
+		pid->integrated = 0;
+		pid->bias = pidNarrow(term >> PID_Q_BITS);
+	}
+#else
+	term = pid->integrated * pid->ki + pid->bias;
+	if (ki != 0) {
+		pid->integrated = term / ki;
+		pid->bias = 0;
+	} else {
+		pid->integrated = 0;
+		pid->bias = term;
+	}
+#endif
+	pid->ki = ki;
+	// The clamp limits depend on KI
+	pidSetAntiWindup(pid, pid->antiWindup, pid->kb);
+}
 
+void pidSetAntiWindup(PIDController *pid, uint8_t mode, pidval_t kb)
+{
+	pid->antiWindup = mode;
+	pid->kb = kb;
+	if (pid->ki > 0) {
+		pid->iMin = pidIntegralLimit(pid->outMin, pid->ki);
+		pid->iMax = pidIntegralLimit(pid->outMax, pid->ki);
+	} else {
+		pid->iMin = -PID_VAL_MAX;
+		pid->iMax = PID_VAL_MAX;
+	}
+}
 
-	//calculate current error values
-	double yawError = (double)desiredYaw - (double)actualYaw;
-	double altError = (double)desiredAlt - (double)actualAlt;
-	
-	//init variables
-	double yawErrorIntegrated, yawErrorDerivative;
-	double altErrorIntegrated, altErrorDerivative;
-	
-	//calculate and store integrated error values
-	yawErrorState->integrated += yawError * (double)deltaT;
-	yawErrorIntegrated = yawErrorState->integrated;
-	altErrorState->integrated += altError * (double)deltaT;
-	altErrorIntegrated = altErrorState->integrated;
-	
-	//calculate and store derivative error values
-	yawErrorState->derivative = (yawError - yawErrorState->previous) / (double)deltaT ;
-	yawErrorDerivative = yawErrorState->derivative;
-	altErrorState->derivative = (altError - altErrorState->previous) / (double)deltaT ;
-	altErrorDerivative = altErrorState->derivative;
-	
-	//calculate and store a yaw control value 
-	float yawControl = yawError * YAW_KP //yaw proportional gain
-		+ YAW_KI * yawErrorIntegrated
-		+ YAW_KD * yawErrorDerivative;
-	yawControl = (yawControl < 5) ? 5 : (yawControl > 95) ? 95 : yawControl;
-	
-	//calculate and store a altitude control value 	
-	float altControl = altError * ALT_KP //altitide proportional gain
-		+ ALT_KI * altErrorIntegrated
-		+ ALT_KD * altErrorDerivative;
-	altControl = (altControl < 5) ? 5 : (altControl > 95) ? 95 : altControl;
-	
-	yawErrorState->previous = yawError;
-	altErrorState->previous = altError;
-	
-	static float controls[2];
-	controls[0] = yawControl;
-	controls[1] = altControl;
-	//USE THESE CONTROL VALUES TO ADJUST MAIN/TAIL DUTIES DIRECTLY	
-	
-	return controls;
+void pidSetDerivative(PIDController *pid, uint8_t source, uint8_t filter,
+                      pidval_t cutoffHz)
+{
+	pid->dSource = source;
+	pid->dFilter = filter;
+	pid->dCutoff = cutoffHz;
+	pidFilterCoefficients(pid);
 }
 
+//*****************************************************************************
+// The biquad is a bilinear transform Butterworth with tan(pi fc dt) taken as
+// pi fc dt, which is close while the cutoff is well under the 250 Hz Nyquist
+// frequency and keeps the sums in range in fixed point.
+//*****************************************************************************
+void pidFilterCoefficients(PIDController *pid)
+{
+	const pidval_t one = PID_FROM_INT(1);
+	const pidval_t root2 = PID_FROM_FLOAT(1.41421356f);
+	pidval_t w, k, kk, norm;
+
+	pid->b0 = one;
+	pid->b1 = 0;
+	pid->b2 = 0;
+	pid->a1 = 0;
+	pid->a2 = 0;
+	switch (pid->dFilter) {
+	case PID_DF_FIRST_ORDER:
+		// y = alpha x + (1 - alpha) y1
+		w = PID_MUL(PID_MUL(PID_FROM_FLOAT(6.28318531f), pid->dCutoff), pid->dt);
+		pid->b0 = PID_DIV(w, one + w);
+		pid->a1 = pid->b0 - one;
+		break;
+	case PID_DF_BIQUAD:
+		k = PID_MUL(PID_MUL(PID_FROM_FLOAT(3.14159265f), pid->dCutoff), pid->dt);
+		kk = PID_MUL(k, k);
+		norm = PID_DIV(one, one + PID_MUL(root2, k) + kk);
+		pid->b0 = PID_MUL(kk, norm);
+		pid->b1 = 2 * pid->b0;
+		pid->b2 = pid->b0;
+		pid->a1 = PID_MUL(2 * (kk - one), norm);
+		pid->a2 = PID_MUL(one - PID_MUL(root2, k) + kk, norm);
+		break;
+	}
+}
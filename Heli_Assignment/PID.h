@@ -10,36 +10,313 @@
 #define PID_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <float.h>
 
 //*****************************************************************************
-// PID struct to maintain error values and store the previous error for use of
-// the main PID function
+// Number format used by the control law. The Cortex-M4F FPU only does single
+// precision, so the default is float. Define PID_FIXED_POINT to run the
+// control law in Q16.16 fixed point instead. The control tick then does
+// without the FPU, from the yaw ticks in to the duties out; the display,
+// serial status and telemetry still convert to float for their output.
+//*****************************************************************************
+//#define PID_FIXED_POINT
+
+#ifdef PID_FIXED_POINT
+typedef int32_t pidval_t;   // Q16.16
+typedef int64_t pidacc_t;   // Wide accumulator for summing terms
+#define PID_Q_BITS          16
+#define PID_ONE             ((pidval_t)1 << PID_Q_BITS)
+#define PID_FROM_FLOAT(x)   ((pidval_t)((x) * (float)PID_ONE))
+#define PID_FROM_INT(x)     ((pidval_t)(x) * PID_ONE)
+#define PID_TO_FLOAT(x)     ((float)(x) / (float)PID_ONE)
+#define PID_TO_INT(x)       ((int32_t)((x) / PID_ONE))  // Towards zero
+#define PID_MUL(a, b)       ((pidval_t)(((int64_t)(a) * (b)) >> PID_Q_BITS))
+#define PID_DIV(a, b)       ((pidval_t)(((int64_t)(a) * PID_ONE) / (b)))
+#define PID_VAL_MAX         INT32_MAX
+#else
+typedef float pidval_t;
+typedef float pidacc_t;
+#define PID_FROM_FLOAT(x)   ((pidval_t)(x))
+#define PID_FROM_INT(x)     ((pidval_t)(x))
+#define PID_TO_FLOAT(x)     ((float)(x))
+#define PID_TO_INT(x)       ((int32_t)(x))
+#define PID_MUL(a, b)       ((a) * (b))
+#define PID_DIV(a, b)       ((a) / (b))
+#define PID_VAL_MAX         FLT_MAX
+#endif
+
+#define PID_OUTPUT_MIN PID_FROM_INT(5)     // Duty limits, percent
+#define PID_OUTPUT_MAX PID_FROM_INT(95)
+
+//*****************************************************************************
+// Anti-windup strategies, which stop the integrated error growing while the
+// output sits at a limit
+//*****************************************************************************
+enum pidAntiWindup {
+	PID_AW_NONE = 0,		// Always integrate
+	PID_AW_CLAMP,			// Keep the integral term within the output limits
+	PID_AW_BACK_CALC,		// Integrate kb times the output lost to the limits
+	PID_AW_CONDITIONAL,		// Hold the integral while the output is at a
+							// limit and the error pushes it further
+	PID_AW_NUM_MODES
+};
+
+// Anti-windup of each axis. The back-calculation gain is 1 / (KI * Tt) to
+// unwind the integral with a time constant of Tt seconds. With the torque
+// feedforward carrying the tail's steady duty, the yaw integral only has a
+// small residual to find, and back-calculation left it wound up after each
+// turn.
+#define PID_ALT_ANTI_WINDUP PID_AW_CLAMP
+#define PID_YAW_ANTI_WINDUP PID_AW_CONDITIONAL
+#define PID_ALT_KB 8.0f         // Tt of 1 s
+#define PID_YAW_KB 50.0f        // Tt of 1.7 s
+
+//*****************************************************************************
+// What the derivative term differentiates. The error steps with the setpoint,
+// so each button press kicks the output; the measurement does not.
+//*****************************************************************************
+enum pidDerivativeSource {
+	PID_D_ON_ERROR = 0,
+	PID_D_ON_MEASUREMENT,
+	PID_D_NUM_SOURCES
+};
+
+//*****************************************************************************
+// Low-pass filters on the derivative, against the sensor quantisation noise
+//*****************************************************************************
+enum pidDerivativeFilter {
+	PID_DF_NONE = 0,
+	PID_DF_FIRST_ORDER,		// Exponential smoothing, -20 dB/decade
+	PID_DF_BIQUAD,			// Second order Butterworth, -40 dB/decade
+	PID_DF_NUM_FILTERS
+};
+
+// Derivative of each axis, and the filter cutoff in Hz
+#define PID_ALT_D_SOURCE PID_D_ON_MEASUREMENT
+#define PID_YAW_D_SOURCE PID_D_ON_MEASUREMENT
+#define PID_ALT_D_FILTER PID_DF_BIQUAD
+#define PID_YAW_D_FILTER PID_DF_BIQUAD
+#define PID_ALT_D_CUTOFF 10.0f
+#define PID_YAW_D_CUTOFF 10.0f
+
+//*****************************************************************************
+// A single-axis PID controller: its gains, output limits and sample time,
+// and the state it carries between updates. Set up with pidInit.
 //*****************************************************************************
 typedef struct {
-	double derivative;
-	double integrated;
-	double previous;
-} PIDError;
+	pidval_t kp;
+	pidval_t ki;
+	pidval_t kd;
+	pidval_t outMin;		// Output limits
+	pidval_t outMax;
+	pidval_t dt;		// Sample time, s
+	uint8_t antiWindup;	// enum pidAntiWindup
+	pidval_t kb;		// Back-calculation gain
+	pidval_t iMin;		// Integrated error limits for PID_AW_CLAMP
+	pidval_t iMax;
+	uint8_t dSource;	// enum pidDerivativeSource
+	uint8_t dFilter;	// enum pidDerivativeFilter
+	pidval_t dCutoff;	// Derivative filter cutoff, Hz
+	pidval_t b0, b1, b2, a1, a2;	// Derivative filter coefficients
+	pidval_t x1, x2;	// Last two unfiltered derivatives
+	pidval_t y2;		// Filtered derivative before last
+	pidval_t lastMeasured;
+	bool primed;		// lastMeasured holds a measurement
+	pidval_t feedforward;	// Added to the output before it is limited
+	pidval_t derivative;	// Filtered
+	pidval_t integrated;
+	pidval_t bias;		// Integral term held while KI is 0
+	pidval_t previous;	// Error at the last update
+	pidval_t output;
+} PIDController;
 
 //*****************************************************************************
-// Initialize yaw error control gains
+// Controller gains, initialised from pid_gains.h
 //*****************************************************************************
-void initYawPID(PIDError *yawState);
+extern pidval_t ALT_KP, ALT_KI, ALT_KD, ALT_KB;
+extern pidval_t YAW_KP, YAW_KI, YAW_KD, YAW_KB;
+extern uint8_t ALT_ANTI_WINDUP, YAW_ANTI_WINDUP;
+extern uint8_t ALT_D_SOURCE, YAW_D_SOURCE, ALT_D_FILTER, YAW_D_FILTER;
+extern pidval_t ALT_D_CUTOFF, YAW_D_CUTOFF;
 
 //*****************************************************************************
-// Initialize altitude error control gains
+// Set the gains, output limits and sample time of a controller and clear its
+// state. Anti-windup starts off, the derivative is of the unfiltered error
+// and there is no feedforward.
 //*****************************************************************************
-void initAltPID(PIDError *altState);
+void pidInit(PIDController *pid, pidval_t kp, pidval_t ki, pidval_t kd,
+             pidval_t outMin, pidval_t outMax, pidval_t dt);
 
 //*****************************************************************************
-// Update the PID values
+// Clear the integrated, derivative and previous error, the bias and the
+// derivative filter
 //*****************************************************************************
-float * PIDUpdate(uint32_t deltaT, int16_t actualAlt, float actualYaw,
-                  uint8_t desiredAlt, int16_t desiredYaw, 
-                  PIDError *yawErrorState,
-                  PIDError *altErrorState);
+void pidReset(PIDController *pid);
 
-#endif /* PID_H_ */
+//*****************************************************************************
+// Change the gains of a running controller. The integrated error is scaled
+// to keep the integral term the same, so a change of KI does not bump the
+// output. Setting KI to 0 holds the integral term as a fixed bias, which the
+// integrated error takes back when KI is set again.
+//*****************************************************************************
+void pidSetGains(PIDController *pid, pidval_t kp, pidval_t ki, pidval_t kd);
+
+//*****************************************************************************
+// Choose the anti-windup strategy, after the gains and limits are set. kb is
+// only used by PID_AW_BACK_CALC.
+//*****************************************************************************
+void pidSetAntiWindup(PIDController *pid, uint8_t mode, pidval_t kb);
+
+//*****************************************************************************
+// Choose what the derivative term differentiates and how it is filtered.
+// cutoffHz is not used by PID_DF_NONE.
+//*****************************************************************************
+void pidSetDerivative(PIDController *pid, uint8_t source, uint8_t filter,
+                      pidval_t cutoffHz);
+
+//*****************************************************************************
+// Work out the derivative filter coefficients for the cutoff and sample time
+//*****************************************************************************
+void pidFilterCoefficients(PIDController *pid);
 
+//*****************************************************************************
+// Time taken by ticks periods of a rateHz timer, in seconds. Worked out from
+// the rate rather than a whole number of milliseconds, which is not exact
+// for most rates.
+//*****************************************************************************
+static inline pidval_t pidTicksToDt(uint32_t ticks, uint32_t rateHz)
+{
+#ifdef PID_FIXED_POINT
+	return (pidval_t)(((int64_t)ticks << PID_Q_BITS) / rateHz);
+#else
+	return (pidval_t)ticks / rateHz;
+#endif
+}
+
+//*****************************************************************************
+// Narrows a sum to a value. In fixed point it saturates rather than wrapping
+// around.
+//*****************************************************************************
+static inline pidval_t pidNarrow(pidacc_t sum)
+{
+#ifdef PID_FIXED_POINT
+	if (sum > INT32_MAX) {
+		sum = INT32_MAX;
+	} else if (sum < INT32_MIN) {
+		sum = INT32_MIN;
+	}
+#endif
+	return (pidval_t)sum;
+}
+
+//*****************************************************************************
+// Adds an increment to an integrated error
+//*****************************************************************************
+static inline pidval_t pidIntegrate(pidval_t integrated, pidacc_t increment)
+{
+	return pidNarrow((pidacc_t)integrated + increment);
+}
+
+//*****************************************************************************
+// Differentiates the error or the measurement and filters the result. Both
+// filters run as one direct form I biquad; the first order filter just has
+// the second order coefficients at zero.
+//*****************************************************************************
+static inline pidval_t pidDerivative(PIDController *pid, pidval_t error,
+                                     pidval_t measured)
+{
+	pidval_t raw;
+	pidval_t filtered;
+
+	if (pid->dSource == PID_D_ON_MEASUREMENT) {
+		// The setpoint is steady between presses, so the error changes by
+		// minus the change in the measurement
+		if (!pid->primed) {
+			pid->lastMeasured = measured;
+			pid->primed = true;
+		}
+		raw = PID_DIV(pid->lastMeasured - measured, pid->dt);
+		pid->lastMeasured = measured;
+	} else {
+		raw = PID_DIV(error - pid->previous, pid->dt);
+	}
+	if (pid->dFilter == PID_DF_NONE) {
+		return raw;
+	}
+
+	filtered = pidNarrow((pidacc_t)PID_MUL(pid->b0, raw)
+		+ PID_MUL(pid->b1, pid->x1) + PID_MUL(pid->b2, pid->x2)
+		- PID_MUL(pid->a1, pid->derivative) - PID_MUL(pid->a2, pid->y2));
+	pid->x2 = pid->x1;
+	pid->x1 = raw;
+	pid->y2 = pid->derivative;
+	return filtered;
+}
+
+//*****************************************************************************
+// Limits a control value to the output range of a controller
+//*****************************************************************************
+static inline pidval_t pidClamp(const PIDController *pid, pidacc_t control)
+{
+	return (control < pid->outMin) ? pid->outMin
+		: (control > pid->outMax) ? pid->outMax : (pidval_t)control;
+}
+
+//*****************************************************************************
+// Update a controller and return its new output. dt is the time since the
+// last update; the derivative filter is only recalculated when it differs
+// from the sample time. The feedforward is added before the output is
+// limited, so the anti-windup sees the output that was really set. Inline,
+// so each loop compiles to straight-line code.
+//*****************************************************************************
+static inline pidval_t pidUpdate(PIDController *pid, pidval_t setpoint,
+                                 pidval_t measured, pidval_t dt)
+{
+	pidval_t error = setpoint - measured;
+	pidacc_t control;
+
+	if (dt != pid->dt) {
+		pid->dt = dt;
+		pidFilterCoefficients(pid);
+	}
+
+	// Conditional integration holds while integrating would only push the
+	// output further past its limit
+	if (pid->antiWindup != PID_AW_CONDITIONAL
+			|| !((pid->output >= pid->outMax && error > 0)
+				|| (pid->output <= pid->outMin && error < 0))) {
+		pid->integrated = pidIntegrate(pid->integrated, PID_MUL(error, pid->dt));
+	}
+	if (pid->antiWindup == PID_AW_CLAMP) {
+		pid->integrated = (pid->integrated < pid->iMin) ? pid->iMin
+			: (pid->integrated > pid->iMax) ? pid->iMax : pid->integrated;
+	}
+
+	pid->derivative = pidDerivative(pid, error, measured);
+	control = (pidacc_t)pid->feedforward + pid->bias + PID_MUL(error, pid->kp)
+		+ PID_MUL(pid->ki, pid->integrated)
+		+ PID_MUL(pid->kd, pid->derivative);
+	pid->output = pidClamp(pid, control);
+
+	// Back-calculation feeds the output lost to the limits back into the
+	// integral, ready for the next update
+	if (pid->antiWindup == PID_AW_BACK_CALC) {
+		pid->integrated = pidIntegrate(pid->integrated,
+			PID_MUL(PID_MUL(pid->kb, pidNarrow(pid->output - control)), pid->dt));
+	}
+	pid->previous = error;
+	return pid->output;
+}
+
+//*****************************************************************************
+// True if the last output was at one of the limits
+//*****************************************************************************
+static inline bool pidSaturated(const PIDController *pid)
+{
+	return pid->output <= pid->outMin || pid->output >= pid->outMax;
+}
+
+#endif /* PID_H_ */
@@ -0,0 +1,115 @@
+//*****************************************************************************
+//
+// adc_dma.c - Hardware-triggered ADC acquisition into uDMA ping-pong
+//             buffers. Timer0 (or the PWM) triggers ADC0 sequence 3 and the
+//             uDMA copies each sample out of the FIFO, so the CPU is only
+//             interrupted once per block rather than twice per sample.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "adc_dma.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_adc.h"
+#include "inc/hw_ints.h"
+#include "driverlib/adc.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/udma.h"
+
+#define ADC_DMA_CHANNEL UDMA_CHANNEL_ADC3
+#define ADC_DMA_FIFO    ((void *)(ADC0_BASE + ADC_O_SSFIFO3))
+
+//*****************************************************************************
+// The uDMA control table must be 1024-byte aligned
+//*****************************************************************************
+#if defined(ccs)
+#pragma DATA_ALIGN(g_dmaControlTable, 1024)
+static uint8_t g_dmaControlTable[1024];
+#else
+static uint8_t g_dmaControlTable[1024] __attribute__ ((aligned(1024)));
+#endif
+
+static uint16_t g_pingBuffer[ADC_DMA_BLOCK_SIZE];
+static uint16_t g_pongBuffer[ADC_DMA_BLOCK_SIZE];
+static adcBlockHandler_t g_blockHandler;
+
+//*****************************************************************************
+// Re-arm one half of the ping-pong transfer into the given buffer
+//*****************************************************************************
+static void armTransfer(uint32_t channelSelect, uint16_t *buffer)
+{
+    uDMAChannelTransferSet(ADC_DMA_CHANNEL | channelSelect, UDMA_MODE_PINGPONG,
+                           ADC_DMA_FIFO, buffer, ADC_DMA_BLOCK_SIZE);
+}
+
+//*****************************************************************************
+// Interrupt handler for a completed ping or pong transfer. Whichever half has
+// stopped is passed on for processing and then re-armed, while the uDMA keeps
+// filling the other half.
+//*****************************************************************************
+void ADCDMAIntHandler(void)
+{
+    ADCIntClear(ADC0_BASE, 3);
+    if (uDMAChannelModeGet(ADC_DMA_CHANNEL | UDMA_PRI_SELECT) == UDMA_MODE_STOP) {
+        g_blockHandler(g_pingBuffer, ADC_DMA_BLOCK_SIZE);
+        armTransfer(UDMA_PRI_SELECT, g_pingBuffer);
+    }
+    if (uDMAChannelModeGet(ADC_DMA_CHANNEL | UDMA_ALT_SELECT) == UDMA_MODE_STOP) {
+        g_blockHandler(g_pongBuffer, ADC_DMA_BLOCK_SIZE);
+        armTransfer(UDMA_ALT_SELECT, g_pongBuffer);
+    }
+}
+
+//*****************************************************************************
+// Initialise ADC0 sequence 3 and the uDMA controller so that samples are
+// handed to blockHandler one block at a time. trigger is an ADC_TRIGGER_*
+// source; for ADC_TRIGGER_TIMER, Timer0 is set up to run at sampleRateHz.
+//*****************************************************************************
+void initADCDMA(uint32_t trigger, uint32_t sampleRateHz,
+                adcBlockHandler_t blockHandler)
+{
+    g_blockHandler = blockHandler;
+
+    // uDMA controller and channel set up for 16-bit FIFO to memory transfers
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    uDMAEnable();
+    uDMAControlBaseSet(g_dmaControlTable);
+    uDMAChannelAssign(UDMA_CH17_ADC0_3);
+    uDMAChannelAttributeDisable(ADC_DMA_CHANNEL, UDMA_ATTR_ALTSELECT |
+                                UDMA_ATTR_USEBURST | UDMA_ATTR_HIGH_PRIORITY |
+                                UDMA_ATTR_REQMASK);
+    uDMAChannelControlSet(ADC_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_SIZE_16 |
+                          UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1);
+    uDMAChannelControlSet(ADC_DMA_CHANNEL | UDMA_ALT_SELECT, UDMA_SIZE_16 |
+                          UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1);
+    armTransfer(UDMA_PRI_SELECT, g_pingBuffer);
+    armTransfer(UDMA_ALT_SELECT, g_pongBuffer);
+    uDMAChannelEnable(ADC_DMA_CHANNEL);
+
+    // Sequence 3 takes a single sample of the altitude channel per
+    // trigger. The step interrupt flag is what raises the uDMA request; the
+    // per-sample interrupt itself stays masked in the ADC so only the uDMA
+    // completion reaches the NVIC.
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    ADCSequenceConfigure(ADC0_BASE, 3, trigger, 0);
+    ADCSequenceStepConfigure(ADC0_BASE, 3, 0, ADC_CTL_CH9 | ADC_CTL_IE |
+                             ADC_CTL_END);
+    ADCSequenceDMAEnable(ADC0_BASE, 3);
+    ADCSequenceEnable(ADC0_BASE, 3);
+    ADCIntDisable(ADC0_BASE, 3);
+    IntRegister(INT_ADC0SS3, ADCDMAIntHandler);
+    IntEnable(INT_ADC0SS3);
+
+    // Timer0 provides the sample clock unless another trigger was chosen
+    if (trigger == ADC_TRIGGER_TIMER) {
+        SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
+        TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
+        TimerLoadSet(TIMER0_BASE, TIMER_A, SysCtlClockGet() / sampleRateHz);
+        TimerControlTrigger(TIMER0_BASE, TIMER_A, true);
+        TimerEnable(TIMER0_BASE, TIMER_A);
+    }
+}
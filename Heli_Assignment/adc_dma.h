@@ -0,0 +1,37 @@
+//*****************************************************************************
+//
+// adc_dma.h - Header file for timer-triggered ADC acquisition into uDMA
+//             ping-pong buffers
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef ADC_DMA_H_
+#define ADC_DMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADC_DMA_BLOCK_SIZE 32   // Samples per ping-pong half
+
+//*****************************************************************************
+// Called from the ADC interrupt with each completed block of samples
+//*****************************************************************************
+typedef void (*adcBlockHandler_t)(const uint16_t *samples, uint32_t count);
+
+//*****************************************************************************
+// Initialise ADC0 sequence 3 and the uDMA controller so that samples are
+// handed to blockHandler one block at a time. trigger is an ADC_TRIGGER_*
+// source; for ADC_TRIGGER_TIMER, Timer0 is set up to run at sampleRateHz.
+//*****************************************************************************
+void initADCDMA(uint32_t trigger, uint32_t sampleRateHz,
+                adcBlockHandler_t blockHandler);
+
+//*****************************************************************************
+// Interrupt handler for a completed ping or pong transfer
+//*****************************************************************************
+void ADCDMAIntHandler(void);
+
+#endif /* ADC_DMA_H_ */
@@ -24,6 +24,9 @@ initCircBuf (circBuf_t *buffer, uint32_t size)
 	buffer->windex = 0;
 	buffer->rindex = 0;
 	buffer->size = size;
+	buffer->writes = 0;
+	buffer->sum = 0;
+	buffer->sumSq = 0;
 	buffer->data = 
         (uint32_t *) calloc (size, sizeof(uint32_t));
 	return buffer->data;
@@ -32,10 +35,16 @@ initCircBuf (circBuf_t *buffer, uint32_t size)
 
 // *******************************************************
 // writeCircBuf: insert entry at the current windex location,
-// advance windex, modulo (buffer size).
+// advance windex, modulo (buffer size). The running sums are updated
+// by swapping the overwritten entry out for the new one.
 void
 writeCircBuf (circBuf_t *buffer, uint32_t entry)
 {
+	uint32_t oldEntry = buffer->data[buffer->windex];
+
+	buffer->sum += entry - oldEntry;
+	buffer->sumSq += (uint64_t)entry * entry - (uint64_t)oldEntry * oldEntry;
+	buffer->writes++;
 	buffer->data[buffer->windex] = entry;
 	buffer->windex++;
 	if (buffer->windex >= buffer->size)
@@ -58,6 +67,50 @@ readCircBuf (circBuf_t *buffer)
     return entry;
 }
 
+// *******************************************************
+// sumCircBuf: return the sum of all entries in the buffer. A single
+// 32-bit read, so it can never see a half-updated value.
+uint32_t
+sumCircBuf (circBuf_t *buffer)
+{
+	return buffer->sum;
+}
+
+// *******************************************************
+// meanCircBuf: return the mean of all entries in the buffer,
+// rounded to the nearest integer.
+uint32_t
+meanCircBuf (circBuf_t *buffer)
+{
+	return (buffer->sum + buffer->size / 2) / buffer->size;
+}
+
+// *******************************************************
+// varianceCircBuf: return the population variance of all entries
+// in the buffer. The sum and sum of squares are snapshotted together,
+// retrying if the buffer was written to part way through. The
+// variance is (size * sumSq - sum^2) / size^2, with the numerator
+// worked out exactly in 64 bits, so the two terms do not cancel in
+// float. It fits while size^2 * entry^2 does: 12-bit ADC samples
+// allow a million entries.
+float
+varianceCircBuf (circBuf_t *buffer)
+{
+	uint32_t writes;
+	uint32_t sum;
+	uint64_t sumSq;
+	uint64_t spread;
+
+	do {
+		writes = buffer->writes;
+		sum = buffer->sum;
+		sumSq = buffer->sumSq;
+	} while (writes != buffer->writes);
+
+	spread = buffer->size * sumSq - (uint64_t)sum * sum;
+	return (float)spread / ((float)buffer->size * buffer->size);
+}
+
 // *******************************************************
 // freeCircBuf: Releases the memory allocated to the buffer data,
 // sets pointer to NULL and ohter fields to 0. The buffer can
@@ -68,6 +121,9 @@ freeCircBuf (circBuf_t * buffer)
 	buffer->windex = 0;
 	buffer->rindex = 0;
 	buffer->size = 0;
+	buffer->writes = 0;
+	buffer->sum = 0;
+	buffer->sumSq = 0;
 	free (buffer->data);
 	buffer->data = NULL;
 }
@@ -20,6 +20,9 @@ typedef struct {
 	uint32_t windex;	// index for writing, mod(size)
 	uint32_t rindex;	// index for reading, mod(size)
 	uint32_t *data;		// pointer to the data
+	volatile uint32_t writes;	// write counter, used to snapshot the sums
+	volatile uint32_t sum;		// running sum of all entries
+	volatile uint64_t sumSq;	// running sum of the squares of all entries
 } circBuf_t;
 
 // *******************************************************
@@ -43,6 +46,27 @@ writeCircBuf (circBuf_t *buffer, uint32_t entry);
 uint32_t
 readCircBuf (circBuf_t *buffer);
 
+// *******************************************************
+// sumCircBuf: return the sum of all entries in the buffer. This is
+// kept up to date by writeCircBuf, so costs the same for any size
+// and is safe to call while an ISR is writing to the buffer.
+uint32_t
+sumCircBuf (circBuf_t *buffer);
+
+// *******************************************************
+// meanCircBuf: return the mean of all entries in the buffer,
+// rounded to the nearest integer.
+uint32_t
+meanCircBuf (circBuf_t *buffer);
+
+// *******************************************************
+// varianceCircBuf: return the population variance of all entries
+// in the buffer. The sum and sum of squares are snapshotted together,
+// retrying if the buffer was written to part way through. Exact up
+// to the final float division for 12-bit entries.
+float
+varianceCircBuf (circBuf_t *buffer);
+
 // *******************************************************
 // freeCircBuf: Releases the memory allocated to the buffer data,
 // sets pointer to NULL and other fields to 0. The buffer can
@@ -0,0 +1,353 @@
+//*****************************************************************************
+//
+// command.c - Line commands over UART0, for tuning the controllers in
+//             flight without rebuilding the firmware. Characters are kept
+//             as they arrive and a line is only acted on once its end has
+//             been received, so a half-typed line never holds up the loop.
+//             Values are read and sent as decimals without floats, so the
+//             fixed point build does without them.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "command.h"
+#include "inits.h"
+#include "PID.h"
+#include "format.h"
+#include "gain_schedule.h"
+#include "torque_ff.h"
+#include "scheduler.h"
+#include "profile.h"
+#include "flight_recorder.h"
+#include "uartstdio.h"
+#include "ustdlib.h"
+
+#define CMD_WHOLE_MAX 30000     // Largest whole part of a number, which
+                                // keeps a value within Q16.16
+#define CMD_ESCAPE 0x1b         // Abandons the line being typed
+#define CMD_BACKSPACE '\b'      // Rubs out the last character, as does
+#define CMD_DELETE 0x7f         // DEL, which most terminals send for it
+
+//*****************************************************************************
+// Settings the commands reach
+//*****************************************************************************
+static const struct {
+    const char *name;
+    pidval_t *gain;
+} g_gains[] = {
+    {"alt.kp", &ALT_KP},
+    {"alt.ki", &ALT_KI},
+    {"alt.kd", &ALT_KD},
+    {"yaw.kp", &YAW_KP},
+    {"yaw.ki", &YAW_KI},
+    {"yaw.kd", &YAW_KD},
+};
+
+static const struct {
+    const char *name;
+    uint8_t *value;
+    uint8_t numValues;
+} g_switches[] = {
+    {"ff", &TORQUE_FF, 2},
+    {"gs", &GAIN_SCHEDULE, 2},
+};
+
+#define NUM_GAINS (sizeof(g_gains) / sizeof(g_gains[0]))
+#define NUM_SWITCHES (sizeof(g_switches) / sizeof(g_switches[0]))
+
+//*****************************************************************************
+// Line being received
+//*****************************************************************************
+static char g_line[CMD_LINE_SIZE];
+static uint32_t g_length;
+static bool g_tooLong;          // Characters were lost off the end
+
+//*****************************************************************************
+// Read a decimal such as -12.5 as a controller value. Digits past
+// CMD_DECIMALS places are ignored. Returns false if text is not a number.
+//*****************************************************************************
+static bool parseValue(const char *text, pidval_t *value)
+{
+    bool negative = (*text == '-');
+    bool digits = false;
+    uint32_t whole = 0;
+    uint32_t fraction = 0;
+    uint32_t scale = 1;
+    uint8_t places = 0;
+
+    if (negative) {
+        text++;
+    }
+    for (; *text >= '0' && *text <= '9'; text++) {
+        whole = whole * 10 + (*text - '0');
+        if (whole > CMD_WHOLE_MAX) {
+            return false;
+        }
+        digits = true;
+    }
+    if (*text == '.') {
+        for (text++; *text >= '0' && *text <= '9'; text++) {
+            if (places < CMD_DECIMALS) {
+                fraction = fraction * 10 + (*text - '0');
+                scale *= 10;
+                places++;
+            }
+            digits = true;
+        }
+    }
+    if (!digits || *text) {
+        return false;
+    }
+    *value = PID_FROM_INT(whole)
+        + PID_DIV(PID_FROM_INT(fraction), PID_FROM_INT(scale));
+    if (negative) {
+        *value = -*value;
+    }
+    return true;
+}
+
+//*****************************************************************************
+// Read a whole number between min and max. Returns false if text is not one.
+//*****************************************************************************
+static bool parseInt(const char *text, int32_t min, int32_t max,
+                     int32_t *value)
+{
+    bool negative = (*text == '-');
+    int32_t magnitude = 0;
+
+    if (negative) {
+        text++;
+    }
+    if (!*text) {
+        return false;
+    }
+    for (; *text; text++) {
+        if (*text < '0' || *text > '9') {
+            return false;
+        }
+        magnitude = magnitude * 10 + (*text - '0');
+        if (magnitude > CMD_WHOLE_MAX) {
+            return false;
+        }
+    }
+    *value = negative ? -magnitude : magnitude;
+    return *value >= min && *value <= max;
+}
+
+//*****************************************************************************
+// Send name and value on a line
+//*****************************************************************************
+static void sendValue(const char *name, pidval_t value)
+{
+    char text[16];
+
+    fmtPid(text, &text[sizeof(text) - 1], value, CMD_DECIMALS);
+    UARTprintf("%s %s\n", name, text);
+}
+
+//*****************************************************************************
+// Send an axis's gains on a line
+//*****************************************************************************
+static void sendGains(const char *label, pidval_t kp, pidval_t ki,
+                      pidval_t kd)
+{
+    char text[48];
+    char *end = &text[sizeof(text) - 1];
+    char *p = text;
+
+    p = fmtStr(p, end, "kp ");
+    p = fmtPid(p, end, kp, CMD_DECIMALS);
+    p = fmtStr(p, end, " ki ");
+    p = fmtPid(p, end, ki, CMD_DECIMALS);
+    p = fmtStr(p, end, " kd ");
+    fmtPid(p, end, kd, CMD_DECIMALS);
+    UARTprintf("%s %s\n", label, text);
+}
+
+//*****************************************************************************
+// Put changed gains in use. The gain schedule scales them from the next
+// control tick; without it the controllers take them as they are.
+//*****************************************************************************
+static void applyGains(void)
+{
+    if (!GAIN_SCHEDULE) {
+        pidSetGains(&altPID, ALT_KP, ALT_KI, ALT_KD);
+        pidSetGains(&yawPID, YAW_KP, YAW_KI, YAW_KD);
+    }
+}
+
+//*****************************************************************************
+// Commands
+//*****************************************************************************
+static void cmdSet(const char *name, const char *text)
+{
+    pidval_t value;
+    int32_t choice;
+    uint32_t i;
+
+    for (i = 0; i < NUM_GAINS; i++) {
+        if (ustrcmp(name, g_gains[i].name) == 0) {
+            if (!parseValue(text, &value) || value < 0) {
+                UARTprintf("cmd: %s must be a number from 0\n", name);
+                return;
+            }
+            *g_gains[i].gain = value;
+            applyGains();
+            sendValue(name, value);
+            return;
+        }
+    }
+    for (i = 0; i < NUM_SWITCHES; i++) {
+        if (ustrcmp(name, g_switches[i].name) == 0) {
+            if (!parseInt(text, 0, g_switches[i].numValues - 1, &choice)) {
+                UARTprintf("cmd: %s must be 0 to %u\n", name,
+                           g_switches[i].numValues - 1);
+                return;
+            }
+            *g_switches[i].value = choice;
+            applyGains();
+            UARTprintf("%s %u\n", name, choice);
+            return;
+        }
+    }
+    UARTprintf("cmd: no setting %s\n", name);
+}
+
+static void cmdGet(const char *name)
+{
+    uint32_t i;
+
+    if (ustrcmp(name, "pid") == 0) {
+        sendGains("alt", ALT_KP, ALT_KI, ALT_KD);
+        sendGains("yaw", YAW_KP, YAW_KI, YAW_KD);
+        if (GAIN_SCHEDULE) {
+            sendGains("alt in use", altPID.kp, altPID.ki, altPID.kd);
+            sendGains("yaw in use", yawPID.kp, yawPID.ki, yawPID.kd);
+        }
+        return;
+    }
+    for (i = 0; i < NUM_GAINS; i++) {
+        if (ustrcmp(name, g_gains[i].name) == 0) {
+            sendValue(name, *g_gains[i].gain);
+            return;
+        }
+    }
+    for (i = 0; i < NUM_SWITCHES; i++) {
+        if (ustrcmp(name, g_switches[i].name) == 0) {
+            UARTprintf("%s %u\n", name, *g_switches[i].value);
+            return;
+        }
+    }
+    UARTprintf("cmd: no setting %s\n", name);
+}
+
+static void cmdSetpoint(const char *axis, const char *text,
+                        uint8_t *altSetpoint, volatile int16_t *yawSetpoint,
+                        bool steerable)
+{
+    int32_t value;
+
+    if (!steerable) {
+        UARTprintf("cmd: setpoints move only while flying\n");
+    } else if (ustrcmp(axis, "alt") == 0) {
+        if (parseInt(text, 0, 100, &value)) {
+            *altSetpoint = value;
+            UARTprintf("sp alt %d\n", value);
+        } else {
+            UARTprintf("cmd: alt must be 0 to 100\n");
+        }
+    } else if (ustrcmp(axis, "yaw") == 0) {
+        if (parseInt(text, INT16_MIN, INT16_MAX, &value)) {
+            *yawSetpoint = value;
+            UARTprintf("sp yaw %d\n", value);
+        } else {
+            UARTprintf("cmd: yaw must be whole degrees\n");
+        }
+    } else {
+        UARTprintf("cmd: no setpoint %s\n", axis);
+    }
+}
+
+//*****************************************************************************
+// Split a line into words and run it
+//*****************************************************************************
+static void runLine(char *line, uint8_t *altSetpoint,
+                    volatile int16_t *yawSetpoint, bool steerable)
+{
+    char *args[CMD_MAX_ARGS];
+    uint32_t count = 0;
+
+    while (*line) {
+        while (*line == ' ' || *line == '\t') {
+            *line++ = '\0';
+        }
+        if (!*line) {
+            break;
+        }
+        if (count == CMD_MAX_ARGS) {
+            UARTprintf("cmd: too many words\n");
+            return;
+        }
+        args[count++] = line;
+        while (*line && *line != ' ' && *line != '\t') {
+            line++;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    if (ustrcmp(args[0], "set") == 0 && count == 3) {
+        cmdSet(args[1], args[2]);
+    } else if (ustrcmp(args[0], "get") == 0 && count == 2) {
+        cmdGet(args[1]);
+    } else if (ustrcmp(args[0], "sp") == 0 && count == 3) {
+        cmdSetpoint(args[1], args[2], altSetpoint, yawSetpoint, steerable);
+    } else if (ustrcmp(args[0], "tasks") == 0 && count == 1) {
+        schedulerReport();
+    } else if (ustrcmp(args[0], "prof") == 0 && count == 1) {
+        profileDump();
+    } else if (ustrcmp(args[0], "trig") == 0 && count == 1) {
+        frTrigger(FR_TRIG_COMMAND);
+    } else if (ustrcmp(args[0], "dump") == 0 && count == 1) {
+        frStartDump();
+    } else if (ustrcmp(args[0], "ffcal") == 0 && count == 1) {
+        ffCalStart();
+    } else {
+        UARTprintf("cmd: unknown command %s\n", args[0]);
+    }
+}
+
+void cmdService(uint8_t *altSetpoint, volatile int16_t *yawSetpoint,
+                bool steerable)
+{
+    char c;
+
+    while (UARTRxBytesAvail()) {
+        c = UARTgetc();
+        if (c == '\r' || c == '\n') {
+            if (g_tooLong) {
+                UARTprintf("cmd: line too long\n");
+            } else {
+                g_line[g_length] = '\0';
+                runLine(g_line, altSetpoint, yawSetpoint, steerable);
+            }
+            g_length = 0;
+            g_tooLong = false;
+        } else if (c == CMD_ESCAPE) {
+            g_length = 0;
+            g_tooLong = false;
+        } else if (c == CMD_BACKSPACE || c == CMD_DELETE) {
+            // Once characters are lost, only ESC or the line's end clears it
+            if (g_length > 0 && !g_tooLong) {
+                g_length--;
+            }
+        } else if (g_length < CMD_LINE_SIZE - 1) {
+            g_line[g_length++] = c;
+        } else {
+            g_tooLong = true;
+        }
+    }
+}
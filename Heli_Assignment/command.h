@@ -0,0 +1,48 @@
+//*****************************************************************************
+//
+// command.h - Header file for the line commands over UART0, which tune the
+//             controllers and move the setpoints in flight
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CMD_LINE_SIZE 48        // Longest command line, with its terminator
+#define CMD_MAX_ARGS 4          // Words in a command line
+#define CMD_DECIMALS 4          // Decimal places values are read and sent to
+
+// Commands, one per line, ended by CR or LF. Backspace or DEL rubs out the
+// last character and ESC abandons the line. Echo is off, so neither shows on
+// the terminal.
+//   set <name> <value>     Set a gain, e.g. set alt.kp 0.55, or a switch
+//   get <name>             Send a gain or switch
+//   get pid                Send the gains, and the gains in use when they are
+//                          scheduled
+//   sp alt <percent>       Move the altitude setpoint, while flying
+//   sp yaw <degrees>       Move the yaw setpoint, while flying
+//   tasks                  Send the task table
+//   prof                   Send the profile sections
+//   trig                   Trigger the flight recorder
+//   dump                   Dump the flight recorder
+//   ffcal                  Start a torque feedforward calibration
+// The gains are alt.kp, alt.ki, alt.kd, yaw.kp, yaw.ki and yaw.kd, the gains
+// gain_schedule.c scales. The switches are ff, the torque feedforward, and
+// gs, the gain schedule.
+
+//*****************************************************************************
+// Act on every command line received since the last call. Characters of a
+// line still arriving are kept for the next call, so this never waits for
+// input. Call from a task, so a change is made between control ticks. The
+// setpoints are only moved while steerable.
+//*****************************************************************************
+void cmdService(uint8_t *altSetpoint, volatile int16_t *yawSetpoint,
+                bool steerable);
+
+#endif /* COMMAND_H_ */
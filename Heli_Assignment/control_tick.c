@@ -0,0 +1,114 @@
+//*****************************************************************************
+//
+// control_tick.c - Hardware timer that paces the main control loop. Timer1
+//                  interrupts at a fixed rate and the main loop sleeps in
+//                  between, so the loop period no longer depends on how long
+//                  the loop body takes.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "control_tick.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+
+static volatile uint32_t g_ticks;   // Ticks since start up
+static uint32_t g_lastTicks;        // Tick count at the last wake up
+static uint32_t g_overruns;         // Ticks missed by the loop
+static uint32_t g_load;             // Timer1 cycles per tick
+
+//*****************************************************************************
+// Counts each control tick
+//*****************************************************************************
+static void ControlTickIntHandler(void)
+{
+    TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+    g_ticks++;
+}
+
+//*****************************************************************************
+// Start Timer1 interrupting at rateHz
+//*****************************************************************************
+void initControlTick(uint32_t rateHz)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    g_load = SysCtlClockGet() / rateHz;
+    TimerLoadSet(TIMER1_BASE, TIMER_A, g_load);
+    TimerIntRegister(TIMER1_BASE, TIMER_A, ControlTickIntHandler);
+    TimerIntEnable(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+    TimerEnable(TIMER1_BASE, TIMER_A);
+}
+
+//*****************************************************************************
+// Sleep until the next control tick, returning the number of ticks elapsed
+// since the previous call. Interrupts are masked around the check so a tick
+// landing just before the sleep still wakes the processor.
+//*****************************************************************************
+uint32_t waitForControlTick(void)
+{
+    uint32_t ticks;
+    uint32_t elapsed;
+
+    IntMasterDisable();
+    while (g_ticks == g_lastTicks) {
+        SysCtlSleep();
+        IntMasterEnable();
+        IntMasterDisable();
+    }
+    ticks = g_ticks;
+    IntMasterEnable();
+
+    elapsed = ticks - g_lastTicks;
+    if (elapsed > 1) {
+        g_overruns += elapsed - 1;
+    }
+    g_lastTicks = ticks;
+    return elapsed;
+}
+
+//*****************************************************************************
+// Return the number of control ticks since start up
+//*****************************************************************************
+uint32_t getControlTickCount(void)
+{
+    return g_ticks;
+}
+
+//*****************************************************************************
+// Return the number of control ticks missed because the loop overran
+//*****************************************************************************
+uint32_t getControlOverruns(void)
+{
+    return g_overruns;
+}
+
+//*****************************************************************************
+// Return a free running time stamp in system clock cycles, made up of the
+// tick count and how far Timer1 has counted down into the current tick. The
+// tick count is re-read in case the tick interrupt ran part way through.
+// Timer1 reloads before its interrupt runs, and the interrupt waits while
+// masked or behind a higher priority one, so a timeout still pending is
+// counted if the value was read after the reload, in the first half of the
+// tick.
+//*****************************************************************************
+uint32_t getControlTime(void)
+{
+    uint32_t ticks;
+    uint32_t value;
+    bool pending;
+
+    do {
+        ticks = g_ticks;
+        value = TimerValueGet(TIMER1_BASE, TIMER_A);
+        pending = TimerIntStatus(TIMER1_BASE, false) & TIMER_TIMA_TIMEOUT;
+    } while (ticks != g_ticks);
+    if (pending && value > g_load / 2) {
+        ticks++;
+    }
+    return ticks * g_load + (g_load - value);
+}
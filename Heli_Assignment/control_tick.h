@@ -0,0 +1,48 @@
+//*****************************************************************************
+//
+// control_tick.h - Header file for the hardware timer that paces the main
+//                  control loop
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef CONTROL_TICK_H_
+#define CONTROL_TICK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CONTROL_RATE_HZ 500     // 100-1000 Hz
+#define CONTROL_TICKS_TO_MS(ticks) \
+    ((uint32_t)((uint64_t)(ticks) * 1000 / CONTROL_RATE_HZ))
+
+//*****************************************************************************
+// Start Timer1 interrupting at rateHz
+//*****************************************************************************
+void initControlTick(uint32_t rateHz);
+
+//*****************************************************************************
+// Sleep until the next control tick, returning the number of ticks elapsed
+// since the previous call. More than one means the deadline was overrun.
+//*****************************************************************************
+uint32_t waitForControlTick(void);
+
+//*****************************************************************************
+// Return the number of control ticks since start up
+//*****************************************************************************
+uint32_t getControlTickCount(void);
+
+//*****************************************************************************
+// Return the number of control ticks missed because the loop overran
+//*****************************************************************************
+uint32_t getControlOverruns(void);
+
+//*****************************************************************************
+// Return a free running time stamp in system clock cycles, for timing code.
+// It never goes backwards, even with the tick interrupt held off.
+//*****************************************************************************
+uint32_t getControlTime(void);
+
+#endif /* CONTROL_TICK_H_ */
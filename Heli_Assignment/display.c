@@ -9,13 +9,18 @@
 //*****************************************************************************
 #include <stdbool.h>
 #include "display.h"
+#include "control_tick.h"
+#include "profile.h"
+#include "format.h"
 
 #define MAX_VOLTAGE_SWING 1000 //0.8 volts represented on the TIVA.
-#define SERIAL_BAUD_RATE 9600
-#define SERIAL_CLK_FREQ 16000000
+#define SERIAL_INT_PRIORITY 0x80 // Below the control tick, so output never delays it
+#define OLED_STRING_SIZE 65     // Four 16 character lines and the null
+#define SERIAL_STRING_SIZE 128
 
 //*****************************************************************************
-// Initialise the UART module on the to 9600 Baud, 1 stop bit, no parity
+// Initialise the UART module to SERIAL_BAUD_RATE, 1 stop bit, no parity, with
+// output buffered and sent from the UART interrupt
 //*****************************************************************************
 void initSerial(void) {
     // Enable GPIO port used for UART0 pins.
@@ -29,8 +34,14 @@ void initSerial(void) {
     UARTClockSourceSet(UART0_BASE, UART_CLOCK_PIOSC);
     // Choose the alt (UART) function for these pins.
     GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    // Send from the UART interrupt at a lower priority than the control loop
+    UARTIntRegister(UART0_BASE, UARTStdioIntHandler);
+    IntPrioritySet(INT_UART0, SERIAL_INT_PRIORITY);
     // Initialize the UART for I/O
     UARTStdioConfig(0, SERIAL_BAUD_RATE, SERIAL_CLK_FREQ);
+    // Echo would corrupt binary telemetry, so command.c edits the command
+    // lines itself
+    UARTEchoSet(false);
 }
 
 //*****************************************************************************
@@ -55,22 +66,53 @@ int16_t getHeightPercent(uint16_t init_height, uint32_t height_volts) {
 // Send an array of chars over serial using the Tiva kit's UART module
 //*****************************************************************************
 void serial_println(const char *pcStr) {
-    UARTprintf(pcStr);
+    UARTwrite(pcStr, strlen(pcStr));
 }
 
 //*****************************************************************************
-// Displays the given paramters on the OLED display as well as send them 
-// via serial using the UART module on the Tiva kit. Cycles between OLED and
-// serial every time it is called as to not flood outputs too fast.
+// Displays the given paramters on the OLED display.
 //*****************************************************************************
-bool update_display(uint32_t height_volts,
+void display_oled(uint32_t height_volts,
+                  uint16_t init_height,
+                  float yawDegrees,
+                  int16_t yaw_setpoint,
+                  uint8_t height_setpoint,
+                  uint16_t pwm_main_duty,
+                  uint16_t pwm_tail_duty) {
+    PROFILE_START(PROF_DISPLAY_OLED);
+    int16_t height_pct;
+    char string[OLED_STRING_SIZE];
+    char *end = string + sizeof(string) - 1;
+    char *p;
+    height_pct = getHeightPercent(init_height, height_volts);
+    p = fmtStr(string, end, "Yaw = ");
+    p = fmtInt(p, end, yaw_setpoint, 3);
+    p = fmtStr(p, end, " [");
+    p = fmtInt(p, end, (int16_t)yawDegrees, 3);
+    p = fmtStr(p, end, "] Alt = ");
+    p = fmtInt(p, end, height_setpoint, 3);
+    p = fmtStr(p, end, " [");
+    p = fmtInt(p, end, height_pct, 3);
+    p = fmtStr(p, end, "] Main = ");
+    p = fmtInt(p, end, pwm_main_duty, 3);
+    p = fmtStr(p, end, "  pct Tail = ");
+    p = fmtInt(p, end, pwm_tail_duty, 3);
+    fmtStr(p, end, "  pct ");
+    OLEDStringDraw(string, 0, 0);
+    PROFILE_END(PROF_DISPLAY_OLED);
+}
+
+//*****************************************************************************
+// Sends the given paramters via serial using the UART module on the Tiva kit.
+//*****************************************************************************
+void display_serial(uint32_t height_volts,
                     uint16_t init_height,
                     float yawDegrees,
-                    bool display_refresh,
                     int16_t yaw_setpoint,
                     uint8_t height_setpoint,
                     uint16_t pwm_main_duty,
                     uint16_t pwm_tail_duty) {
+    PROFILE_START(PROF_DISPLAY_SERIAL);
     //TODO implement state printing out
 //    char state[12];
 //    if (!calibrated) {
@@ -83,35 +125,27 @@ bool update_display(uint32_t height_volts,
 //        state = "Landed";
 //    }
     int16_t height_pct;
+    char serial_string[SERIAL_STRING_SIZE];
+    char *end = serial_string + sizeof(serial_string) - 1;
+    char *p;
     height_pct = getHeightPercent(init_height, height_volts);
-    if (display_refresh) {
-        char string[300];
-        sprintf (string, "Yaw = %3d [%3d] "
-                "Alt = %3d [%3d] "
-                "Main = %3d  pct "
-                "Tail = %3d  pct ",
-                 yaw_setpoint,
-                 (int16_t)yawDegrees,
-                 height_setpoint,
-                 height_pct,
-                 pwm_main_duty,
-                 pwm_tail_duty);
-        OLEDStringDraw(string, 0, 0);
-    } else {
-        char serial_string[300];
-        sprintf(serial_string, "------------\nYaw = %3d [%3d] deg\nAlt = %3d [%3d] pct\nMain = %3d  pct\nTail = %3d\n",
-                yaw_setpoint,
-                (int16_t)yawDegrees,
-                height_setpoint,
-                height_pct,
-                pwm_main_duty,
-                pwm_tail_duty
-                //state
-                ); //TODO
-        serial_println(serial_string);
-    }
-
-    display_refresh = !display_refresh;
-    return display_refresh;
+    p = fmtStr(serial_string, end, "------------\nYaw = ");
+    p = fmtInt(p, end, yaw_setpoint, 3);
+    p = fmtStr(p, end, " [");
+    p = fmtInt(p, end, (int16_t)yawDegrees, 3);
+    p = fmtStr(p, end, "] deg\nAlt = ");
+    p = fmtInt(p, end, height_setpoint, 3);
+    p = fmtStr(p, end, " [");
+    p = fmtInt(p, end, height_pct, 3);
+    p = fmtStr(p, end, "] pct\nMain = ");
+    p = fmtInt(p, end, pwm_main_duty, 3);
+    p = fmtStr(p, end, "  pct\nTail = ");
+    p = fmtInt(p, end, pwm_tail_duty, 3);
+    p = fmtStr(p, end, "\nOverruns = ");
+    p = fmtUint(p, end, getControlOverruns(), 0);
+    p = fmtStr(p, end, "\nTX dropped = ");
+    p = fmtUint(p, end, UARTTxOverflowCount(), 0);
+    fmtStr(p, end, "\n");
+    serial_println(serial_string);
+    PROFILE_END(PROF_DISPLAY_SERIAL);
 }
-
@@ -21,17 +21,17 @@
 #include "driverlib/pin_map.h"
 #include "driverlib/gpio.h"
 #include "driverlib/uart.h"
-#include "utils/uartstdio.h"
+#include "uartstdio.h"
 #include "utils/ustdlib.h"
 #include "OrbitOLED/OrbitOLEDInterface.h"
 #include "OrbitOLED/lib_OrbitOled/OrbitOled.h"
 
 #define MAX_VOLTAGE_SWING 1000 //0.8 volts represented on the TIVA.
-#define SERIAL_BAUD_RATE 9600
+#define SERIAL_BAUD_RATE 115200 // Up to 921600
 #define SERIAL_CLK_FREQ 16000000
 
 //*****************************************************************************
-// Initialise the UART for serial communication
+// Initialise the UART for buffered, interrupt driven serial communication
 //*****************************************************************************
 void initSerial(void);
 
@@ -51,12 +51,22 @@ int16_t getHeightPercent(uint16_t init_height, uint32_t height_volts);
 void serial_println(const char *pcStr);
 
 //*****************************************************************************
-// Update the either the display or the serial output
+// Update the OLED display
 //*****************************************************************************
-bool update_display(uint32_t height_volts,
+void display_oled(uint32_t height_volts,
+                  uint16_t init_height,
+                  float yawDegrees,
+                  int16_t yaw_setpoint,
+                  uint8_t height_setpoint,
+                  uint16_t pwm_main_duty,
+                  uint16_t pwm_tail_duty);
+
+//*****************************************************************************
+// Update the serial output
+//*****************************************************************************
+void display_serial(uint32_t height_volts,
                     uint16_t init_height,
                     float yawDegrees,
-                    bool display_refresh,
                     int16_t yaw_setpoint,
                     uint8_t height_setpoint,
                     uint16_t pwm_main_duty,
@@ -0,0 +1,148 @@
+//*****************************************************************************
+//
+// flight_recorder.c - RAM flight recorder. Records go into a fixed ring
+//                     continuously while armed. A trigger event lets the
+//                     ring run on for FR_POST_TRIGGER more records and then
+//                     freezes it, so the capture holds the lead up to the
+//                     event as well as what followed. Dumps are streamed out
+//                     a few records at a time so they never block the loop.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "flight_recorder.h"
+#include "uartstdio.h"
+
+#define FR_LINE_MAX 96          // Longest CSV line, so a line is never split
+
+enum frMode {FR_ARMED, FR_TRIGGERED, FR_CAPTURED, FR_DUMPING};
+
+static frRecord_t g_records[FR_NUM_RECORDS];
+static uint32_t g_next;         // Where the next record goes
+static uint32_t g_count;        // Records held, up to FR_NUM_RECORDS
+static uint32_t g_postLeft;     // Records still to take after the trigger
+static uint32_t g_triggerTick;
+static uint8_t g_triggerEvent;
+static uint32_t g_decimate;
+static uint32_t g_dumpIndex;    // Records sent so far in a dump
+static enum frMode g_mode = FR_ARMED;
+
+//*****************************************************************************
+// Convert a value to tenths, saturated to fit an int16_t record field
+//*****************************************************************************
+int16_t frTenths(pidval_t value)
+{
+    pidacc_t tenths = (pidacc_t)value * 10;
+    if (tenths > PID_FROM_INT(INT16_MAX)) {
+        return INT16_MAX;
+    }
+    if (tenths < PID_FROM_INT(INT16_MIN)) {
+        return INT16_MIN;
+    }
+    return (int16_t)PID_TO_INT(tenths);
+}
+
+//*****************************************************************************
+// Clear the recorder and start recording
+//*****************************************************************************
+void frArm(void)
+{
+    g_next = 0;
+    g_count = 0;
+    g_decimate = 0;
+    g_triggerEvent = 0;
+    g_mode = FR_ARMED;
+}
+
+//*****************************************************************************
+// Add a record to the ring, counting down the post-trigger records
+//*****************************************************************************
+void frRecord(const frRecord_t *record)
+{
+    if (g_mode != FR_ARMED && g_mode != FR_TRIGGERED) {
+        return;
+    }
+    if (++g_decimate < FR_DECIMATE) {
+        return;
+    }
+    g_decimate = 0;
+
+    g_records[g_next] = *record;
+    g_next = (g_next + 1) % FR_NUM_RECORDS;
+    if (g_count < FR_NUM_RECORDS) {
+        g_count++;
+    }
+
+    if (g_mode == FR_TRIGGERED && --g_postLeft == 0) {
+        g_mode = FR_CAPTURED;
+    }
+}
+
+//*****************************************************************************
+// Report an event, starting the post-trigger countdown if armed
+//*****************************************************************************
+void frTrigger(uint8_t event)
+{
+    if (g_mode != FR_ARMED || !(event & FR_TRIGGER_MASK)) {
+        return;
+    }
+    g_triggerEvent = event;
+    g_triggerTick = g_count ? g_records[(g_next + FR_NUM_RECORDS - 1)
+                                        % FR_NUM_RECORDS].tick : 0;
+    g_postLeft = FR_POST_TRIGGER;
+    g_mode = FR_TRIGGERED;
+}
+
+//*****************************************************************************
+// Return true once a capture is complete
+//*****************************************************************************
+bool frCaptured(void)
+{
+    return g_mode == FR_CAPTURED;
+}
+
+//*****************************************************************************
+// Start sending the capture. An untriggered recorder is frozen and dumped
+// as it stands.
+//*****************************************************************************
+void frStartDump(void)
+{
+    if (g_mode == FR_DUMPING) {
+        return;
+    }
+    g_mode = FR_DUMPING;
+    g_dumpIndex = 0;
+    UARTprintf("\nflight recorder: %u records, trigger 0x%02x at tick %u\n",
+               g_count, g_triggerEvent, g_triggerTick);
+    UARTprintf("tick,alt_raw,alt_mean,alt_sp,yaw_ticks,yaw_sp,"
+               "alt_err,alt_int,yaw_err,yaw_int,main,tail,state\n");
+}
+
+//*****************************************************************************
+// Send records while there is room for a whole line in the transmit buffer
+//*****************************************************************************
+void frDumpService(void)
+{
+    const frRecord_t *r;
+
+    if (g_mode != FR_DUMPING) {
+        return;
+    }
+    while (g_dumpIndex < g_count && UARTTxBytesFree() > FR_LINE_MAX) {
+        // Oldest first: once the ring has wrapped that is the next slot
+        r = &g_records[(g_next + FR_NUM_RECORDS - g_count + g_dumpIndex)
+                       % FR_NUM_RECORDS];
+        UARTprintf("%u,%u,%u,%u,%d,%d,%d,%d,%d,%d,%u,%u,%u\n",
+                   r->tick, r->altRaw, r->altMean, r->altSetpoint,
+                   r->yawTicks, r->yawSetpoint,
+                   r->altError, r->altIntegral, r->yawError, r->yawIntegral,
+                   r->mainDuty, r->tailDuty, r->state);
+        g_dumpIndex++;
+    }
+    if (g_dumpIndex == g_count && UARTTxBytesFree() > FR_LINE_MAX) {
+        UARTprintf("end\n");
+        frArm();
+    }
+}
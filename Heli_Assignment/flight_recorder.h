@@ -0,0 +1,89 @@
+//*****************************************************************************
+//
+// flight_recorder.h - Header file for the RAM flight recorder, which keeps
+//                     the last few hundred control ticks and freezes them
+//                     around a trigger event for dumping over serial
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef FLIGHT_RECORDER_H_
+#define FLIGHT_RECORDER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "PID.h"
+
+#define FR_NUM_RECORDS 256      // 24 bytes each
+#define FR_POST_TRIGGER 128     // Records kept after the trigger
+#define FR_DECIMATE 2           // Record every nth control tick
+
+// Events that can trigger a capture. Clear a bit in FR_TRIGGER_MASK to
+// ignore that event.
+#define FR_TRIG_STATE     0x01  // Flying or landing began or ended
+#define FR_TRIG_SATURATE  0x02  // A rotor duty hit its limit while flying
+#define FR_TRIG_BUTTON    0x04  // A setpoint button was pressed
+#define FR_TRIG_COMMAND   0x08  // Triggered from the serial port
+#define FR_TRIGGER_MASK (FR_TRIG_STATE | FR_TRIG_SATURATE | FR_TRIG_COMMAND)
+
+//*****************************************************************************
+// One packed record. Fields are ordered so there is no padding.
+//*****************************************************************************
+typedef struct {
+    uint32_t tick;          // Control tick the record was taken on
+    uint16_t altRaw;        // Latest ADC sample
+    uint16_t altMean;       // Averaged ADC value
+    int16_t yawTicks;       // Quadrature count
+    int16_t yawSetpoint;    // Degrees
+    int16_t altError;       // PID terms, tenths, saturated to int16_t
+    int16_t altIntegral;
+    int16_t yawError;
+    int16_t yawIntegral;
+    uint8_t altSetpoint;    // Percent
+    uint8_t mainDuty;       // Percent
+    uint8_t tailDuty;       // Percent
+    uint8_t state;
+} frRecord_t;
+
+//*****************************************************************************
+// Convert a value to tenths, saturated to fit an int16_t record field
+//*****************************************************************************
+int16_t frTenths(pidval_t value);
+
+//*****************************************************************************
+// Clear the recorder and start recording
+//*****************************************************************************
+void frArm(void);
+
+//*****************************************************************************
+// Add a record, called every control tick. Records are taken every
+// FR_DECIMATE ticks until a capture is complete.
+//*****************************************************************************
+void frRecord(const frRecord_t *record);
+
+//*****************************************************************************
+// Report an event. If it is enabled in FR_TRIGGER_MASK and the recorder is
+// armed, the capture finishes FR_POST_TRIGGER records later.
+//*****************************************************************************
+void frTrigger(uint8_t event);
+
+//*****************************************************************************
+// Return true once a capture is complete and waiting to be dumped
+//*****************************************************************************
+bool frCaptured(void);
+
+//*****************************************************************************
+// Start sending the capture over serial as CSV. Recording stops until the
+// dump is finished, then the recorder re-arms.
+//*****************************************************************************
+void frStartDump(void);
+
+//*****************************************************************************
+// Send as much of a dump as fits in the UART transmit buffer. Call
+// regularly from a low priority task.
+//*****************************************************************************
+void frDumpService(void);
+
+#endif /* FLIGHT_RECORDER_H_ */
@@ -0,0 +1,102 @@
+//*****************************************************************************
+//
+// format.c - Integer-only text formatting into fixed-size buffers, used in
+//            place of sprintf for the display and serial output.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <stdbool.h>
+#include "format.h"
+
+#define FMT_MAX_DIGITS 10   // Digits in the largest uint32_t
+
+//*****************************************************************************
+// Copy a string, stopping at the end of the buffer
+//*****************************************************************************
+char *fmtStr(char *dst, char *end, const char *str) {
+    while (*str && dst < end) {
+        *dst++ = *str++;
+    }
+    *dst = '\0';
+    return dst;
+}
+
+//*****************************************************************************
+// Write the digits of a magnitude, with an optional minus sign, padded on
+// the left with spaces to width characters
+//*****************************************************************************
+static char *fmtDigits(char *dst, char *end, uint32_t mag, bool negative,
+                       uint8_t width) {
+    char digits[FMT_MAX_DIGITS];
+    uint8_t count = 0;
+    uint8_t len;
+
+    do {
+        digits[count++] = '0' + mag % 10;
+        mag /= 10;
+    } while (mag);
+
+    len = count + (negative ? 1 : 0);
+    while (len < width && dst < end) {
+        *dst++ = ' ';
+        width--;
+    }
+    if (negative && dst < end) {
+        *dst++ = '-';
+    }
+    while (count && dst < end) {
+        *dst++ = digits[--count];
+    }
+    *dst = '\0';
+    return dst;
+}
+
+//*****************************************************************************
+// Write a signed integer right-aligned in at least width characters
+//*****************************************************************************
+char *fmtInt(char *dst, char *end, int32_t value, uint8_t width) {
+    if (value < 0) {
+        return fmtDigits(dst, end, -(uint32_t)value, true, width);
+    }
+    return fmtDigits(dst, end, value, false, width);
+}
+
+//*****************************************************************************
+// Write an unsigned integer right-aligned in at least width characters
+//*****************************************************************************
+char *fmtUint(char *dst, char *end, uint32_t value, uint8_t width) {
+    return fmtDigits(dst, end, value, false, width);
+}
+
+//*****************************************************************************
+// Write a controller value with a fixed number of decimal places, from the
+// value scaled up and rounded to an integer
+//*****************************************************************************
+char *fmtPid(char *dst, char *end, pidval_t value, uint8_t decimals) {
+    pidval_t mag = value < 0 ? -value : value;
+    uint32_t scale = 1;
+    uint32_t scaled;
+    uint8_t i;
+
+    for (i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+#ifdef PID_FIXED_POINT
+    scaled = ((uint64_t)(uint32_t)mag * scale + PID_ONE / 2) >> PID_Q_BITS;
+#else
+    scaled = mag * scale + 0.5f;
+#endif
+
+    dst = fmtDigits(dst, end, scaled / scale, value < 0 && scaled, 0);
+    if (decimals && dst < end) {
+        *dst++ = '.';
+    }
+    while (decimals-- && dst < end) {
+        scale /= 10;
+        *dst++ = '0' + scaled / scale % 10;
+    }
+    *dst = '\0';
+    return dst;
+}
@@ -0,0 +1,44 @@
+//*****************************************************************************
+//
+// format.h - Header file for the integer-only text formatting used by the
+//            display and serial output
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+#include "PID.h"
+
+// Each formatter writes at dst and returns the position after the last
+// character written. end is the last byte of the caller's buffer, which is
+// reserved for the terminating null: output is truncated before it and the
+// result is always null terminated.
+
+//*****************************************************************************
+// Copy a string
+//*****************************************************************************
+char *fmtStr(char *dst, char *end, const char *str);
+
+//*****************************************************************************
+// Write a signed integer right-aligned in at least width characters, as %*d
+//*****************************************************************************
+char *fmtInt(char *dst, char *end, int32_t value, uint8_t width);
+
+//*****************************************************************************
+// Write an unsigned integer right-aligned in at least width characters, as
+// %*u
+//*****************************************************************************
+char *fmtUint(char *dst, char *end, uint32_t value, uint8_t width);
+
+//*****************************************************************************
+// Write a controller value rounded to the given number of decimal places, as
+// %.*f. Values of 400000 and more do not fit.
+//*****************************************************************************
+char *fmtPid(char *dst, char *end, pidval_t value, uint8_t decimals);
+
+#endif /* FORMAT_H_ */
@@ -0,0 +1,110 @@
+//*****************************************************************************
+//
+// gain_schedule.c - Schedules the PID gains by flight state and altitude.
+//                   Each state has a row of breakpoints evenly spaced in
+//                   altitude, so finding the two either side of the
+//                   altitude is a division rather than a search. The
+//                   gains follow the interpolated schedule through a first
+//                   order lag, and the controllers keep their integral term
+//                   across a change of KI, so neither a change of state nor
+//                   a climb through the breakpoints bumps the duties.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "gain_schedule.h"
+
+#define GS_POINT(altKp, altKi, altKd, yawKp, yawKi, yawKd) \
+    {PID_FROM_FLOAT(altKp), PID_FROM_FLOAT(altKi), PID_FROM_FLOAT(altKd), \
+     PID_FROM_FLOAT(yawKp), PID_FROM_FLOAT(yawKi), PID_FROM_FLOAT(yawKd)}
+
+// On the ground the main duty must climb most of the way to the hover duty
+// before the heli lifts, which the hover integral takes seconds to do.
+// Damping stops the extra integral overshooting once it lifts.
+#define GS_GROUND GS_POINT(1.0f, 3.0f, 3.0f, 1.0f, 1.0f, 1.0f)
+// In the air less integral and more damping stop the altitude steps
+// overshooting.
+#define GS_HOVER GS_POINT(0.8f, 0.7f, 2.0f, 1.0f, 1.0f, 1.0f)
+// Landing follows the setpoint ramp down more closely. Much more
+// proportional gain bounces the heli off the ground.
+#define GS_DESCENT GS_POINT(1.5f, 2.0f, 2.0f, 1.0f, 1.0f, 1.0f)
+#define GS_UNITY GS_POINT(1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f)
+
+//*****************************************************************************
+// Multipliers of the pid_gains.h gains, by state and then altitude. The yaw
+// gains hold across the envelope now that the torque feedforward carries
+// the tail duty, so they are left at 1.
+//*****************************************************************************
+static const gsPoint_t g_schedule[GS_NUM_STATES][GS_NUM_POINTS] = {
+    // CALIBRATING, which holds 10% while the yaw reference is found
+    {GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY,
+     GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY},
+    // LANDED, with the motors off
+    {GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY,
+     GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY, GS_UNITY},
+    // FLYING
+    {GS_GROUND, GS_HOVER, GS_HOVER, GS_HOVER, GS_HOVER, GS_HOVER,
+     GS_HOVER, GS_HOVER, GS_HOVER, GS_HOVER, GS_HOVER},
+    // LANDING
+    {GS_DESCENT, GS_DESCENT, GS_DESCENT, GS_DESCENT, GS_DESCENT, GS_DESCENT,
+     GS_DESCENT, GS_DESCENT, GS_DESCENT, GS_DESCENT, GS_DESCENT},
+};
+
+uint8_t GAIN_SCHEDULE = GAIN_SCHEDULE_DEFAULT;
+
+//*****************************************************************************
+// Interpolate between two breakpoints, frac of the way from a to b in units
+// of GS_SPACING
+//*****************************************************************************
+static pidval_t interpolate(pidval_t a, pidval_t b, int32_t frac)
+{
+    return a + (b - a) * frac / GS_SPACING;
+}
+
+//*****************************************************************************
+// Move a gain towards its scheduled value. In fixed point the last few
+// steps round to nothing, so the gain is set once it is that close.
+//*****************************************************************************
+static pidval_t slew(pidval_t gain, pidval_t target, pidval_t alpha)
+{
+    pidval_t step = PID_MUL(target - gain, alpha);
+    return step ? gain + step : target;
+}
+
+void gsUpdate(PIDController *alt, PIDController *yaw, uint8_t state,
+              int16_t altitude)
+{
+    const gsPoint_t *lo;
+    const gsPoint_t *hi;
+    pidval_t alpha;
+    int32_t point;
+    int32_t frac;
+
+    if (!GAIN_SCHEDULE || state >= GS_NUM_STATES) {
+        return;
+    }
+    if (altitude < 0) {
+        altitude = 0;
+    } else if (altitude > (GS_NUM_POINTS - 1) * GS_SPACING) {
+        altitude = (GS_NUM_POINTS - 1) * GS_SPACING;
+    }
+    point = altitude / GS_SPACING;
+    if (point > GS_NUM_POINTS - 2) {
+        point = GS_NUM_POINTS - 2;
+    }
+    lo = &g_schedule[state][point];
+    hi = lo + 1;
+    frac = altitude - point * GS_SPACING;
+    alpha = PID_DIV(alt->dt, PID_FROM_FLOAT(GS_SLEW_TAU));
+
+    pidSetGains(alt,
+        slew(alt->kp, PID_MUL(ALT_KP, interpolate(lo->altKp, hi->altKp, frac)), alpha),
+        slew(alt->ki, PID_MUL(ALT_KI, interpolate(lo->altKi, hi->altKi, frac)), alpha),
+        slew(alt->kd, PID_MUL(ALT_KD, interpolate(lo->altKd, hi->altKd, frac)), alpha));
+    pidSetGains(yaw,
+        slew(yaw->kp, PID_MUL(YAW_KP, interpolate(lo->yawKp, hi->yawKp, frac)), alpha),
+        slew(yaw->ki, PID_MUL(YAW_KI, interpolate(lo->yawKi, hi->yawKi, frac)), alpha),
+        slew(yaw->kd, PID_MUL(YAW_KD, interpolate(lo->yawKd, hi->yawKd, frac)), alpha));
+}
@@ -0,0 +1,50 @@
+//*****************************************************************************
+//
+// gain_schedule.h - Header file for scheduling the PID gains by flight state
+//                   and altitude. The schedule scales the gains from
+//                   pid_gains.h, so the tuning tool still tunes the base set.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef GAIN_SCHEDULE_H_
+#define GAIN_SCHEDULE_H_
+
+#include <stdint.h>
+#include "PID.h"
+
+// The schedule was tuned on the rig model alone, so it starts off until it
+// has been flown on the rig. set gs 1 turns it on.
+#define GAIN_SCHEDULE_DEFAULT 0
+#define GS_NUM_STATES 4         // enum State in heli_main.c
+#define GS_NUM_POINTS 11        // Breakpoints, every GS_SPACING percent
+#define GS_SPACING 10           // from 0 to 100% altitude
+#define GS_SLEW_TAU 0.25f       // s, time constant the gains follow the
+                                // schedule with
+
+//*****************************************************************************
+// Gain multipliers at one breakpoint
+//*****************************************************************************
+typedef struct {
+    pidval_t altKp, altKi, altKd;
+    pidval_t yawKp, yawKi, yawKd;
+} gsPoint_t;
+
+//*****************************************************************************
+// 0 runs on the gains from pid_gains.h alone. A variable so a test harness
+// can turn scheduling off.
+//*****************************************************************************
+extern uint8_t GAIN_SCHEDULE;
+
+//*****************************************************************************
+// Set the controllers' gains for the flight state and measured altitude,
+// once per control tick before they are updated. The schedule is
+// interpolated between breakpoints and the gains follow it with a time
+// constant of GS_SLEW_TAU, so a change of state does not step them.
+//*****************************************************************************
+void gsUpdate(PIDController *alt, PIDController *yaw, uint8_t state,
+              int16_t altitude);
+
+#endif /* GAIN_SCHEDULE_H_ */
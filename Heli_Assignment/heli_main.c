@@ -14,6 +14,24 @@
 #include "driverlib/sysctl.h"
 #include "inits.h"
 #include "PID.h"
+#include "control_tick.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "flight_recorder.h"
+#include "torque_ff.h"
+#include "command.h"
+
+#define ALT_SETTLE_TICKS (CONTROL_RATE_HZ / 4) // Time for the ADC buffer to fill
+
+// Task rates
+#define BUTTONS_RATE_HZ 100
+#define STATE_RATE_HZ 50
+#define RAMP_RATE_HZ 4          // Keeps the setpoint ramps at their old speed
+#define OLED_RATE_HZ 5
+#define SERIAL_RATE_HZ 2
+#define COMMAND_RATE_HZ 20      // Empties the UART receive buffer well before
+                                // it fills at 115200 baud
+#define RECORDER_RATE_HZ 20     // Fast enough to keep the UART busy during a dump
 
 //*****************************************************************************
 // Global Variables
@@ -22,9 +40,11 @@
 uint8_t height_setpoint;
 uint16_t pwm_main_duty = 0;
 uint16_t pwm_tail_duty = 0;
-bool display_refresh = true;
 bool main_on = false;
 bool calibrated;
+uint16_t init_alt = 0;
+uint32_t mean_val = 0;
+pidval_t yawDegrees;    // In the control law's number format
 
 enum State {CALIBRATING, LANDED, FLYING, LANDING}; //states of heli
 uint8_t state = LANDED; //initial state
@@ -34,32 +54,70 @@ uint8_t state = LANDED; //initial state
 //*****************************************************************************
 
 // Calculates the yaw in degrees
-float calcYaw(void) {
-    float yawDegrees = yawTicks * (360.0/448.0);
+pidval_t calcYaw(void) {
+    pidval_t yawDegrees = PID_MUL(PID_FROM_INT(getYawTicks()),
+                                  PID_FROM_FLOAT(360.0f / YAW_TICKS_PER_REV));
     return yawDegrees;
 }
 
 // Polls the buttons to adjust setpoints accordingly.
 void pollButtons(void) {
     uint8_t butState;
+    bool pushed = false;
     // Button polling
     butState = checkButton (LEFT);
     if (butState == PUSHED) {
         yaw_setpoint -= 15;
+        pushed = true;
     }
     butState = checkButton (RIGHT);
     if (butState == PUSHED) {
         yaw_setpoint += 15;
+        pushed = true;
     }
     butState = checkButton (UP);
     if (butState == PUSHED && height_setpoint <= 90) {
         height_setpoint += 10;
+        pushed = true;
     }
     butState = checkButton (DOWN);
     if (butState == PUSHED && height_setpoint >= 10) {
         height_setpoint -= 10;
+        pushed = true;
+    }
+    if (pushed) {
+        frTrigger(FR_TRIG_BUTTON);
     }
-    updateButtons (); // Poll the buttons
+}
+
+// Adds this control tick to the flight recorder, and triggers a capture when
+// a rotor first saturates in flight.
+void recordFlight(uint32_t tick) {
+    static bool was_saturated = false;
+    bool saturated;
+    frRecord_t record;
+
+    record.tick = tick;
+    record.altRaw = getLatestADCSample();
+    record.altMean = mean_val;
+    record.yawTicks = getYawTicks();
+    record.yawSetpoint = yaw_setpoint;
+    record.altError = frTenths(altPID.previous);
+    record.altIntegral = frTenths(altPID.integrated);
+    record.yawError = frTenths(yawPID.previous);
+    record.yawIntegral = frTenths(yawPID.integrated);
+    record.altSetpoint = height_setpoint;
+    record.mainDuty = pwm_main_duty;
+    record.tailDuty = pwm_tail_duty;
+    record.state = state;
+    frRecord(&record);
+
+    saturated = state == FLYING
+            && (pidSaturated(&altPID) || pidSaturated(&yawPID));
+    if (saturated && !was_saturated) {
+        frTrigger(FR_TRIG_SATURATE);
+    }
+    was_saturated = saturated;
 }
 
 // Returns the current state based on switch state, previous state, and whether heli
@@ -71,15 +129,18 @@ uint8_t determineState(bool main_on, uint8_t state, bool calibrated) {
     if (!main_on && state == FLYING) {
         curr_state = LANDING;
     // not calibrated
-    } else if (!yawRefFound && !calibrated) { //if not calibrated
+    } else if (!getYawRefFound() && !calibrated) { //if not calibrated
         curr_state = CALIBRATING;
     // finished calibrating
-    } else if (yawRefFound && !calibrated ){
+    } else if (getYawRefFound() && !calibrated ){
         main_on = false;
         calibrated = true;
         curr_state = LANDED;
-    } else if (main_on && state == LANDED){ //turning on
+    } else if (main_on && (state == LANDED || state == FLYING)){ //turning on or staying up
         curr_state = FLYING;
+    // still coming down
+    } else if (state == LANDING && (height_setpoint != 0 || yaw_setpoint != 0)) {
+        curr_state = LANDING;
     } else { // switched off
         curr_state = LANDED;
     }
@@ -87,71 +148,175 @@ uint8_t determineState(bool main_on, uint8_t state, bool calibrated) {
 }
 
 //*****************************************************************************
-// Main Gadfly Loop
+// Tasks
+//*****************************************************************************
+
+// Runs the control law: averages the altitude, updates the PID with the real
+// time elapsed since the last run and sets the rotor duties.
+void controlTask(void) {
+    static uint16_t settle = 0;
+    static uint32_t last_tick = 0;
+    uint32_t tick = getControlTickCount();
+    pidval_t dt = pidTicksToDt(tick - last_tick, CONTROL_RATE_HZ);
+    int16_t height_pct;
+    last_tick = tick;
+
+    // Calculate the rounded mean of the buffer contents
+    mean_val = calcBufferMean(); //rounded mean, kept up to date by the ADC ISR
+
+    // Latch the starting altitude as 0% once the buffer has filled
+    if (settle < ALT_SETTLE_TICKS) {
+        settle += 1;
+        init_alt = initAlt(mean_val, settle == ALT_SETTLE_TICKS);
+    }
+
+    yawDegrees = calcYaw();
+    height_pct = getHeightPercent(init_alt, mean_val); //calculate percentage
+    updatePID(dt, height_pct, yawDegrees, height_setpoint, yaw_setpoint, state);
+
+    // Implementing the PID control
+    pwm_tail_duty = PID_TO_INT(yawPID.output);
+    pwm_main_duty = PID_TO_INT(altPID.output);
+    setPWM_main(pwm_main_duty);
+    setPWM_tail(pwm_tail_duty);
+    SLOG_DUTIES(pwm_main_duty, pwm_tail_duty);
+
+    recordFlight(tick);
+}
+
+// Debounces the buttons.
+void buttonsTask(void) {
+    updateButtons ();
+}
+
+// Reads the switch, finds the current state and sets the setpoints that
+// depend on it.
+void stateTask(void) {
+    if (mainSwitchStateChanged(main_on) == 1) {
+        main_on = !main_on; //toggle state
+    }
+
+    //find current state
+    uint8_t prev_state = state;
+    state = determineState(main_on, state, calibrated);
+    // Only taking off and landing trigger the recorder. The changes while
+    // calibrating at power up would otherwise take the one capture.
+    if (state != prev_state
+        && (state == FLYING || state == LANDING
+            || prev_state == FLYING || prev_state == LANDING)) {
+        frTrigger(FR_TRIG_STATE);
+    }
+
+    // switch case determining set points dependent on the current state
+    switch (state) {
+        case LANDED: height_setpoint = 0; yaw_setpoint = 0; pwm_main_duty = 0; pwm_tail_duty = 0;
+                     calibrated = true; height_setpoint = 0; main_on = false; //resetting main_on so it doesnt begin flying immediately
+                     break;
+        case FLYING: pollButtons(); break;
+    }
+}
+
+// Ramps the setpoints while calibrating and landing.
+void rampTask(void) {
+    switch (state) {
+        case CALIBRATING: height_setpoint = 10; yaw_setpoint += 1; break;
+        case LANDING: if (yaw_setpoint == 0 && height_setpoint != 0) {height_setpoint -= (height_setpoint < 2) ? height_setpoint : 2;}
+                      if (yaw_setpoint > 0) {yaw_setpoint -= (yaw_setpoint < 2) ? yaw_setpoint : 2;}
+                      if (yaw_setpoint < 0) {yaw_setpoint += (yaw_setpoint > -2) ? -yaw_setpoint : 2;} break;//gradually return to origin
+    }
+}
+
+// Updates the OLED display.
+void oledTask(void) {
+    display_oled(mean_val, init_alt, PID_TO_FLOAT(yawDegrees), yaw_setpoint,
+                 height_setpoint, pwm_main_duty, pwm_tail_duty);
+}
+
+// Sends the serial output. Commands received are run by commandTask.
+void serialTask(void) {
+#if !defined(TELEMETRY_BINARY) && !defined(SENSOR_LOG)
+    display_serial(mean_val, init_alt, PID_TO_FLOAT(yawDegrees), yaw_setpoint,
+                   height_setpoint, pwm_main_duty, pwm_tail_duty);
+#endif
+}
+
+// Runs the commands received over serial. The setpoints belong to the
+// buttons and ramps outside of flight, and to a torque calibration.
+void commandTask(void) {
+    cmdService(&height_setpoint, &yaw_setpoint,
+               state == FLYING && !ffCalRunning());
+}
+
+// Holds the altitude at each torque calibration level while flying. Landing
+// stops the calibration.
+void calibrateTask(void) {
+    if (ffCalRunning()) {
+        if (state == FLYING) {
+            height_setpoint = ffCalUpdate(altPID.output, yawPID.output);
+        } else if (state == LANDING) {
+            ffCalStop();
+        }
+    }
+}
+
+// Streams out a flight recorder dump, if one has been started.
+void recorderTask(void) {
+    frDumpService();
+}
+
+#ifdef TELEMETRY_BINARY
+// Sends a binary telemetry frame of the control loop signals.
+void telemetryTask(void) {
+    telemFrame_t frame;
+    frame.state = state;
+    frame.altSetpoint = height_setpoint;
+    frame.altPercent = getHeightPercent(init_alt, mean_val);
+    frame.yawSetpoint = yaw_setpoint;
+    frame.yawTenths = frTenths(yawDegrees);
+    frame.mainDuty = pwm_main_duty;
+    frame.tailDuty = pwm_tail_duty;
+    frame.altError = PID_TO_FLOAT(altPID.previous);
+    frame.altIntegral = PID_TO_FLOAT(altPID.integrated);
+    frame.altDerivative = PID_TO_FLOAT(altPID.derivative);
+    frame.yawError = PID_TO_FLOAT(yawPID.previous);
+    frame.yawIntegral = PID_TO_FLOAT(yawPID.integrated);
+    frame.yawDerivative = PID_TO_FLOAT(yawPID.derivative);
+    frame.overruns = getControlOverruns();
+    sendTelemetry(&frame);
+}
+#endif
+
+// Task table, highest priority first
+task_t tasks[] = {
+//   name       function     rate              budget us
+    {"control", controlTask, CONTROL_RATE_HZ,  200},
+    {"buttons", buttonsTask, BUTTONS_RATE_HZ,  50},
+    {"state",   stateTask,   STATE_RATE_HZ,    50},
+    {"ramp",    rampTask,    RAMP_RATE_HZ,     50},
+    {"oled",    oledTask,    OLED_RATE_HZ,     3000},
+    {"serial",  serialTask,  SERIAL_RATE_HZ,   2000},
+    {"command", commandTask, COMMAND_RATE_HZ,  2000},
+    {"recorder", recorderTask, RECORDER_RATE_HZ, 2000},
+    {"ffcal",   calibrateTask, FF_CAL_RATE_HZ, 2000},
+#ifdef TELEMETRY_BINARY
+    {"telem",   telemetryTask, TELEMETRY_RATE_HZ, 2000},
+#endif
+#ifdef SENSOR_LOG
+    {"slog",    slogService, SLOG_RATE_HZ,     2000},
+#endif
+};
+
+//*****************************************************************************
+// Main
 //*****************************************************************************
 int
 main(void)
 {
     IntMasterDisable(); // Disable interrupts to the processor for setup
-    // Initialises local variables for use within the main loop
-    uint32_t buffer_sum;
-	uint8_t settle = 0;
-	uint16_t init_alt;
-	uint32_t mean_val;
-    float yawDegrees;
-    uint32_t delta = 5;
-    int16_t height_pct;
-
 	initAll(); // Initializes the clock, ADC, OLED display, buffer and peripheral buttons etc
+	initControlTick(CONTROL_RATE_HZ);
+	initScheduler(tasks, sizeof(tasks) / sizeof(tasks[0]));
     IntMasterEnable(); // Enable interrupts to the processor.
 
-	while (1) //Gadfly loop
-	{
-	    if (mainSwitchStateChanged(main_on) == 1) {
-	        main_on = !main_on; //toggle state
-	    }
-
-	    //find current state
-	    state = determineState(main_on, state, calibrated);
-
-	    // switch case determining set points dependent on the current state
-	    switch (state) {
-            case LANDED: height_setpoint = 0; yaw_setpoint = 0; pwm_main_duty = 0; pwm_tail_duty = 0;
-                         calibrated = true; height_setpoint = 0; main_on = false; //resetting main_on so it doesnt begin flying immediately
-                         break;
-            case CALIBRATING: height_setpoint = 10; yaw_setpoint += 1; break;
-            case LANDING: if (yaw_setpoint == 0 && height_setpoint != 0) {height_setpoint -= 2;}
-                          if (yaw_setpoint != 0) {yaw_setpoint += 2;} break;//gradually return to origin
-            case FLYING: pollButtons(); break;
-	    }
-
-		// Background task: calculate the (approximate) mean of the values in the
-		// circular buffer and display it, together with the sample number.
-		buffer_sum = calcBufferSum();
-		mean_val = ((float)buffer_sum)/BUF_SIZE + 0.5; //calculate mean with rounding
-
-		// Initialise the starting altitude to 0%
-		init_alt = initAlt(mean_val, settle);
-		if (settle > 1) {
-		    settle = 2; // So the settle int doesnt overflow
-		} else {
-		    settle += 1;
-		}
-
-		// Calculate and display the rounded mean of the buffer contents
-	    yawDegrees = calcYaw();
-	    display_refresh = update_display(mean_val, init_alt, yawDegrees, display_refresh, yaw_setpoint,
-	                   height_setpoint, pwm_main_duty, pwm_tail_duty);
-		height_pct = getHeightPercent(init_alt, mean_val); //calculate percentage
-		float *PID = updatePID(delta, height_pct, yawDegrees, height_setpoint, yaw_setpoint);
-
-		// Implementing the PID control
-        pwm_tail_duty = PID[0];
-        pwm_main_duty = PID[1];
-		setPWM_main(pwm_main_duty);
-		setPWM_tail(pwm_tail_duty);
-
-        SysCtlDelay (SysCtlClockGet() / 8);  // Set gadfly loop timing
-	}
+    runScheduler();
 }
-
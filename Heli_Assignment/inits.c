@@ -8,14 +8,13 @@
 //*****************************************************************************
 
 #include "inits.h"
+#include "control_tick.h"
+#include "gain_schedule.h"
+#include "torque_ff.h"
 
-#define SAMPLE_RATE_HZ 320
-#define BUF_SIZE 10
-
-PIDError yawErrorState;
-PIDError altErrorState;
-float *PIDvalues;
-volatile bool yawPrevious;
+volatile int16_t yaw_setpoint;
+PIDController yawPID;
+PIDController altPID;
 static uint32_t g_ulSampCnt;    // Counter for the interrupts
 static circBuf_t g_inBuffer;    // Buffer of size BUF_SIZE integers (sample values)
 
@@ -25,9 +24,12 @@ static circBuf_t g_inBuffer;    // Buffer of size BUF_SIZE integers (sample valu
 //*****************************************************************************
 void SysTickIntHandler(void)
 {
+    yawSensorTick();
+#if !defined(ADC_USE_DMA) && !defined(ADC_SYNC_TO_PWM)
     // Initiate a conversion
     ADCProcessorTrigger(ADC0_BASE, 3);
     g_ulSampCnt++;
+#endif
 }
 
 
@@ -55,14 +57,33 @@ initClock (void)
 //*****************************************************************************
 void ADCIntHandler(void)
 {
+    PROFILE_START(PROF_ADC_ISR);
     uint32_t ulValue;
     // Get the single sample from ADC0.  ADC_BASE is defined in
     // inc/hw_memmap.h
     ADCSequenceDataGet(ADC0_BASE, 3, &ulValue);
+    SLOG_ADC_SAMPLE(ulValue);
     // Place it in the circular buffer (advancing write index)
     writeCircBuf (&g_inBuffer, ulValue);
     // Clean up, clearing the interrupt
     ADCIntClear(ADC0_BASE, 3);
+    PROFILE_END(PROF_ADC_ISR);
+}
+
+//*****************************************************************************
+// Places a block of samples delivered by the uDMA into the circular buffer.
+// Called from the ADC interrupt once per block.
+//*****************************************************************************
+void processADCBlock(const uint16_t *samples, uint32_t count)
+{
+    PROFILE_START(PROF_ADC_ISR);
+    uint32_t i;
+    for (i = 0; i < count; i++) {
+        SLOG_ADC_SAMPLE(samples[i]);
+        writeCircBuf (&g_inBuffer, samples[i]);
+    }
+    g_ulSampCnt += count;
+    PROFILE_END(PROF_ADC_ISR);
 }
 
 //*****************************************************************************
@@ -71,12 +92,24 @@ void ADCIntHandler(void)
 void
 initADC (void)
 {
+#if defined(ADC_USE_DMA) && defined(ADC_SYNC_TO_PWM)
+    initPWMADCTrigger(PWM_ADC_PHASE);
+    initADCDMA(ADC_TRIGGER_PWM3, 0, processADCBlock);
+#elif defined(ADC_USE_DMA)
+    initADCDMA(ADC_TRIGGER_TIMER, ADC_SAMPLE_RATE_HZ, processADCBlock);
+#else
     // The ADC0 peripheral must be enabled for configuration and use.
     SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
     // Enable sample sequence 3 with a processor signal trigger.  Sequence 3
     // will do a single sample when the processor sends a signal to start the
-    // conversion.
+    // conversion. When synchronised to the PWM the main rotor generator
+    // sends the signal instead.
+#ifdef ADC_SYNC_TO_PWM
+    initPWMADCTrigger(PWM_ADC_PHASE);
+    ADCSequenceConfigure(ADC0_BASE, 3, ADC_TRIGGER_PWM3, 0);
+#else
     ADCSequenceConfigure(ADC0_BASE, 3, ADC_TRIGGER_PROCESSOR, 0);
+#endif
     // Configure step 0 on sequence 3.  Sample channel 0 (ADC_CTL_CH0) in
     // single-ended mode (default) and configure the interrupt flag
     // (ADC_CTL_IE) to be set when the sample is done.  Tell the ADC logic
@@ -93,122 +126,49 @@ initADC (void)
     ADCIntRegister (ADC0_BASE, 3, ADCIntHandler);
     // Enable interrupts for ADC0 sequence 3 (clears any outstanding interrupts)
     ADCIntEnable(ADC0_BASE, 3);
+#endif
 }
 
 //*****************************************************************************
-// Initialisation and configuration of quadrature encoder pins. Requires the use
-// 2 pins that when read, can be used to calculate the exact current 
-// rotaional yaw position of the heli-rig
-//*****************************************************************************
-void initEncoder(void)
-{
-    // Pin B0 setup
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);        // Enable port B
-    GPIOPinTypeGPIOInput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);  // Init PB0 as input
-    GPIOPadConfigSet(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1,
-       GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);  // Enable weak pullup resistor for PB0
-}
-
-//*****************************************************************************
-// Initialisation and configuration of the pin that reads LOW when the heli-rig
-// is facing the camera (yaw reference point)
-//*****************************************************************************
-void initYawRef(void)
-{
-    // Pin C4 setup
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);        // Enable port C
-    GPIOPinTypeGPIOInput(GPIO_PORTC_BASE, GPIO_PIN_4);  // Init PC4 as input
-    GPIOPadConfigSet(GPIO_PORTC_BASE, GPIO_PIN_4,
-       GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);  // Enable weak pullup resistor for PC4
-    GPIODirModeSet(GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_DIR_MODE_IN);
-
-}
-
-//*****************************************************************************
-// Using quadrature encoding, calulates the exact current rotional yaw position
-// of the heli rig using the values of 2 yaw encoder pins.
-//*****************************************************************************
-void readYaw(void) {
-    IntMasterDisable();
-    bool AChan = (bool)GPIOPinRead(GPIO_PORTB_BASE,GPIO_PIN_0);
-    bool BChan = (bool)GPIOPinRead(GPIO_PORTB_BASE,GPIO_PIN_1);
-    bool direction = AChan ^ yawPrevious;
-    if (direction) {yawTicks -= 1;}
-    else {yawTicks += 1;}
-    yawPrevious = BChan;
-    GPIOIntClear(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);// Clear interrupt flag
-    IntMasterEnable();
-}
-
-//*****************************************************************************
-// Initialisation and configuration of an interrupt that detects a change of
-// yaw. Is used to trigger a calulation of the new yaw position. Active on both
-// edges (CW and CCW rotations).
+// Return the sum of the circular buffer, which is a value indicating the
+// heli-rig's current altitude. The buffer keeps a running sum as the ADC ISR
+// writes to it, so this no longer walks the buffer.
 //*****************************************************************************
-void initIntYaw(void)
-{
-    GPIOIntDisable(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-    GPIOIntClear(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-    GPIOIntRegister(GPIO_PORTB_BASE, readYaw);     // Register our handler function for port F
-    GPIOIntTypeSet(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1,
-            GPIO_BOTH_EDGES);// Configure PF4 for falling edge trigger
-    GPIOIntEnable(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-}
-
-
-
-//*****************************************************************************
-// For calibration purposes. Let's the module know that the yaw reference 
-// point is now known, and that any future yaw changes will be calculated
-// to that point.
-//*****************************************************************************
-void readYawRef(void)
-{
-    IntMasterDisable();
-    yawTicks = 0;
-    yaw_setpoint = 0;
-    yawRefFound = 1;
-    IntMasterEnable();
+uint32_t calcBufferSum(void){
+    return sumCircBuf (&g_inBuffer);
 }
 
 //*****************************************************************************
-// Initialisation and configuration of the interrupt triggered by the heli-rig
-// facing the camera (yaw reference point).
+// Return the most recent ADC sample written to the circular buffer.
 //*****************************************************************************
-void initIntYawRef(void)
-{
-    GPIOIntDisable(GPIO_PORTC_BASE, GPIO_PIN_4);
-    GPIOIntClear(GPIO_PORTC_BASE, GPIO_PIN_4);
-    GPIOIntRegister(GPIO_PORTC_BASE, readYawRef);
-    GPIOIntTypeSet(GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_FALLING_EDGE);
-    GPIOIntEnable(GPIO_PORTC_BASE, GPIO_PIN_4);
+uint32_t getLatestADCSample(void){
+    return g_inBuffer.data[(g_inBuffer.windex + g_inBuffer.size - 1)
+                           % g_inBuffer.size];
 }
 
 //*****************************************************************************
-// Read the contents of a circular buffer to return a value indicating 
-// the heli-rig's current altitude.
+// Return the rounded mean of the circular buffer.
 //*****************************************************************************
-uint32_t calcBufferSum(void){
-    uint16_t i; // counter variable for use in for loops
-    uint32_t buffer_sum = 0;
-    for (i = 0; i < BUF_SIZE; i++) {
-        buffer_sum = buffer_sum + readCircBuf (&g_inBuffer);
-    }
-    return buffer_sum;
+uint32_t calcBufferMean(void){
+    PROFILE_START(PROF_BUFFER_MEAN);
+    uint32_t mean = meanCircBuf (&g_inBuffer);
+    PROFILE_END(PROF_BUFFER_MEAN);
+    return mean;
 }
 
 //*****************************************************************************
-// Calls the PID module to return error new, error controlled PWM values
+// Updates the altitude and yaw controllers, whose outputs are the main and
+// tail duties. The yaw controller's output includes the torque feedforward.
+// The gains are scheduled first.
 //*****************************************************************************
-float* updatePID(uint32_t delta, int16_t height_pct, float yawDegrees, uint8_t height_setpoint, uint16_t yaw_setpoint) {
-    PIDvalues = PIDUpdate(delta,
-                           height_pct,
-                           yawDegrees,
-                           height_setpoint,
-                           yaw_setpoint,
-                           &yawErrorState,
-                           &altErrorState);
-    return PIDvalues;
+void updatePID(pidval_t dt, int16_t height_pct, pidval_t yawDegrees, uint8_t height_setpoint, int16_t yaw_setpoint, uint8_t state) {
+    PROFILE_START(PROF_PID);
+    gsUpdate(&altPID, &yawPID, state, height_pct);
+    pidUpdate(&altPID, PID_FROM_INT(height_setpoint), PID_FROM_INT(height_pct), dt);
+    // The tail balances the main rotor torque at the duty just set
+    yawPID.feedforward = ffTail(altPID.output);
+    pidUpdate(&yawPID, PID_FROM_INT(yaw_setpoint), yawDegrees, dt);
+    PROFILE_END(PROF_PID);
 }
 
 //*****************************************************************************
@@ -229,22 +189,29 @@ uint16_t initAlt(uint32_t curr_alt, uint8_t settle) {
 // loop.
 //*****************************************************************************
 void initAll(void) {
-    yawPrevious = (GPIOPinRead(GPIO_PORTB_BASE, GPIO_PIN_1));
+    initProfile();
     initCircBuf (&g_inBuffer, BUF_SIZE);
     initSerial();
-    initPWM();
     initMainSwitchState();
-    initYawPID(&yawErrorState);
-    initAltPID(&altErrorState);
+    pidInit(&yawPID, YAW_KP, YAW_KI, YAW_KD, PID_OUTPUT_MIN, PID_OUTPUT_MAX,
+            pidTicksToDt(1, CONTROL_RATE_HZ));
+    pidSetAntiWindup(&yawPID, YAW_ANTI_WINDUP, YAW_KB);
+    pidSetDerivative(&yawPID, YAW_D_SOURCE, YAW_D_FILTER, YAW_D_CUTOFF);
+    pidInit(&altPID, ALT_KP, ALT_KI, ALT_KD, PID_OUTPUT_MIN, PID_OUTPUT_MAX,
+            pidTicksToDt(1, CONTROL_RATE_HZ));
+    pidSetAntiWindup(&altPID, ALT_ANTI_WINDUP, ALT_KB);
+    pidSetDerivative(&altPID, ALT_D_SOURCE, ALT_D_FILTER, ALT_D_CUTOFF);
     initButtons ();
     initClock();
+    initPWM(); // After the clock too, or the PWM runs at 250 Hz
+    initDisplay(); // After the clock, as the SSI rate is set from it
     initADC();
-    initEncoder();
-    initYawRef();
-    initIntYawRef();
-    initIntYaw();
+    initYawSensor();
     PWMOutputState(PWM_MAIN_BASE, PWM_MAIN_OUTBIT, true);
     PWMOutputState(PWM_TAIL_BASE, PWM_TAIL_OUTBIT, true);
+#ifdef SENSOR_LOG
+    slogInit(); // After the inputs are set up, to log their starting levels
+#endif
 }
 
 
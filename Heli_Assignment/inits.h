@@ -11,7 +11,26 @@
 #define INITS_H_
 
 #define SAMPLE_RATE_HZ 320
-#define BUF_SIZE 10
+
+// Define to acquire altitude samples with a timer-triggered ADC and uDMA
+// ping-pong buffers instead of one SysTick and one ADC interrupt per sample
+//#define ADC_USE_DMA
+
+// Define to trigger altitude samples from the main rotor PWM generator rather
+// than SysTick or Timer0, so every sample lands at the same point in the
+// motor switching cycle (see PWM_ADC_PHASE_PC in pwm.h)
+//#define ADC_SYNC_TO_PWM
+
+#if defined(ADC_SYNC_TO_PWM)
+#define ADC_SAMPLE_RATE_HZ (2 * PWM_RATE_HZ) // Once each way through the up/down count
+#elif defined(ADC_USE_DMA)
+#define ADC_SAMPLE_RATE_HZ 3200
+#else
+#define ADC_SAMPLE_RATE_HZ SAMPLE_RATE_HZ
+#endif
+
+// Number of samples averaged, giving the same ~31 ms window at any rate
+#define BUF_SIZE ((ADC_SAMPLE_RATE_HZ * 10 + SAMPLE_RATE_HZ / 2) / SAMPLE_RATE_HZ)
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -33,12 +52,19 @@
 #include "controller_mode.h"
 #include "PID.h"
 #include "circBufT.h"
+#include "adc_dma.h"
+#include "yaw.h"
+#include "profile.h"
+#include "sensor_log.h"
 
-volatile int16_t yaw_setpoint;
-volatile bool yawRefFound;
-volatile int32_t yawTicks;
-PIDError yawErrorState;
-PIDError altErrorState;
+extern volatile int16_t yaw_setpoint;
+extern PIDController yawPID;  // Tail duty
+extern PIDController altPID;  // Main duty
+
+//*****************************************************************************
+// Write a block of ADC samples into the altitude buffer
+//*****************************************************************************
+void processADCBlock(const uint16_t *samples, uint32_t count);
 
 //*****************************************************************************
 // Calculate the sum of all items in the circular buffer
@@ -46,13 +72,25 @@ PIDError altErrorState;
 uint32_t calcBufferSum(void);
 
 //*****************************************************************************
-// Update the PID
+// Return the most recent raw altitude sample
+//*****************************************************************************
+uint32_t getLatestADCSample(void);
+
+//*****************************************************************************
+// Calculate the rounded mean of all items in the circular buffer
+//*****************************************************************************
+uint32_t calcBufferMean(void);
+
+//*****************************************************************************
+// Update the altitude and yaw PID controllers, with the gains scheduled for
+// the flight state (enum State in heli_main.c) and altitude
 //*****************************************************************************
-float* updatePID(uint32_t delta,
-                 int16_t height_pct,
-                 float yawDegrees,
-                 uint8_t height_setpoint,
-                 uint16_t yaw_setpoint);
+void updatePID(pidval_t dt,
+               int16_t height_pct,
+               pidval_t yawDegrees,
+               uint8_t height_setpoint,
+               int16_t yaw_setpoint,
+               uint8_t state);
 
 //*****************************************************************************
 // Initialise the altitude to 0%
@@ -0,0 +1,33 @@
+//*****************************************************************************
+//
+// pid_gains.h - Gains of the altitude and yaw PID controllers. The tuning
+//               tool in host/tune writes a file of this form with the gains
+//               it recommends, which can replace this one.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef PID_GAINS_H_
+#define PID_GAINS_H_
+
+//*****************************************************************************
+// Errors are integrated and differentiated per second. The gains were tuned
+// with a fixed deltaT of 5 on a loop that took ~375 ms, so KI and KD are
+// scaled by 5/0.375 to keep the same response. These are the gains tuned by
+// hand on the rig. The filtered derivative left the rig model wanting a yaw
+// KP of 2.25 and KD of 9.0 (HELI_RIG_GAINS=yaw_kp=2.25,yaw_kd=0.675), as the
+// unfiltered encoder steps had been adding damping of their own; a header
+// from host/tune replaces this one once a retune has been flown on the rig.
+//*****************************************************************************
+#define PID_TUNED_SCALE (5.0f / 0.375f)
+
+#define PID_GAIN_ALT_KP 0.6f
+#define PID_GAIN_ALT_KI (0.0093f * PID_TUNED_SCALE)
+#define PID_GAIN_ALT_KD (0.5f / PID_TUNED_SCALE)
+#define PID_GAIN_YAW_KP 1.0f
+#define PID_GAIN_YAW_KI (0.0009f * PID_TUNED_SCALE)
+#define PID_GAIN_YAW_KD (2.0f / PID_TUNED_SCALE)
+
+#endif /* PID_GAINS_H_ */
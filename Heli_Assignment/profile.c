@@ -0,0 +1,126 @@
+//*****************************************************************************
+//
+// profile.c - Profiling of hot code paths. Sections are timed with the
+//             Cortex-M DWT cycle counter and each keeps its min, max, mean
+//             and a histogram by powers of two cycles. On a host build the
+//             counter is replaced by a monotonic clock so the same markers
+//             work in simulation.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "profile.h"
+#include "uartstdio.h"
+
+#ifdef HOST_BUILD
+#include <time.h>
+#else
+#include "inc/hw_types.h"
+
+#define DEMCR       0xE000EDFC  // Debug Exception and Monitor Control
+#define DEMCR_TRCENA 0x01000000 // Enables the DWT
+#define DWT_CTRL    0xE0001000  // DWT Control
+#define DWT_CYCCNT  0xE0001004  // DWT Cycle Count
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#endif
+
+//*****************************************************************************
+// Statistics kept for each section
+//*****************************************************************************
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t hist[PROFILE_HIST_BINS];
+} profileStats_t;
+
+static const char *sectionNames[PROF_NUM_SECTIONS] = {
+    "pidUpdate", "BufferMean", "OLED", "Serial", "OledUpdate", "readYaw",
+    "ADC ISR"
+};
+
+static profileStats_t stats[PROF_NUM_SECTIONS];
+
+//*****************************************************************************
+// Start the cycle counter
+//*****************************************************************************
+void initProfile(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < PROF_NUM_SECTIONS; i++) {
+        stats[i].min = UINT32_MAX;
+    }
+#ifndef HOST_BUILD
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+#endif
+}
+
+//*****************************************************************************
+// Return the cycle counter. On a host build this is a monotonic clock in ns.
+//*****************************************************************************
+uint32_t profileCycles(void)
+{
+#ifdef HOST_BUILD
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000000000ull + now.tv_nsec);
+#else
+    return HWREG(DWT_CYCCNT);
+#endif
+}
+
+//*****************************************************************************
+// Add one timing of a section to its statistics. Bin n of the histogram
+// counts timings of 2^n to 2^(n+1)-1 cycles, with the last bin catching
+// everything longer.
+//*****************************************************************************
+void profileRecord(uint8_t section, uint32_t cycles)
+{
+    profileStats_t *s = &stats[section];
+    uint32_t bin = 0;
+    uint32_t c = cycles;
+
+    while ((c >>= 1) != 0 && bin < PROFILE_HIST_BINS - 1) {
+        bin++;
+    }
+    s->hist[bin]++;
+    s->count++;
+    s->total += cycles;
+    if (cycles < s->min) {
+        s->min = cycles;
+    }
+    if (cycles > s->max) {
+        s->max = cycles;
+    }
+}
+
+//*****************************************************************************
+// Print the statistics of every section over serial, one line per section
+// followed by its histogram.
+//*****************************************************************************
+void profileDump(void)
+{
+    uint8_t i;
+    uint8_t bin;
+
+    UARTprintf("Section\tCount\tMin\tMean\tMax\n");
+    for (i = 0; i < PROF_NUM_SECTIONS; i++) {
+        profileStats_t *s = &stats[i];
+        if (s->count == 0) {
+            continue;
+        }
+        UARTprintf("%s\t%u\t%u\t%u\t%u\n", sectionNames[i], s->count, s->min,
+                   (uint32_t)(s->total / s->count), s->max);
+        UARTprintf(" hist");
+        for (bin = 0; bin < PROFILE_HIST_BINS; bin++) {
+            UARTprintf(" %u", s->hist[bin]);
+        }
+        UARTprintf("\n");
+    }
+}
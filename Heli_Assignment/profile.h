@@ -0,0 +1,65 @@
+//*****************************************************************************
+//
+// profile.h - Header file for profiling hot code paths with the DWT cycle
+//             counter
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+
+// Define to compile in the profiling markers. When left undefined the
+// markers compile to nothing.
+//#define PROFILE_ENABLED
+
+#define PROFILE_HIST_BINS 16    // Histogram bins, by powers of two cycles
+
+//*****************************************************************************
+// Profiled sections of code
+//*****************************************************************************
+enum profileSection {
+    PROF_PID = 0,
+    PROF_BUFFER_MEAN,
+    PROF_DISPLAY_OLED,
+    PROF_DISPLAY_SERIAL,
+    PROF_OLED_UPDATE,
+    PROF_READ_YAW,
+    PROF_ADC_ISR,
+    PROF_NUM_SECTIONS
+};
+
+#ifdef PROFILE_ENABLED
+#define PROFILE_START(section) uint32_t profileStart_##section = profileCycles()
+#define PROFILE_END(section) \
+    profileRecord(section, profileCycles() - profileStart_##section)
+#else
+#define PROFILE_START(section)
+#define PROFILE_END(section)
+#endif
+
+//*****************************************************************************
+// Start the cycle counter
+//*****************************************************************************
+void initProfile(void);
+
+//*****************************************************************************
+// Return the cycle counter. On a host build this is a monotonic clock in ns.
+//*****************************************************************************
+uint32_t profileCycles(void);
+
+//*****************************************************************************
+// Add one timing of a section to its statistics
+//*****************************************************************************
+void profileRecord(uint8_t section, uint32_t cycles);
+
+//*****************************************************************************
+// Print the statistics of every section over serial
+//*****************************************************************************
+void profileDump(void);
+
+#endif /* PROFILE_H_ */
@@ -17,6 +17,7 @@
 #define PWM_DIVIDER_CODE  SYSCTL_PWMDIV_2
 #define PWM_DIVIDER  1
 uint32_t ui32Period;
+uint8_t PWM_ADC_PHASE = PWM_ADC_PHASE_PC;
 
 /*******************************************
  *      PWM Hardware Details.
@@ -93,3 +94,25 @@ void initPWM(void)
     // Disable the output.  Repeat this call with 'true' to turn O/P on.
     PWMOutputState(PWM_TAIL_BASE, PWM_TAIL_OUTBIT, false);
 }
+
+//*****************************************************************************
+// Trigger the ADC from the main rotor PWM generator. Comparator A of the main
+// generator drives output 6, which is not pinned out, so it is free to set
+// the sample point. The generator counts up from zero to the load value and
+// back down. PWMPulseWidthSet puts the comparator at the load value less
+// half the width, and the output is high while the count is above it, so
+// the on pulse is centred on the load value and the off time on zero. A
+// width of phase_pc percent of the period puts comparator A phase_pc percent
+// of the way from the load value (middle of the pulse) down to zero (middle
+// of the off time). The ADC is triggered as the count passes it on the way
+// up and on the way down, giving two samples per period placed
+// symmetrically about the middle of the off time, both outside any main
+// rotor pulse shorter than phase_pc percent of the period.
+//*****************************************************************************
+void initPWMADCTrigger(uint32_t phase_pc)
+{
+    PWMPulseWidthSet(PWM_MAIN_BASE, PWM_OUT_6,
+        ui32Period * phase_pc / 100);
+    PWMGenIntTrigEnable(PWM_MAIN_BASE, PWM_MAIN_GEN,
+        PWM_TR_CNT_AU | PWM_TR_CNT_AD);
+}
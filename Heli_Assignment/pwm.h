@@ -33,6 +33,14 @@
 #define PWM_DIVIDER_CODE  SYSCTL_PWMDIV_2
 #define PWM_DIVIDER  1
 
+// Point in the main rotor PWM period at which the ADC is triggered when
+// ADC_SYNC_TO_PWM is defined, from 0 at the centre of the on pulse to 100 at
+// the centre of the off time. The two samples each period fall either side
+// of the centre of the off time, and miss the on pulse while the main duty
+// is below PWM_ADC_PHASE_PC percent. Keep it below 100, where both samples
+// would fall on the same count.
+#define PWM_ADC_PHASE_PC  90
+
 /*******************************************
  *      PWM Hardware Details.
  *******************************************/
@@ -73,4 +81,15 @@ void setPWM_tail(uint16_t pwm_tail_duty);
 //*****************************************************************************
 void initPWM(void);
 
+//*****************************************************************************
+// ADC trigger phase, initialised from PWM_ADC_PHASE_PC. A variable so the rig
+// model can try others.
+//*****************************************************************************
+extern uint8_t PWM_ADC_PHASE;
+
+//*****************************************************************************
+// Trigger the ADC from the main rotor PWM generator at the given phase
+//*****************************************************************************
+void initPWMADCTrigger(uint32_t phase_pc);
+
 #endif /* PWM_H_ */
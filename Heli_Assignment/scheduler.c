@@ -0,0 +1,136 @@
+//*****************************************************************************
+//
+// scheduler.c - Cooperative multi-rate task scheduler. Each control tick,
+//               the tasks that are due are run in priority order. If a new
+//               tick arrives while lower priority tasks are still waiting,
+//               they are left pending so the higher priority tasks of the
+//               new tick run first. Tasks are timed against their budget.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "scheduler.h"
+#include "control_tick.h"
+#include "driverlib/sysctl.h"
+#include "uartstdio.h"
+#include "sensor_log.h"
+
+static task_t *g_tasks;
+static uint32_t g_numTasks;
+static uint32_t g_startTicks;
+static uint32_t g_cyclesPerUs;      // Of the processor clock, set at start up
+static uint32_t g_cyclesPerTick;
+
+//*****************************************************************************
+// Set up the schedule. tasks is in priority order, highest first. A task
+// whose rate does not divide CONTROL_RATE_HZ is reported and never run.
+//*****************************************************************************
+void initScheduler(task_t *tasks, uint32_t numTasks)
+{
+    uint32_t i;
+
+    g_tasks = tasks;
+    g_numTasks = numTasks;
+    g_cyclesPerUs = SysCtlClockGet() / 1000000;
+    g_cyclesPerTick = SysCtlClockGet() / CONTROL_RATE_HZ;
+    for (i = 0; i < numTasks; i++) {
+        if (tasks[i].rateHz == 0 || CONTROL_RATE_HZ % tasks[i].rateHz != 0) {
+            UARTprintf("sched: %s at %u Hz does not divide the %u Hz control"
+                       " rate, so is not run\n", tasks[i].name,
+                       tasks[i].rateHz, CONTROL_RATE_HZ);
+            tasks[i].period = 0;
+        } else {
+            tasks[i].period = CONTROL_RATE_HZ / tasks[i].rateHz;
+        }
+        tasks[i].countdown = 1;
+        tasks[i].pending = false;
+        tasks[i].runs = 0;
+        tasks[i].overBudget = 0;
+        tasks[i].maxCycles = 0;
+        tasks[i].totalCycles = 0;
+    }
+    g_startTicks = getControlTickCount();
+}
+
+//*****************************************************************************
+// Run a single task, timing it against its budget
+//*****************************************************************************
+static void runTask(task_t *task)
+{
+    uint32_t start = getControlTime();
+    uint32_t cycles;
+
+    SLOG_TASK_RUN(task - g_tasks);
+    task->run();
+    cycles = getControlTime() - start;
+    task->runs++;
+    task->totalCycles += cycles;
+    if (cycles > task->maxCycles) {
+        task->maxCycles = cycles;
+    }
+    if (cycles > task->budgetUs * g_cyclesPerUs) {
+        task->overBudget++;
+    }
+}
+
+//*****************************************************************************
+// Run the schedule forever, one control tick at a time
+//*****************************************************************************
+void runScheduler(void)
+{
+    uint32_t elapsed;
+    uint32_t tick;
+    uint32_t i;
+
+    while (1) {
+        elapsed = waitForControlTick();
+        tick = getControlTickCount();
+        SLOG_TICK_ELAPSED(elapsed);
+
+        // Work out which tasks have come due
+        for (i = 0; i < g_numTasks; i++) {
+            if (g_tasks[i].period == 0) {
+                continue;
+            }
+            if (elapsed >= g_tasks[i].countdown) {
+                g_tasks[i].pending = true;
+                g_tasks[i].countdown = g_tasks[i].period;
+            } else {
+                g_tasks[i].countdown -= elapsed;
+            }
+        }
+
+        // Run them in priority order, going back for the next tick as soon
+        // as it arrives
+        for (i = 0; i < g_numTasks && getControlTickCount() == tick; i++) {
+            if (g_tasks[i].pending) {
+                g_tasks[i].pending = false;
+                runTask(&g_tasks[i]);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+// Print the task table, with each task's timing and CPU share, over serial.
+// CPU share is in tenths of a percent of the time since start up.
+//*****************************************************************************
+void schedulerReport(void)
+{
+    uint64_t elapsed = (uint64_t)(getControlTickCount() - g_startTicks)
+        * g_cyclesPerTick;
+    uint32_t i;
+
+    UARTprintf("Task\tHz\tRuns\tMean us\tMax us\tBudget\tOver\tCPU %%\n");
+    for (i = 0; i < g_numTasks; i++) {
+        task_t *task = &g_tasks[i];
+        uint32_t mean = task->runs ? (uint32_t)(task->totalCycles / task->runs) : 0;
+        uint32_t share = elapsed ? (uint32_t)(task->totalCycles * 1000 / elapsed) : 0;
+        UARTprintf("%s\t%u\t%u\t%u\t%u\t%u\t%u\t%u.%u\n",
+                   task->name, task->rateHz, task->runs,
+                   mean / g_cyclesPerUs, task->maxCycles / g_cyclesPerUs,
+                   task->budgetUs, task->overBudget, share / 10, share % 10);
+    }
+}
@@ -0,0 +1,51 @@
+//*****************************************************************************
+//
+// scheduler.h - Header file for the cooperative multi-rate task scheduler
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+// A task in the schedule. The first four fields are set in the task table,
+// the rest are filled in by the scheduler.
+//*****************************************************************************
+typedef struct {
+    const char *name;
+    void (*run)(void);
+    uint32_t rateHz;        // Runs a second, dividing CONTROL_RATE_HZ
+    uint32_t budgetUs;      // Time the task is expected to fit within
+    uint32_t period;        // Control ticks between runs, 0 if rejected
+    uint32_t countdown;     // Control ticks until the next run
+    bool pending;           // Due to run
+    uint32_t runs;          // Number of times run
+    uint32_t overBudget;    // Number of runs longer than budgetUs
+    uint32_t maxCycles;     // Longest run
+    uint64_t totalCycles;   // Time spent in the task
+} task_t;
+
+//*****************************************************************************
+// Set up the schedule. tasks is in priority order, highest first. A task
+// whose rate does not divide CONTROL_RATE_HZ, including any faster than it,
+// is reported over serial and never run.
+//*****************************************************************************
+void initScheduler(task_t *tasks, uint32_t numTasks);
+
+//*****************************************************************************
+// Run the schedule forever, one control tick at a time
+//*****************************************************************************
+void runScheduler(void);
+
+//*****************************************************************************
+// Print the task table, with each task's timing and CPU share, over serial
+//*****************************************************************************
+void schedulerReport(void);
+
+#endif /* SCHEDULER_H_ */
@@ -0,0 +1,239 @@
+//*****************************************************************************
+//
+// sensor_log.c - Logs the sensor inputs over UART0. Events are written to a
+//                RAM ring from the interrupts and tasks as they happen, and
+//                sent from a background task in CRC checked COBS frames. If
+//                the UART falls behind and the ring fills, the events that
+//                do not fit are counted and logged as lost.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "sensor_log.h"
+
+#ifdef SENSOR_LOG
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "buttons4.h"
+#include "inits.h"
+#include "telemetry.h"
+#include "uartstdio.h"
+#include "yaw.h"
+
+#ifdef TELEMETRY_BINARY
+#error "SENSOR_LOG and TELEMETRY_BINARY both use UART0"
+#endif
+#ifdef YAW_USE_QEI
+#error "SENSOR_LOG needs the GPIO yaw decoder to see each encoder edge"
+#endif
+#if ADC_SAMPLE_RATE_HZ > SLOG_MAX_ADC_RATE_HZ
+#error "SENSOR_LOG cannot send every ADC sample at this rate over the UART"
+#endif
+#endif
+
+//*****************************************************************************
+// Event sizes, shared with the replay
+//*****************************************************************************
+static const uint8_t eventSizes[SLOG_NUM_EVENTS] = {
+    [SLOG_START] = 4,
+    [SLOG_ADC] = 3,
+    [SLOG_YAW] = 2,
+    [SLOG_YAW_REF] = 1,
+    [SLOG_INPUTS] = 2,
+    [SLOG_TICK] = 2,
+    [SLOG_TASK] = 2,
+    [SLOG_DUTY] = 3,
+    [SLOG_LOST] = 3,
+};
+
+uint32_t slogEventSize(uint8_t type)
+{
+    return type < SLOG_NUM_EVENTS ? eventSizes[type] : 0;
+}
+
+// The replay build supplies its own hooks in place of these
+#if defined(SENSOR_LOG) && !defined(SLOG_REPLAY)
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+static uint8_t g_ring[SLOG_RING_SIZE];
+static volatile uint32_t g_head;        // Bytes written, wrapping
+static volatile uint32_t g_tail;        // Bytes sent, wrapping
+static uint16_t g_lost;                 // Events lost since the last LOST
+static uint8_t g_inputs;
+static uint16_t g_duties = 0xFFFF;      // Last logged, main in the low byte
+static uint16_t g_sequence;
+
+//*****************************************************************************
+// Add an event to the ring. A LOST event is always left room for, so the
+// count reaches the replay as soon as the ring drains.
+//*****************************************************************************
+static void logEvent(const uint8_t *event, uint32_t len)
+{
+    bool wasDisabled = IntMasterDisable();
+    uint32_t needed = len + (g_lost ? eventSizes[SLOG_LOST] : 0);
+    uint32_t i;
+
+    if (SLOG_RING_SIZE - (g_head - g_tail) < needed + eventSizes[SLOG_LOST]) {
+        if (g_lost < UINT16_MAX) {
+            g_lost++;
+        }
+    } else {
+        if (g_lost) {
+            g_ring[g_head++ % SLOG_RING_SIZE] = SLOG_LOST;
+            g_ring[g_head++ % SLOG_RING_SIZE] = g_lost;
+            g_ring[g_head++ % SLOG_RING_SIZE] = g_lost >> 8;
+            g_lost = 0;
+        }
+        for (i = 0; i < len; i++) {
+            g_ring[g_head++ % SLOG_RING_SIZE] = event[i];
+        }
+    }
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+// Read the switch and the buttons, as raw pin levels
+//*****************************************************************************
+static uint8_t readInputs(void)
+{
+    uint8_t inputs = 0;
+
+    if (GPIOPinRead(GPIO_PORTA_BASE, GPIO_PIN_7)) {
+        inputs |= SLOG_IN_SWITCH;
+    }
+    if (GPIOPinRead(UP_BUT_PORT_BASE, UP_BUT_PIN)) {
+        inputs |= SLOG_IN_UP;
+    }
+    if (GPIOPinRead(DOWN_BUT_PORT_BASE, DOWN_BUT_PIN)) {
+        inputs |= SLOG_IN_DOWN;
+    }
+    if (GPIOPinRead(LEFT_BUT_PORT_BASE, LEFT_BUT_PIN)) {
+        inputs |= SLOG_IN_LEFT;
+    }
+    if (GPIOPinRead(RIGHT_BUT_PORT_BASE, RIGHT_BUT_PIN)) {
+        inputs |= SLOG_IN_RIGHT;
+    }
+    return inputs;
+}
+
+static uint8_t readEncoder(void)
+{
+    uint32_t pins = GPIOPinRead(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    return ((pins & GPIO_PIN_0) ? 2 : 0) | ((pins & GPIO_PIN_1) ? 1 : 0);
+}
+
+//*****************************************************************************
+// Events
+//*****************************************************************************
+void slogInit(void)
+{
+    uint8_t event[] = {SLOG_START, SLOG_VERSION, 0, 0};
+
+    g_inputs = readInputs();
+    event[2] = g_inputs;
+    event[3] = readEncoder();
+    logEvent(event, sizeof(event));
+}
+
+void slogAdc(uint16_t value)
+{
+    uint8_t event[] = {SLOG_ADC, value, value >> 8};
+    logEvent(event, sizeof(event));
+}
+
+void slogYaw(uint8_t state)
+{
+    uint8_t event[] = {SLOG_YAW, state};
+    logEvent(event, sizeof(event));
+}
+
+void slogYawRef(void)
+{
+    uint8_t event[] = {SLOG_YAW_REF};
+    logEvent(event, sizeof(event));
+}
+
+void slogTick(uint32_t elapsed)
+{
+    uint8_t event[] = {SLOG_TICK, elapsed > UINT8_MAX ? UINT8_MAX : elapsed};
+
+    if (elapsed != 1) {
+        logEvent(event, sizeof(event));
+    }
+}
+
+// The inputs are polled by the tasks, so a change is logged before the
+// next task that could see it
+void slogTask(uint8_t index)
+{
+    uint8_t inputs = readInputs();
+    uint8_t event[] = {SLOG_INPUTS, inputs};
+
+    if (inputs != g_inputs) {
+        g_inputs = inputs;
+        logEvent(event, sizeof(event));
+    }
+    event[0] = SLOG_TASK;
+    event[1] = index;
+    logEvent(event, sizeof(event));
+}
+
+void slogDuty(uint16_t mainDuty, uint16_t tailDuty)
+{
+    uint8_t event[] = {SLOG_DUTY, mainDuty, tailDuty};
+    uint16_t duties = event[1] | (event[2] << 8);
+
+    if (duties != g_duties) {
+        g_duties = duties;
+        logEvent(event, sizeof(event));
+    }
+}
+
+//*****************************************************************************
+// Send whole events from the ring, a frame at a time, while the UART buffer
+// has room. A frame that does not fit stays in the ring for the next run.
+//*****************************************************************************
+void slogService(void)
+{
+    uint8_t raw[2 + SLOG_PAYLOAD_SIZE + 2];
+    uint8_t encoded[sizeof(raw) + 2];
+    uint32_t head = g_head;
+    uint32_t tail;
+    uint32_t len;
+    uint32_t size;
+    uint16_t crc;
+
+    while (g_tail != head) {
+        tail = g_tail;
+        raw[0] = g_sequence;
+        raw[1] = g_sequence >> 8;
+        len = 2;
+        while (tail != head) {
+            size = eventSizes[g_ring[tail % SLOG_RING_SIZE]];
+            if (len + size > 2 + SLOG_PAYLOAD_SIZE) {
+                break;
+            }
+            while (size--) {
+                raw[len++] = g_ring[tail++ % SLOG_RING_SIZE];
+            }
+        }
+        crc = telemCrc16(raw, len);
+        raw[len++] = crc;
+        raw[len++] = crc >> 8;
+        len = telemCobsEncode(raw, len, encoded);
+        if (!UARTwriteRaw(encoded, len)) {
+            return;
+        }
+        g_tail = tail;
+        g_sequence++;
+    }
+}
+
+#endif /* SENSOR_LOG && !SLOG_REPLAY */
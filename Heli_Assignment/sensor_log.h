@@ -0,0 +1,101 @@
+//*****************************************************************************
+//
+// sensor_log.h - Header file for logging the sensor inputs over UART0, so a
+//                flight on the rig can be replayed through the firmware on
+//                a PC with host/replay
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef SENSOR_LOG_H_
+#define SENSOR_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Define to log every ADC sample, encoder edge, switch and button change
+// and task run over UART0, in place of the text status block. Capture the
+// serial port to a file and replay it with host/heli_replay.
+//#define SENSOR_LOG
+
+#define SLOG_VERSION 1
+#define SLOG_RATE_HZ 100        // Frames sent per second, at most
+#define SLOG_RING_SIZE 2048     // Bytes of events waiting to be sent, 2^n
+#define SLOG_PAYLOAD_SIZE 200   // Most bytes of events in one frame
+#define SLOG_MAX_ADC_RATE_HZ 1000 // ADC samples per second the UART keeps up with
+
+// Frame layout, all fields little-endian:
+//   sequence  uint16, incremented every frame, to spot lost frames
+//   events    whole events, each a type byte and its fields
+//   crc       CRC-16/CCITT-FALSE of the sequence and events
+// COBS encoded and followed by a single zero byte, as the telemetry frames.
+//
+// Events are logged in the order they happen. The interrupt events between
+// two task events happened while the first task ran.
+enum slogEvent {
+    SLOG_START = 1,     // version, input levels, encoder AB state
+    SLOG_ADC,           // uint16 sample
+    SLOG_YAW,           // encoder AB state after an edge
+    SLOG_YAW_REF,       // falling edge of the yaw reference
+    SLOG_INPUTS,        // input levels, when they change
+    SLOG_TICK,          // control ticks since the last, when not one
+    SLOG_TASK,          // index in the task table, before it runs
+    SLOG_DUTY,          // main and tail duty, percent, when the control law
+                        // changes them
+    SLOG_LOST,          // uint16 count of events lost to a full ring
+    SLOG_NUM_EVENTS
+};
+
+// Bits of the input levels
+#define SLOG_IN_SWITCH 0x01
+#define SLOG_IN_UP     0x02
+#define SLOG_IN_DOWN   0x04
+#define SLOG_IN_LEFT   0x08
+#define SLOG_IN_RIGHT  0x10
+
+//*****************************************************************************
+// Length of an event of the given type, including the type byte, or 0 if
+// the type is unknown
+//*****************************************************************************
+uint32_t slogEventSize(uint8_t type);
+
+#ifdef SENSOR_LOG
+#define SLOG_ADC_SAMPLE(value) slogAdc(value)
+#define SLOG_YAW_EDGE(state) slogYaw(state)
+#define SLOG_YAW_REF_EDGE() slogYawRef()
+#define SLOG_TICK_ELAPSED(elapsed) slogTick(elapsed)
+#define SLOG_TASK_RUN(index) slogTask(index)
+#define SLOG_DUTIES(main, tail) slogDuty(main, tail)
+#else
+#define SLOG_ADC_SAMPLE(value)
+#define SLOG_YAW_EDGE(state)
+#define SLOG_YAW_REF_EDGE()
+#define SLOG_TICK_ELAPSED(elapsed)
+#define SLOG_TASK_RUN(index)
+#define SLOG_DUTIES(main, tail)
+#endif
+
+//*****************************************************************************
+// Log the start of a run, with the input levels and encoder state. Call
+// after the inputs are set up and before interrupts are enabled.
+//*****************************************************************************
+void slogInit(void);
+
+//*****************************************************************************
+// Log events. Safe to call from interrupts.
+//*****************************************************************************
+void slogAdc(uint16_t value);
+void slogYaw(uint8_t state);
+void slogYawRef(void);
+void slogTick(uint32_t elapsed);
+void slogTask(uint8_t index);
+void slogDuty(uint16_t mainDuty, uint16_t tailDuty);
+
+//*****************************************************************************
+// Send the logged events, as many whole frames as fit in the UART buffer
+//*****************************************************************************
+void slogService(void);
+
+#endif /* SENSOR_LOG_H_ */
@@ -0,0 +1,31 @@
+//*****************************************************************************
+//
+// telemetry.c - Sends binary telemetry frames over UART0
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+#include "telemetry.h"
+#include "uartstdio.h"
+#include "control_tick.h"
+
+static uint16_t sequence = 0;
+
+//*****************************************************************************
+// Stamp, encode and send a frame
+//*****************************************************************************
+void sendTelemetry(telemFrame_t *frame) {
+    uint8_t encoded[TELEM_ENCODED_SIZE];
+    uint32_t len;
+
+    frame->version = TELEM_VERSION;
+    frame->sequence = sequence++;
+    frame->timeMs = CONTROL_TICKS_TO_MS(getControlTickCount());
+
+    // Queued whole or dropped whole, so a full buffer never splits a frame
+    len = telemEncode(frame, encoded);
+    UARTwriteRaw(encoded, len);
+}
@@ -0,0 +1,28 @@
+//*****************************************************************************
+//
+// telemetry.h - Header file for sending binary telemetry frames over UART0
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include "telemetry_frame.h"
+
+// Define to send binary telemetry frames over UART0 in place of the text
+// status block. Decode them on a PC with tools/telemetry.
+//#define TELEMETRY_BINARY
+
+#define TELEMETRY_RATE_HZ 10    // Frames per second. Each frame is 50 bytes.
+
+//*****************************************************************************
+// Fill in the version, sequence number and time stamp of frame, then encode
+// and send it
+//*****************************************************************************
+void sendTelemetry(telemFrame_t *frame);
+
+#endif /* TELEMETRY_H_ */
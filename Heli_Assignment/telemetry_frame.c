@@ -0,0 +1,189 @@
+//*****************************************************************************
+//
+// telemetry_frame.c - Packs, checks and COBS frames the binary telemetry.
+//                     Used by both the firmware and the PC decoder.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <string.h>
+#include "telemetry_frame.h"
+
+//*****************************************************************************
+// Little-endian field packing
+//*****************************************************************************
+static uint8_t *put16(uint8_t *p, uint16_t value) {
+    *p++ = value;
+    *p++ = value >> 8;
+    return p;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t value) {
+    p = put16(p, value);
+    return put16(p, value >> 16);
+}
+
+static uint8_t *putFloat(uint8_t *p, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return put32(p, bits);
+}
+
+static uint16_t get16(const uint8_t **p) {
+    uint16_t value = (*p)[0] | ((uint16_t)(*p)[1] << 8);
+    *p += 2;
+    return value;
+}
+
+static uint32_t get32(const uint8_t **p) {
+    uint32_t value = get16(p);
+    return value | ((uint32_t)get16(p) << 16);
+}
+
+static float getFloat(const uint8_t **p) {
+    uint32_t bits = get32(p);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//*****************************************************************************
+// CRC-16/CCITT-FALSE, bitwise to keep it small
+//*****************************************************************************
+uint16_t telemCrc16(const uint8_t *data, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+    uint8_t bit;
+    while (len--) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+//*****************************************************************************
+// COBS: each code byte gives the distance to the next zero. Blocks are
+// shorter than 254 bytes so a code never overflows.
+//*****************************************************************************
+uint32_t telemCobsEncode(const uint8_t *raw, uint32_t rawLen, uint8_t *out) {
+    uint32_t i;
+    uint32_t code = 0;      // Position of the current COBS code byte
+    uint32_t len = 1;
+
+    for (i = 0; i < rawLen; i++) {
+        if (raw[i] == 0) {
+            out[code] = len - code;
+            code = len++;
+        } else {
+            out[len++] = raw[i];
+        }
+    }
+    out[code] = len - code;
+    out[len++] = 0;
+    return len;
+}
+
+int32_t telemCobsDecode(const uint8_t *in, uint32_t len, uint8_t *raw,
+                        uint32_t maxLen) {
+    uint32_t rawLen = 0;
+    uint32_t i = 0;
+    uint8_t code;
+
+    while (i < len) {
+        code = in[i++];
+        if (code == 0 || (uint32_t)code - 1 > len - i) {
+            return -1;
+        }
+        while (--code) {
+            if (rawLen == maxLen) {
+                return -1;
+            }
+            raw[rawLen++] = in[i++];
+        }
+        // Every group but the last stands for a zero. Blocks are too short
+        // to need the 0xFF code, which has no zero after it.
+        if (i < len) {
+            if (rawLen == maxLen) {
+                return -1;
+            }
+            raw[rawLen++] = 0;
+        }
+    }
+    return rawLen;
+}
+
+//*****************************************************************************
+// Pack a frame, append its CRC and COBS encode it
+//*****************************************************************************
+uint32_t telemEncode(const telemFrame_t *frame, uint8_t *out) {
+    uint8_t raw[TELEM_RAW_SIZE];
+    uint8_t *p = raw;
+
+    *p++ = frame->version;
+    *p++ = frame->state;
+    p = put16(p, frame->sequence);
+    p = put32(p, frame->timeMs);
+    p = put16(p, frame->altSetpoint);
+    p = put16(p, frame->altPercent);
+    p = put16(p, frame->yawSetpoint);
+    p = put16(p, frame->yawTenths);
+    p = put16(p, frame->mainDuty);
+    p = put16(p, frame->tailDuty);
+    p = putFloat(p, frame->altError);
+    p = putFloat(p, frame->altIntegral);
+    p = putFloat(p, frame->altDerivative);
+    p = putFloat(p, frame->yawError);
+    p = putFloat(p, frame->yawIntegral);
+    p = putFloat(p, frame->yawDerivative);
+    p = put16(p, frame->overruns);
+    put16(p, telemCrc16(raw, TELEM_PAYLOAD_SIZE));
+
+    return telemCobsEncode(raw, TELEM_RAW_SIZE, out);
+}
+
+//*****************************************************************************
+// Undo the COBS encoding, check the CRC and unpack the frame
+//*****************************************************************************
+telemResult_t telemDecode(const uint8_t *in, uint32_t len,
+                          telemFrame_t *frame) {
+    uint8_t raw[TELEM_MAX_RAW_SIZE];
+    int32_t rawLen;
+    const uint8_t *p;
+
+    // Frames of another version may be any length, so only the COBS
+    // encoding can be checked before the version byte.
+    rawLen = telemCobsDecode(in, len, raw, TELEM_MAX_RAW_SIZE);
+    if (rawLen < 1) {
+        return TELEM_BAD_FRAME;
+    }
+    if (raw[0] != TELEM_VERSION) {
+        return TELEM_BAD_VERSION;
+    }
+    if (rawLen != TELEM_RAW_SIZE
+            || telemCrc16(raw, TELEM_PAYLOAD_SIZE)
+               != (raw[TELEM_PAYLOAD_SIZE] | (raw[TELEM_PAYLOAD_SIZE + 1] << 8))) {
+        return TELEM_BAD_FRAME;
+    }
+
+    p = raw;
+    frame->version = *p++;
+    frame->state = *p++;
+    frame->sequence = get16(&p);
+    frame->timeMs = get32(&p);
+    frame->altSetpoint = get16(&p);
+    frame->altPercent = get16(&p);
+    frame->yawSetpoint = get16(&p);
+    frame->yawTenths = get16(&p);
+    frame->mainDuty = get16(&p);
+    frame->tailDuty = get16(&p);
+    frame->altError = getFloat(&p);
+    frame->altIntegral = getFloat(&p);
+    frame->altDerivative = getFloat(&p);
+    frame->yawError = getFloat(&p);
+    frame->yawIntegral = getFloat(&p);
+    frame->yawDerivative = getFloat(&p);
+    frame->overruns = get16(&p);
+    return TELEM_OK;
+}
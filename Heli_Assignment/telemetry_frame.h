@@ -0,0 +1,93 @@
+//*****************************************************************************
+//
+// telemetry_frame.h - Header file for the binary telemetry frame format.
+//                     Shared by the firmware and the PC decoder, so it must
+//                     not depend on driverlib.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef TELEMETRY_FRAME_H_
+#define TELEMETRY_FRAME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Frame layout, all fields little-endian:
+//   payload   TELEM_PAYLOAD_SIZE bytes, the fields of telemFrame_t in order
+//   crc       CRC-16/CCITT-FALSE of the payload
+// The payload and CRC are COBS encoded and followed by a single zero byte,
+// so a receiver can find the start of the next frame after any error.
+#define TELEM_VERSION 1
+#define TELEM_PAYLOAD_SIZE 46
+#define TELEM_RAW_SIZE (TELEM_PAYLOAD_SIZE + 2)
+#define TELEM_ENCODED_SIZE (TELEM_RAW_SIZE + 2)   // COBS code byte, delimiter
+#define TELEM_MAX_RAW_SIZE 253  // Longest block telemCobsEncode takes
+
+//*****************************************************************************
+// Contents of one telemetry frame
+//*****************************************************************************
+typedef struct {
+    uint8_t version;        // TELEM_VERSION
+    uint8_t state;          // Flight state
+    uint16_t sequence;      // Incremented every frame, to spot lost frames
+    uint32_t timeMs;        // Time since start up
+    int16_t altSetpoint;    // Altitude setpoint, percent
+    int16_t altPercent;     // Measured altitude, percent
+    int16_t yawSetpoint;    // Yaw setpoint, degrees
+    int16_t yawTenths;      // Measured yaw, tenths of a degree
+    uint16_t mainDuty;      // Main rotor duty, percent
+    uint16_t tailDuty;      // Tail rotor duty, percent
+    float altError;         // Altitude PID error terms
+    float altIntegral;
+    float altDerivative;
+    float yawError;         // Yaw PID error terms
+    float yawIntegral;
+    float yawDerivative;
+    uint16_t overruns;      // Control loop overruns
+} telemFrame_t;
+
+//*****************************************************************************
+// CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of len bytes
+//*****************************************************************************
+uint16_t telemCrc16(const uint8_t *data, uint32_t len);
+
+//*****************************************************************************
+// COBS encode rawLen bytes, fewer than 254, into out, which must hold
+// rawLen + 2 bytes. Returns the number of bytes written, including the
+// trailing zero delimiter.
+//*****************************************************************************
+uint32_t telemCobsEncode(const uint8_t *raw, uint32_t rawLen, uint8_t *out);
+
+//*****************************************************************************
+// Undo the COBS encoding of len bytes, without the zero delimiter, into raw.
+// Returns the decoded length, or -1 if malformed or longer than maxLen.
+//*****************************************************************************
+int32_t telemCobsDecode(const uint8_t *in, uint32_t len, uint8_t *raw,
+                        uint32_t maxLen);
+
+//*****************************************************************************
+// Encode a frame into out, which must hold TELEM_ENCODED_SIZE bytes. Returns
+// the number of bytes written, including the trailing zero delimiter.
+//*****************************************************************************
+uint32_t telemEncode(const telemFrame_t *frame, uint8_t *out);
+
+//*****************************************************************************
+// Results of decoding a frame
+//*****************************************************************************
+typedef enum {
+    TELEM_OK,               // Frame decoded
+    TELEM_BAD_FRAME,        // Malformed, wrong length or failed its CRC
+    TELEM_BAD_VERSION       // A version this decoder does not know
+} telemResult_t;
+
+//*****************************************************************************
+// Decode len encoded bytes, without the zero delimiter, into frame. The
+// version byte is checked first, since the length and CRC to expect depend
+// on it.
+//*****************************************************************************
+telemResult_t telemDecode(const uint8_t *in, uint32_t len, telemFrame_t *frame);
+
+#endif /* TELEMETRY_FRAME_H_ */
@@ -0,0 +1,209 @@
+//*****************************************************************************
+//
+// torque_ff.c - Main rotor torque feedforward. The main rotor's reaction
+//               torque turns the helicopter, and the tail rotor must balance
+//               it. The yaw controller used to find the balancing duty
+//               through its integral, after the yaw had already moved; the
+//               feedforward adds it as soon as the main duty changes, so the
+//               controller only corrects what is left.
+//
+//               The calibration flight holds the helicopter at several
+//               altitudes and measures the tail duty the yaw controller
+//               settles on at each main duty. A straight line is fitted to
+//               the points and the table keeps what the line misses.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "torque_ff.h"
+#include "torque_ff_cal.h"
+#include "uartstdio.h"
+
+#define SETTLE_UPDATES (FF_CAL_SETTLE_S * FF_CAL_RATE_HZ)
+#define AVERAGE_UPDATES (FF_CAL_AVERAGE_S * FF_CAL_RATE_HZ)
+
+//*****************************************************************************
+// Feedforward settings, from torque_ff_cal.h. They are variables so a
+// calibration or a test harness can replace them.
+//*****************************************************************************
+#define TABLE_MAIN(main, tail) PID_FROM_FLOAT(main),
+#define TABLE_TAIL(main, tail) PID_FROM_FLOAT(tail),
+
+uint8_t TORQUE_FF = TORQUE_FF_DEFAULT;
+pidval_t FF_SLOPE = PID_FROM_FLOAT(TORQUE_FF_SLOPE);
+pidval_t FF_OFFSET = PID_FROM_FLOAT(TORQUE_FF_OFFSET);
+pidval_t FF_TABLE_MAIN[FF_TABLE_SIZE] = {TORQUE_FF_TABLE(TABLE_MAIN)};
+pidval_t FF_TABLE_TAIL[FF_TABLE_SIZE] = {TORQUE_FF_TABLE(TABLE_TAIL)};
+
+//*****************************************************************************
+// Calibration state
+//*****************************************************************************
+static const uint8_t g_levels[FF_TABLE_SIZE] = FF_CAL_LEVELS;
+static bool g_running;
+static uint32_t g_level;        // Index of the level being measured
+static uint32_t g_updates;      // Updates at this level so far
+static pidacc_t g_mainSum;
+static pidacc_t g_tailSum;
+static pidval_t g_mains[FF_TABLE_SIZE];     // Mean duties at each level
+static pidval_t g_tails[FF_TABLE_SIZE];
+
+//*****************************************************************************
+// Feedforward
+//*****************************************************************************
+pidval_t ffTail(pidval_t mainDuty)
+{
+    pidval_t tail;
+    uint32_t i;
+
+    if (!TORQUE_FF) {
+        return 0;
+    }
+    tail = PID_MUL(FF_SLOPE, mainDuty) + FF_OFFSET;
+    if (mainDuty <= FF_TABLE_MAIN[0]) {
+        return tail + FF_TABLE_TAIL[0];
+    }
+    for (i = 1; i < FF_TABLE_SIZE; i++) {
+        if (mainDuty < FF_TABLE_MAIN[i]) {
+            return tail + FF_TABLE_TAIL[i - 1]
+                + PID_DIV(PID_MUL(FF_TABLE_TAIL[i] - FF_TABLE_TAIL[i - 1],
+                                  mainDuty - FF_TABLE_MAIN[i - 1]),
+                          FF_TABLE_MAIN[i] - FF_TABLE_MAIN[i - 1]);
+        }
+    }
+    return tail + FF_TABLE_TAIL[FF_TABLE_SIZE - 1];
+}
+
+//*****************************************************************************
+// Send a value with three decimal places. uartstdio has no %f, and the
+// fixed point build does without floats altogether.
+//*****************************************************************************
+static void printValue(const char *before, pidval_t value, const char *after)
+{
+    pidval_t magnitude = value < 0 ? -value : value;
+#ifdef PID_FIXED_POINT
+    uint32_t thousandths = ((uint64_t)magnitude * 1000 + PID_ONE / 2)
+        >> PID_Q_BITS;
+#else
+    uint32_t thousandths = magnitude * 1000 + 0.5f;
+#endif
+
+    UARTprintf("%s%s%u.%03uf%s", before, value < 0 ? "-" : "",
+               thousandths / 1000, thousandths % 1000, after);
+}
+
+//*****************************************************************************
+// Fit a line to the measured duties by least squares and send the new
+// feedforward as a torque_ff_cal.h
+//*****************************************************************************
+static void calFinish(void)
+{
+    pidacc_t mainSum = 0;
+    pidacc_t tailSum = 0;
+    pidacc_t sxx = 0;
+    pidacc_t sxy = 0;
+    pidval_t mainMean, tailMean, dx, swap;
+    uint32_t i, j;
+
+    // Order the points by main duty, for the table
+    for (i = 1; i < FF_TABLE_SIZE; i++) {
+        for (j = i; j > 0 && g_mains[j] < g_mains[j - 1]; j--) {
+            swap = g_mains[j];
+            g_mains[j] = g_mains[j - 1];
+            g_mains[j - 1] = swap;
+            swap = g_tails[j];
+            g_tails[j] = g_tails[j - 1];
+            g_tails[j - 1] = swap;
+        }
+    }
+
+    for (i = 0; i < FF_TABLE_SIZE; i++) {
+        mainSum += g_mains[i];
+        tailSum += g_tails[i];
+    }
+    mainMean = mainSum / FF_TABLE_SIZE;
+    tailMean = tailSum / FF_TABLE_SIZE;
+    for (i = 0; i < FF_TABLE_SIZE; i++) {
+        dx = g_mains[i] - mainMean;
+        sxx += PID_MUL(dx, dx);
+        sxy += PID_MUL(dx, g_tails[i] - tailMean);
+    }
+
+    FF_SLOPE = sxx > 0 ? PID_DIV(pidNarrow(sxy), pidNarrow(sxx)) : 0;
+    FF_OFFSET = tailMean - PID_MUL(FF_SLOPE, mainMean);
+    for (i = 0; i < FF_TABLE_SIZE; i++) {
+        FF_TABLE_MAIN[i] = g_mains[i];
+        FF_TABLE_TAIL[i] = g_tails[i]
+            - (PID_MUL(FF_SLOPE, g_mains[i]) + FF_OFFSET);
+    }
+
+    UARTprintf("\ntorque ff: calibrated, torque_ff_cal.h follows\n"
+               "#ifndef TORQUE_FF_CAL_H_\n"
+               "#define TORQUE_FF_CAL_H_\n\n");
+    printValue("#define TORQUE_FF_SLOPE ", FF_SLOPE, "\n");
+    printValue("#define TORQUE_FF_OFFSET ", FF_OFFSET, "\n");
+    UARTprintf("\n// X(main duty, tail correction), by ascending main duty\n"
+               "#define TORQUE_FF_TABLE(X)");
+    for (i = 0; i < FF_TABLE_SIZE; i++) {
+        printValue(" \\\n    X(", FF_TABLE_MAIN[i], "");
+        printValue(", ", FF_TABLE_TAIL[i], ")");
+    }
+    UARTprintf("\n\n#endif /* TORQUE_FF_CAL_H_ */\nend\n");
+}
+
+//*****************************************************************************
+// Calibration
+//*****************************************************************************
+void ffCalStart(void)
+{
+    g_running = true;
+    g_level = 0;
+    g_updates = 0;
+    g_mainSum = 0;
+    g_tailSum = 0;
+    UARTprintf("\ntorque ff: calibration starts when flying\n");
+}
+
+void ffCalStop(void)
+{
+    if (g_running) {
+        g_running = false;
+        UARTprintf("\ntorque ff: calibration stopped\n");
+    }
+}
+
+bool ffCalRunning(void)
+{
+    return g_running;
+}
+
+uint8_t ffCalUpdate(pidval_t mainDuty, pidval_t tailDuty)
+{
+    uint8_t altitude = g_levels[g_level];
+
+    if (!g_running) {
+        return altitude;
+    }
+    g_updates++;
+    if (g_updates > SETTLE_UPDATES) {
+        g_mainSum += mainDuty;
+        g_tailSum += tailDuty;
+    }
+    if (g_updates == SETTLE_UPDATES + AVERAGE_UPDATES) {
+        g_mains[g_level] = g_mainSum / AVERAGE_UPDATES;
+        g_tails[g_level] = g_tailSum / AVERAGE_UPDATES;
+        g_mainSum = 0;
+        g_tailSum = 0;
+        g_updates = 0;
+        if (g_level + 1 < FF_TABLE_SIZE) {
+            g_level++;
+            altitude = g_levels[g_level];
+        } else {
+            g_running = false;
+            calFinish();
+            TORQUE_FF = 1;
+        }
+    }
+    return altitude;
+}
@@ -0,0 +1,72 @@
+//*****************************************************************************
+//
+// torque_ff.h - Header file for the main rotor torque feedforward, which
+//               adds the tail duty that balances the main rotor's reaction
+//               torque to the yaw controller's output, and for the flight
+//               that calibrates it
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef TORQUE_FF_H_
+#define TORQUE_FF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "PID.h"
+
+// The feedforward starts off until torque_ff_cal.h has been measured on the
+// rig with ffcal, which turns it on when it finishes
+#define TORQUE_FF_DEFAULT 0
+#define FF_TABLE_SIZE 5         // Calibration points in the lookup table
+
+// Calibration flight. The altitude is held at each level for the settling
+// time, then the duties are averaged.
+#define FF_CAL_RATE_HZ 10
+#define FF_CAL_LEVELS {10, 30, 50, 70, 90}  // Altitude, percent
+#define FF_CAL_SETTLE_S 10
+#define FF_CAL_AVERAGE_S 4
+
+//*****************************************************************************
+// Feedforward settings, from torque_ff_cal.h. The tail duty is
+// slope * main + offset, plus the table correction interpolated between the
+// main duties it was measured at and held beyond them.
+//*****************************************************************************
+extern uint8_t TORQUE_FF;
+extern pidval_t FF_SLOPE, FF_OFFSET;
+extern pidval_t FF_TABLE_MAIN[FF_TABLE_SIZE];   // Ascending
+extern pidval_t FF_TABLE_TAIL[FF_TABLE_SIZE];   // Corrections
+
+//*****************************************************************************
+// Tail duty that balances the torque of the main rotor at the given duty, or
+// 0 with the feedforward off
+//*****************************************************************************
+pidval_t ffTail(pidval_t mainDuty);
+
+//*****************************************************************************
+// Start a calibration. It waits until the helicopter is flying, then steps
+// the altitude through FF_CAL_LEVELS.
+//*****************************************************************************
+void ffCalStart(void);
+
+//*****************************************************************************
+// Abandon a calibration, keeping the feedforward it started with
+//*****************************************************************************
+void ffCalStop(void);
+
+//*****************************************************************************
+// Return true while a calibration is waiting or running
+//*****************************************************************************
+bool ffCalRunning(void);
+
+//*****************************************************************************
+// Step a calibration on with the duties the controllers are asking for,
+// FF_CAL_RATE_HZ times a second while flying. Returns the altitude to hold.
+// When the last level is measured the new feedforward is put in use and
+// sent over serial in the form of torque_ff_cal.h.
+//*****************************************************************************
+uint8_t ffCalUpdate(pidval_t mainDuty, pidval_t tailDuty);
+
+#endif /* TORQUE_FF_H_ */
@@ -0,0 +1,28 @@
+//*****************************************************************************
+//
+// torque_ff_cal.h - Calibration of the main rotor torque feedforward. A
+//                   calibration flight, started with ffcal over serial,
+//                   sends a file of this form to replace this one. These
+//                   were measured on the rig model in host/rig, not on the
+//                   rig, so TORQUE_FF_DEFAULT leaves them unused.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef TORQUE_FF_CAL_H_
+#define TORQUE_FF_CAL_H_
+
+#define TORQUE_FF_SLOPE 0.795f
+#define TORQUE_FF_OFFSET -1.650f
+
+// X(main duty, tail correction), by ascending main duty
+#define TORQUE_FF_TABLE(X) \
+    X(35.702f, 0.427f) \
+    X(38.688f, -0.631f) \
+    X(40.472f, -0.165f) \
+    X(42.447f, 0.280f) \
+    X(44.519f, 0.088f)
+
+#endif /* TORQUE_FF_CAL_H_ */
@@ -35,7 +35,6 @@
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
-#include "utils/uartstdio.h"
 #include "uartstdio.h"
 
 //*****************************************************************************
@@ -84,6 +83,13 @@ static unsigned char g_pcUARTRxBuffer[UART_RX_BUFFER_SIZE];
 static volatile uint32_t g_ui32UARTRxWriteIndex = 0;
 static volatile uint32_t g_ui32UARTRxReadIndex = 0;
 
+//*****************************************************************************
+//
+// Number of bytes discarded because the transmit buffer was full.
+//
+//*****************************************************************************
+static uint32_t g_ui32UARTTxOverflow = 0;
+
 //*****************************************************************************
 //
 // Macros to determine number of free and used bytes in the transmit buffer.
@@ -487,6 +493,11 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
         }
     }
 
+    //
+    // Count anything discarded for lack of space.
+    //
+    g_ui32UARTTxOverflow += ui32Len - uIdx;
+
     //
     // If we have anything in the buffer, make sure that the UART is set
     // up to transmit it.
@@ -537,6 +548,89 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
 #endif
 }
 
+//*****************************************************************************
+//
+//! Writes a block of bytes to the UART output without translation.
+//!
+//! \param pvBuf points to the bytes to transmit.
+//! \param ui32Len is the number of bytes to transmit.
+//!
+//! Unlike UARTwrite(), LF characters are not expanded to CRLF and null
+//! characters are sent, so this is suitable for binary data.
+//!
+//! In buffered mode the block is either queued whole or, if there is not
+//! enough space in the transmit buffer, discarded whole and counted as
+//! overflow, so a partial block is never sent.  In non-buffered mode this
+//! function blocks until all the bytes have been written to the output FIFO.
+//!
+//! \return Returns the count of bytes written.
+//
+//*****************************************************************************
+int
+UARTwriteRaw(const void *pvBuf, uint32_t ui32Len)
+{
+    const unsigned char *pucBuf = pvBuf;
+    uint32_t uIdx;
+
+    //
+    // Check for valid arguments.
+    //
+    ASSERT(pvBuf != 0);
+    ASSERT(g_ui32Base != 0);
+
+#ifdef UART_BUFFERED
+    //
+    // Drop the whole block if it will not fit.  One slot is always left free
+    // to tell a full buffer from an empty one.
+    //
+    if(ui32Len >= TX_BUFFER_FREE)
+    {
+        g_ui32UARTTxOverflow += ui32Len;
+        return(0);
+    }
+
+    for(uIdx = 0; uIdx < ui32Len; uIdx++)
+    {
+        g_pcUARTTxBuffer[g_ui32UARTTxWriteIndex] = pucBuf[uIdx];
+        ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxWriteIndex);
+    }
+
+    //
+    // Make sure that the UART is set up to transmit it.
+    //
+    if(ui32Len)
+    {
+        UARTPrimeTransmit(g_ui32Base);
+        MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
+    }
+#else
+    for(uIdx = 0; uIdx < ui32Len; uIdx++)
+    {
+        MAP_UARTCharPut(g_ui32Base, pucBuf[uIdx]);
+    }
+#endif
+
+    return(ui32Len);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of bytes discarded because the transmit buffer was full.
+//!
+//! \return Returns the overflow count, which is always zero in non-buffered
+//! mode.
+//
+//*****************************************************************************
+uint32_t
+UARTTxOverflowCount(void)
+{
+#ifdef UART_BUFFERED
+    return(g_ui32UARTTxOverflow);
+#else
+    return(0);
+#endif
+}
+
 //*****************************************************************************
 //
 //! A simple UART based get string function, with some line processing.
@@ -40,6 +40,14 @@ extern "C"
 {
 #endif
 
+//*****************************************************************************
+//
+// Buffer output in RAM and send it from the UART interrupt, so that writes
+// never wait on the transmit FIFO.  Comment out for blocking output.
+//
+//*****************************************************************************
+#define UART_BUFFERED
+
 //*****************************************************************************
 //
 // If built for buffered operation, the following labels define the sizes of
@@ -73,7 +81,6 @@ extern "C"
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
-#include "utils/uartstdio.h"
 
 extern void UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock);
 extern int UARTgets(char *pcBuf, uint32_t ui32Len);
@@ -81,6 +88,8 @@ extern unsigned char UARTgetc(void);
 extern void UARTprintf(const char *pcString, ...);
 extern void UARTvprintf(const char *pcString, va_list aArgP);
 extern int UARTwrite(const char *pcBuf, uint32_t ui32Len);
+extern int UARTwriteRaw(const void *pvBuf, uint32_t ui32Len);
+extern uint32_t UARTTxOverflowCount(void);
 #ifdef UART_BUFFERED
 extern int UARTPeek(unsigned char ucChar);
 extern void UARTFlushTx(bool bDiscard);
@@ -88,6 +97,7 @@ extern void UARTFlushRx(void);
 extern int UARTRxBytesAvail(void);
 extern int UARTTxBytesFree(void);
 extern void UARTEchoSet(bool bEnable);
+extern void UARTStdioIntHandler(void);
 #endif
 
 //*****************************************************************************
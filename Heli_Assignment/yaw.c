@@ -0,0 +1,308 @@
+//*****************************************************************************
+//
+// yaw.c - Yaw sensor: quadrature encoder and reference point. The encoder is
+//         decoded either in software from a GPIO interrupt on every edge of
+//         PB0/PB1, or in hardware by the QEI1 peripheral.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "yaw.h"
+#include "inits.h"
+#include "inc/hw_qei.h"
+#include "inc/hw_types.h"
+#include "driverlib/qei.h"
+
+static volatile int32_t yawTicks;
+static volatile bool yawRefFound;
+static volatile uint32_t yawErrors;
+static uint32_t yawErrorRate;
+static uint32_t yawEdgeRate;
+
+//*****************************************************************************
+// For calibration purposes. Let's the module know that the yaw reference 
+// point is now known, and that any future yaw changes will be calculated
+// to that point. Only the first find moves the setpoint; passing the
+// reference in flight just re-zeroes the count and keeps the heading asked
+// for.
+//*****************************************************************************
+static void setYawRef(void)
+{
+    yawTicks = 0;
+    if (!yawRefFound) {
+        yaw_setpoint = 0;
+    }
+    yawRefFound = 1;
+}
+
+#ifdef YAW_USE_QEI
+
+#error "YAW_USE_QEI takes PC5, the main rotor PWM, as QEI1 PhA"
+
+static uint32_t prevErrors;
+static uint32_t tickCount;
+
+//*****************************************************************************
+// Index and phase error interrupt from the QEI. The hardware counter is
+// zeroed at the reference point in the same way as the GPIO backend, and
+// phase errors (both channels changing at once) are counted.
+//*****************************************************************************
+static void yawQEIIntHandler(void)
+{
+    uint32_t status = QEIIntStatus(QEI1_BASE, true);
+    QEIIntClear(QEI1_BASE, status);
+    if (status & QEI_INTINDEX) {
+        QEIPositionSet(QEI1_BASE, 0);
+        setYawRef();
+    }
+    if (status & QEI_INTERROR) {
+        yawErrors++;
+    }
+}
+
+//*****************************************************************************
+// Initialise QEI1 for 4x decoding of the encoder with the reference pin as
+// the index. The position counter is left free running over the full 32 bits
+// so it reads as a signed count of ticks, like the GPIO backend. Phases are
+// swapped so the direction matches the GPIO decoder.
+//*****************************************************************************
+void initYawSensor(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_QEI1);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
+    GPIOPinConfigure(GPIO_PC4_IDX1);
+    GPIOPinConfigure(GPIO_PC5_PHA1);
+    GPIOPinConfigure(GPIO_PC6_PHB1);
+    GPIOPinTypeQEI(GPIO_PORTC_BASE, GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_6);
+    GPIOPadConfigSet(GPIO_PORTC_BASE, GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_6,
+       GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+
+    QEIConfigure(QEI1_BASE, QEI_CONFIG_CAPTURE_A_B | QEI_CONFIG_NO_RESET |
+                 QEI_CONFIG_QUADRATURE | QEI_CONFIG_SWAP, 0xFFFFFFFF);
+    HWREG(QEI1_BASE + QEI_O_CTL) |= QEI_CTL_INVI; // Reference pin is active low
+    QEIVelocityConfigure(QEI1_BASE, QEI_VELDIV_1,
+                         SysCtlClockGet() / YAW_VELOCITY_RATE_HZ);
+    QEIVelocityEnable(QEI1_BASE);
+    QEIIntRegister(QEI1_BASE, yawQEIIntHandler);
+    QEIIntEnable(QEI1_BASE, QEI_INTINDEX | QEI_INTERROR);
+    QEIEnable(QEI1_BASE);
+}
+
+//*****************************************************************************
+// Return the yaw position in encoder ticks from the reference point
+//*****************************************************************************
+int32_t getYawTicks(void)
+{
+    return (int32_t)QEIPositionGet(QEI1_BASE);
+}
+
+//*****************************************************************************
+// Return the yaw velocity in encoder ticks per second, as measured by the QEI
+// over the last velocity period
+//*****************************************************************************
+int32_t getYawVelocity(void)
+{
+    return QEIDirectionGet(QEI1_BASE) * (int32_t)QEIVelocityGet(QEI1_BASE)
+        * YAW_VELOCITY_RATE_HZ;
+}
+
+//*****************************************************************************
+// Updates the once a second edge and error rates. The QEI measures the
+// velocity itself, so the edge rate is derived from it.
+//*****************************************************************************
+void yawSensorTick(void)
+{
+    tickCount++;
+    if (tickCount >= SAMPLE_RATE_HZ) {
+        uint32_t errors = yawErrors;
+        int32_t velocity = getYawVelocity();
+        yawErrorRate = errors - prevErrors;
+        yawEdgeRate = (velocity < 0) ? -velocity : velocity;
+        prevErrors = errors;
+        tickCount = 0;
+    }
+}
+
+#else
+
+#define YAW_ERR 2   // Marks an illegal transition in the decode table
+
+//*****************************************************************************
+// 4x quadrature decode table, indexed by the previous and current AB state
+// as (prevA prevB currA currB). A leading B decrements the count. Entries of
+// YAW_ERR are transitions where both channels changed at once, so the
+// direction is unknown and the edge is dropped.
+//*****************************************************************************
+static const int8_t yawDecodeTable[16] = {
+//  curr: 00       01       10       11
+          0,      +1,      -1,      YAW_ERR,   // prev 00
+         -1,       0,      YAW_ERR, +1,        // prev 01
+         +1,      YAW_ERR,  0,      -1,        // prev 10
+          YAW_ERR,-1,      +1,       0         // prev 11
+};
+
+static uint8_t yawPrevState;
+static volatile uint32_t yawEdges;
+static uint32_t prevEdges;
+static uint32_t prevErrors;
+static int32_t velocityTicks;
+static int32_t velocity;
+static uint32_t velocityCount;
+static uint32_t rateCount;
+
+//*****************************************************************************
+// Reads both encoder pins in one go and returns the AB state
+//*****************************************************************************
+static uint8_t readYawState(void)
+{
+    uint32_t pins = GPIOPinRead(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    return ((pins & GPIO_PIN_0) ? 2 : 0) | ((pins & GPIO_PIN_1) ? 1 : 0);
+}
+
+//*****************************************************************************
+// Using quadrature encoding, calulates the exact current rotional yaw position
+// of the heli rig by looking up the step from the previous to the current
+// state of the 2 yaw encoder pins.
+//*****************************************************************************
+static void readYaw(void) {
+    PROFILE_START(PROF_READ_YAW);
+    uint8_t state;
+    int8_t step;
+
+    GPIOIntClear(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);// Clear interrupt flag
+    state = readYawState();
+    SLOG_YAW_EDGE(state);
+    step = yawDecodeTable[(yawPrevState << 2) | state];
+    if (step == YAW_ERR) {
+        yawErrors++;
+    } else {
+        yawTicks += step;
+    }
+    yawEdges++;
+    yawPrevState = state;
+    PROFILE_END(PROF_READ_YAW);
+}
+
+//*****************************************************************************
+// Interrupt triggered by the heli-rig facing the camera (yaw reference point)
+//*****************************************************************************
+static void readYawRef(void)
+{
+    IntMasterDisable();
+    setYawRef();
+    SLOG_YAW_REF_EDGE();
+    GPIOIntClear(GPIO_PORTC_BASE, GPIO_PIN_4);
+    IntMasterEnable();
+}
+
+//*****************************************************************************
+// Initialisation and configuration of quadrature encoder pins PB0 and PB1,
+// and of the pin PC4 that reads LOW when the heli-rig is facing the camera
+// (yaw reference point). Both interrupt on a change: the encoder on both
+// edges (CW and CCW rotations), the reference on the falling edge.
+//*****************************************************************************
+void initYawSensor(void)
+{
+    // Pin B0 and B1 setup
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);        // Enable port B
+    GPIOPinTypeGPIOInput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    GPIOPadConfigSet(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1,
+       GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);  // Enable weak pullup resistors
+    yawPrevState = readYawState();
+
+    // Pin C4 setup
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);        // Enable port C
+    GPIOPinTypeGPIOInput(GPIO_PORTC_BASE, GPIO_PIN_4);  // Init PC4 as input
+    GPIOPadConfigSet(GPIO_PORTC_BASE, GPIO_PIN_4,
+       GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);  // Enable weak pullup resistor for PC4
+    GPIODirModeSet(GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_DIR_MODE_IN);
+
+    GPIOIntDisable(GPIO_PORTC_BASE, GPIO_PIN_4);
+    GPIOIntClear(GPIO_PORTC_BASE, GPIO_PIN_4);
+    GPIOIntRegister(GPIO_PORTC_BASE, readYawRef);
+    GPIOIntTypeSet(GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_FALLING_EDGE);
+    GPIOIntEnable(GPIO_PORTC_BASE, GPIO_PIN_4);
+
+    GPIOIntDisable(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    GPIOIntClear(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    GPIOIntRegister(GPIO_PORTB_BASE, readYaw);
+    GPIOIntTypeSet(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1, GPIO_BOTH_EDGES);
+    GPIOIntEnable(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+}
+
+//*****************************************************************************
+// Return the yaw position in encoder ticks from the reference point
+//*****************************************************************************
+int32_t getYawTicks(void)
+{
+    return yawTicks;
+}
+
+//*****************************************************************************
+// Return the yaw velocity in encoder ticks per second
+//*****************************************************************************
+int32_t getYawVelocity(void)
+{
+    return velocity;
+}
+
+//*****************************************************************************
+// Measures the velocity from the change in ticks over each velocity period,
+// and the edge and error rates once a second
+//*****************************************************************************
+void yawSensorTick(void)
+{
+    velocityCount++;
+    if (velocityCount >= SAMPLE_RATE_HZ / YAW_VELOCITY_RATE_HZ) {
+        int32_t ticks = yawTicks;
+        velocity = (ticks - velocityTicks) * YAW_VELOCITY_RATE_HZ;
+        velocityTicks = ticks;
+        velocityCount = 0;
+    }
+    rateCount++;
+    if (rateCount >= SAMPLE_RATE_HZ) {
+        uint32_t edges = yawEdges;
+        uint32_t errors = yawErrors;
+        yawEdgeRate = edges - prevEdges;
+        yawErrorRate = errors - prevErrors;
+        prevEdges = edges;
+        prevErrors = errors;
+        rateCount = 0;
+    }
+}
+
+#endif
+
+//*****************************************************************************
+// Return the total number of illegal encoder transitions since start up
+//*****************************************************************************
+uint32_t getYawErrorCount(void)
+{
+    return yawErrors;
+}
+
+//*****************************************************************************
+// Return the number of illegal encoder transitions over the last second
+//*****************************************************************************
+uint32_t getYawErrorRate(void)
+{
+    return yawErrorRate;
+}
+
+//*****************************************************************************
+// Return the number of encoder edges over the last second
+//*****************************************************************************
+uint32_t getYawEdgeRate(void)
+{
+    return yawEdgeRate;
+}
+
+//*****************************************************************************
+// Return whether the yaw reference point has been found
+//*****************************************************************************
+bool getYawRefFound(void)
+{
+    return yawRefFound;
+}
@@ -0,0 +1,69 @@
+//*****************************************************************************
+//
+// yaw.h - Header file for the yaw sensor: quadrature encoder and reference
+//         point, decoded either by GPIO interrupts or the QEI peripheral
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef YAW_H_
+#define YAW_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define YAW_TICKS_PER_REV 448
+
+// Define to decode the encoder with the QEI1 peripheral rather than a GPIO
+// interrupt on every edge. QEI1 uses PC5 (PhA), PC6 (PhB) and PC4 (index,
+// the existing yaw reference pin). PC5 is the main rotor PWM (pwm.c) on the
+// stock rig, and QEI0's pins are taken by the OLED, a button and the tail
+// PWM, so yaw.c refuses to build this until the main rotor has another pin.
+//#define YAW_USE_QEI
+
+#define YAW_VELOCITY_RATE_HZ 10     // Rate the yaw velocity is measured at
+
+//*****************************************************************************
+// Initialise the encoder, yaw reference and their interrupts
+//*****************************************************************************
+void initYawSensor(void);
+
+//*****************************************************************************
+// Return the yaw position in encoder ticks from the reference point
+//*****************************************************************************
+int32_t getYawTicks(void);
+
+//*****************************************************************************
+// Return the yaw velocity in encoder ticks per second
+//*****************************************************************************
+int32_t getYawVelocity(void);
+
+//*****************************************************************************
+// Return whether the yaw reference point has been found
+//*****************************************************************************
+bool getYawRefFound(void);
+
+//*****************************************************************************
+// Return the total number of illegal encoder transitions (glitches or missed
+// edges) seen since start up
+//*****************************************************************************
+uint32_t getYawErrorCount(void);
+
+//*****************************************************************************
+// Return the number of illegal encoder transitions over the last second
+//*****************************************************************************
+uint32_t getYawErrorRate(void);
+
+//*****************************************************************************
+// Return the number of encoder edges over the last second
+//*****************************************************************************
+uint32_t getYawEdgeRate(void);
+
+//*****************************************************************************
+// Housekeeping for the GPIO backend, to be called at SAMPLE_RATE_HZ
+//*****************************************************************************
+void yawSensorTick(void);
+
+#endif /* YAW_H_ */
@@ -0,0 +1,223 @@
+//*****************************************************************************
+//
+// adc_bench.c - Measures what altitude sampling costs the processor at a
+//               range of sample rates. Built twice against the simulated
+//               peripherals: as heli_adcbench, where SysTick starts each
+//               conversion and the ADC interrupts once per sample, and as
+//               heli_adcbench_dma with ADC_USE_DMA, where Timer0 triggers
+//               the ADC and the uDMA interrupts once per block.
+//
+// Usage:  heli_adcbench [-c] [-s seconds]
+//
+// Each rate runs in a process of its own, set up as the firmware is by
+// initAll, for a few simulated seconds of a steady altitude input. The
+// interrupts the sampling takes are counted and their handlers timed. -c
+// checks that every sample reached the altitude buffer and that its mean
+// is the input, and fails if not.
+//
+// The simulator runs a handler in no time, so the processor load is
+// estimated from the interrupt rate and the Cortex-M4's exception entry and
+// return alone, as the load column. The handlers themselves are timed on
+// the host, as ns per sample, so those times only compare the two modes.
+// On the rig, the ADC ISR section of the profile (profile.h) gives the
+// cycles a handler takes.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "sim.h"
+#include "inits.h"
+#include "inc/hw_ints.h"
+
+#define ENTRY_CYCLES 12         // Cortex-M4 exception entry, zero wait states
+#define RETURN_CYCLES 10        // and return
+#define BENCH_INPUT 1234        // Steady ADC counts
+#define DEFAULT_SECONDS 2
+
+static const uint32_t rates[] = {320, 3200, 10000, 32000, 100000};
+#define NUM_RATES (sizeof(rates) / sizeof(rates[0]))
+
+// The firmware's handlers, registered by initClock and initADC
+void SysTickIntHandler(void);
+void ADCIntHandler(void);
+
+static uint64_t handlerNs;      // Host time in the sampling handlers
+static uint32_t samples;        // Samples handed to the altitude buffer
+static uint64_t clockNs;        // Cost of one reading of the host clock
+
+static uint64_t hostNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+//*****************************************************************************
+// The cost of reading the clock, taken off each handler's time
+//*****************************************************************************
+static void calibrateClock(void)
+{
+    uint64_t start = hostNs();
+    uint32_t i;
+
+    for (i = 0; i < 1000000; i++) {
+        hostNs();
+    }
+    clockNs = (hostNs() - start) / 1000000;
+}
+
+#define TIMED(call) do { \
+        uint64_t start = hostNs(); \
+        call; \
+        handlerNs += hostNs() - start - clockNs; \
+    } while (0)
+
+//*****************************************************************************
+// Timed handlers, registered in place of the firmware's
+//*****************************************************************************
+#ifdef ADC_USE_DMA
+static void countBlock(const uint16_t *blockSamples, uint32_t count)
+{
+    samples += count;
+    processADCBlock(blockSamples, count);
+}
+
+static void timedDMAHandler(void)
+{
+    TIMED(ADCDMAIntHandler());
+}
+#else
+static void timedSysTick(void)
+{
+    TIMED(SysTickIntHandler());
+}
+
+static void timedADCHandler(void)
+{
+    samples++;
+    TIMED(ADCIntHandler());
+}
+#endif
+
+//*****************************************************************************
+// Sample at rateHz for the given simulated time, then report
+//*****************************************************************************
+static int runRate(uint32_t rateHz, double seconds, int check)
+{
+    uint64_t start;
+    uint32_t irqs;
+    uint32_t expected = (uint32_t)(rateHz * seconds);
+    uint32_t slack;
+    uint32_t mean;
+    double irqRate;
+
+    IntMasterDisable();
+    initAll();
+    simSetEndTime(SIM_NEVER);
+    simAdcSetInput(BENCH_INPUT);
+#ifdef ADC_USE_DMA
+    initADCDMA(ADC_TRIGGER_TIMER, rateHz, countBlock);
+    IntRegister(INT_ADC0SS3, timedDMAHandler);
+    slack = 2 * ADC_DMA_BLOCK_SIZE;     // One filling, one just armed
+#else
+    SysTickPeriodSet(SysCtlClockGet() / rateHz);
+    SysTickIntRegister(timedSysTick);
+    ADCIntRegister(ADC0_BASE, 3, timedADCHandler);
+    slack = 1;
+#endif
+    IntMasterEnable();
+
+    start = simNow();
+    simWaitUntil(start + (uint64_t)(seconds * SIM_PS_PER_SEC));
+    irqs = simIrqCount(INT_ADC0SS3);
+#ifndef ADC_USE_DMA
+    irqs += simIrqCount(FAULT_SYSTICK);
+#endif
+    irqRate = irqs / seconds;
+    mean = calcBufferMean();
+
+    printf("adcbench: %7u %9.0f %8.2f%% %9.1f\n", rateHz, irqRate,
+           irqRate * (ENTRY_CYCLES + RETURN_CYCLES) * 100 / SysCtlClockGet(),
+           samples ? (double)handlerNs / samples : 0.0);
+    if (check && (samples + slack < expected || samples > expected + 1
+                  || mean != BENCH_INPUT)) {
+        fprintf(stderr, "adcbench: at %u Hz, %u samples of %u buffered with"
+                " a mean of %u, not %u\n", rateHz, samples, expected, mean,
+                BENCH_INPUT);
+        return 1;
+    }
+    return 0;
+}
+
+static void usage(const char *name, int status)
+{
+    fprintf(status ? stderr : stdout,
+        "usage: %s [options]\n"
+        "  -c          check every sample is buffered with the right mean\n"
+        "  -s seconds  simulated time at each rate (default %u)\n"
+        "  -h          show this list\n",
+        name, DEFAULT_SECONDS);
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    double seconds = DEFAULT_SECONDS;
+    int check = 0;
+    int failed = 0;
+    int opt;
+    int status;
+    uint32_t i;
+
+    while ((opt = getopt(argc, argv, "cs:h")) != -1) {
+        switch (opt) {
+            case 'c': check = 1; break;
+            case 's': seconds = atof(optarg); break;
+            case 'h': usage(argv[0], 0);
+            default: usage(argv[0], 2);
+        }
+    }
+    if (optind != argc || seconds <= 0) {
+        usage(argv[0], 2);
+    }
+
+    calibrateClock();
+#ifdef ADC_USE_DMA
+    printf("adcbench: Timer0 triggered, uDMA blocks of %u samples\n",
+           ADC_DMA_BLOCK_SIZE);
+#else
+    printf("adcbench: SysTick triggered, an ADC interrupt per sample\n");
+#endif
+    printf("adcbench: rate Hz     irq/s      load ns/sample\n");
+    fflush(stdout);
+
+    // The simulated processor cannot be reset, so each rate gets a fresh one
+    for (i = 0; i < NUM_RATES; i++) {
+        pid_t child = fork();
+        if (child < 0) {
+            perror("adcbench");
+            return 1;
+        }
+        if (child == 0) {
+            status = runRate(rates[i], seconds, check);
+            fflush(stdout);
+            _exit(status);
+        }
+        if (waitpid(child, &status, 0) < 0 || !WIFEXITED(status)
+                || WEXITSTATUS(status) != 0) {
+            failed = 1;
+        }
+    }
+    if (check) {
+        fprintf(stderr, "adcbench: %u rates %s\n", (uint32_t)NUM_RATES,
+                failed ? "failed" : "buffered every sample");
+    }
+    return failed;
+}
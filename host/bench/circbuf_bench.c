@@ -0,0 +1,198 @@
+//*****************************************************************************
+//
+// circbuf_bench.c - Times the mean of the altitude buffer at a range of
+//                   window sizes, from the running sum writeCircBuf keeps
+//                   against walking the buffer with readCircBuf as
+//                   calcBufferSum used to, and checks the two agree.
+//
+// Usage:  heli_circbench [-c] [-n reads]
+//
+// Each window is filled with several times its size of 12-bit samples, so
+// the running sums have wrapped many times. -c checks the sum, mean and
+// variance against a walk of the buffer after every write, and fails if
+// any differs. Without it, writes and means are timed at each size.
+//
+// The timing is of the host build, so it only compares the two ways of
+// taking the mean. On the rig, the BufferMean section of the profile
+// (profile.h) gives the cycles a mean takes.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "circBufT.h"
+
+#define DEFAULT_READS 2000000   // Means timed at each size
+#define FILL_PASSES 5           // Times round the buffer before timing
+#define CHECK_WRITES 5000       // Writes checked at each size
+
+static const uint32_t sizes[] = {10, 16, 64, 100, 256, 1024};
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+static uint32_t seed = 12345;
+
+//*****************************************************************************
+// A 12-bit sample, as from the ADC
+//*****************************************************************************
+static uint32_t sample(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0xFFF;
+}
+
+//*****************************************************************************
+// The sum of the buffer walked with readCircBuf, as calcBufferSum did
+//*****************************************************************************
+static uint32_t walkSum(circBuf_t *buffer)
+{
+    uint32_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < buffer->size; i++) {
+        sum += readCircBuf(buffer);
+    }
+    return sum;
+}
+
+static double seconds(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+//*****************************************************************************
+// Check the running sums against a walk of the buffer after every write
+//*****************************************************************************
+static int checkSize(uint32_t size)
+{
+    circBuf_t buffer;
+    uint32_t bad = 0;
+    uint32_t i, j;
+
+    if (!initCircBuf(&buffer, size)) {
+        perror("circbench");
+        return 1;
+    }
+    for (i = 0; i < CHECK_WRITES; i++) {
+        uint32_t sum;
+        double mean, var, walkVar = 0;
+
+        writeCircBuf(&buffer, sample());
+        sum = walkSum(&buffer);
+        mean = (double)sum / size;
+        for (j = 0; j < size; j++) {
+            double d = buffer.data[j] - mean;
+            walkVar += d * d;
+        }
+        walkVar /= size;
+        var = varianceCircBuf(&buffer);
+        if (sumCircBuf(&buffer) != sum
+                || meanCircBuf(&buffer) != (sum + size / 2) / size
+                || fabs(var - walkVar) > 1e-6 * (walkVar + 1)) {
+            if (bad++ == 0) {
+                fprintf(stderr, "circbench: window %u differs at write %u:"
+                        " sum %u not %u, variance %.2f not %.2f\n",
+                        size, i, sumCircBuf(&buffer), sum, var, walkVar);
+            }
+        }
+    }
+    freeCircBuf(&buffer);
+    return bad ? 1 : 0;
+}
+
+//*****************************************************************************
+// Time the writes, the means from the running sum and the walked means
+//*****************************************************************************
+static void timeSize(uint32_t size, uint32_t reads)
+{
+    struct timespec start, end;
+    volatile uint32_t sink = 0;
+    circBuf_t buffer;
+    double writeNs, meanNs, walkNs;
+    uint32_t walks = reads / size + 1;
+    uint32_t i;
+
+    if (!initCircBuf(&buffer, size)) {
+        perror("circbench");
+        exit(1);
+    }
+    for (i = 0; i < size * FILL_PASSES; i++) {
+        writeCircBuf(&buffer, sample());
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < reads; i++) {
+        writeCircBuf(&buffer, i & 0xFFF);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    writeNs = seconds(&start, &end) * 1e9 / reads;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < reads; i++) {
+        sink += meanCircBuf(&buffer);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    meanNs = seconds(&start, &end) * 1e9 / reads;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < walks; i++) {
+        sink += (walkSum(&buffer) + size / 2) / size;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    walkNs = seconds(&start, &end) * 1e9 / walks;
+
+    printf("circbench: %5u %9.1f %9.1f %9.1f\n", size, writeNs, meanNs, walkNs);
+    freeCircBuf(&buffer);
+}
+
+static void usage(const char *name, int status)
+{
+    fprintf(status ? stderr : stdout,
+        "usage: %s [options]\n"
+        "  -c        check the running sums against a walk of the buffer\n"
+        "  -n reads  means timed at each window size (default %u)\n"
+        "  -h        show this list\n",
+        name, DEFAULT_READS);
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t reads = DEFAULT_READS;
+    int check = 0;
+    int failed = 0;
+    int opt;
+    uint32_t i;
+
+    while ((opt = getopt(argc, argv, "cn:h")) != -1) {
+        switch (opt) {
+            case 'c': check = 1; break;
+            case 'n': reads = strtoul(optarg, NULL, 10); break;
+            case 'h': usage(argv[0], 0);
+            default: usage(argv[0], 2);
+        }
+    }
+    if (optind != argc || reads == 0) {
+        usage(argv[0], 2);
+    }
+
+    if (check) {
+        for (i = 0; i < NUM_SIZES; i++) {
+            failed |= checkSize(sizes[i]);
+        }
+        fprintf(stderr, "circbench: %u writes at each of %u window sizes %s\n",
+                CHECK_WRITES, (uint32_t)NUM_SIZES,
+                failed ? "differ from a walk of the buffer"
+                       : "match a walk of the buffer");
+        return failed;
+    }
+    printf("circbench: window  write ns   mean ns   walk ns\n");
+    for (i = 0; i < NUM_SIZES; i++) {
+        timeSize(sizes[i], reads);
+    }
+    return 0;
+}
@@ -0,0 +1,343 @@
+//*****************************************************************************
+//
+// format_bench.c - Times the OLED and serial text of display.c built three
+//                  ways, with the fmt functions of format.c into buffers of
+//                  their size, with usnprintf into the same buffers, and
+//                  with sprintf into 300 byte buffers as update_display
+//                  used to, and measures the stack each way takes.
+//
+// Usage:  heli_formatbench [-c] [-n frames]
+//
+// Each frame is the OLED line and the serial frame of a set of readings
+// that change from frame to frame. The stack is measured by filling a
+// stretch of it below the caller with a pattern, building the frame and
+// finding the deepest byte overwritten, so it includes the text buffers.
+// -c checks that the three ways write the same text, truncated the same
+// way, over random readings of every size their types hold, and fails if
+// any differs.
+//
+// The timing and stack depth are of the host build and its C library, so
+// they only compare the three ways. On the rig, the DisplayOled and
+// DisplaySerial sections of the profile (profile.h) give the cycles.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "format.h"
+#include "utils/ustdlib.h"
+
+#define OLED_STRING_SIZE 65     // As in display.c
+#define SERIAL_STRING_SIZE 128
+#define OLD_STRING_SIZE 300     // As update_display had
+#define DEFAULT_FRAMES 1000000  // Frames timed each way
+#define CHECK_FRAMES 200000     // Random frames checked
+#define PAINT_BYTES 16384       // Stack filled below the caller
+#define PAINT 0xA5
+
+//*****************************************************************************
+// The readings display_oled and display_serial print
+//*****************************************************************************
+typedef struct {
+    int16_t yawSetpoint;
+    int16_t yaw;
+    uint8_t heightSetpoint;
+    int16_t height;
+    uint16_t mainDuty;
+    uint16_t tailDuty;
+    uint32_t overruns;
+    uint32_t dropped;
+} benchValues_t;
+
+typedef struct {
+    const char *name;
+    void (*build)(const benchValues_t *v, char *oled, char *serial);
+} benchFormat_t;
+
+static uint32_t seed = 12345;
+
+static uint32_t random32(void)
+{
+    uint32_t high;
+
+    seed = seed * 1103515245 + 12345;
+    high = seed >> 16;
+    seed = seed * 1103515245 + 12345;
+    return (high << 16) | (seed >> 16);
+}
+
+//*****************************************************************************
+// The frame as display.c builds it
+//*****************************************************************************
+static void buildFmt(const benchValues_t *v, char *oled, char *serial)
+{
+    char string[OLED_STRING_SIZE];
+    char serial_string[SERIAL_STRING_SIZE];
+    char *end = string + sizeof(string) - 1;
+    char *p;
+
+    p = fmtStr(string, end, "Yaw = ");
+    p = fmtInt(p, end, v->yawSetpoint, 3);
+    p = fmtStr(p, end, " [");
+    p = fmtInt(p, end, v->yaw, 3);
+    p = fmtStr(p, end, "] Alt = ");
+    p = fmtInt(p, end, v->heightSetpoint, 3);
+    p = fmtStr(p, end, " [");
+    p = fmtInt(p, end, v->height, 3);
+    p = fmtStr(p, end, "] Main = ");
+    p = fmtInt(p, end, v->mainDuty, 3);
+    p = fmtStr(p, end, "  pct Tail = ");
+    p = fmtInt(p, end, v->tailDuty, 3);
+    fmtStr(p, end, "  pct ");
+    strcpy(oled, string);
+
+    end = serial_string + sizeof(serial_string) - 1;
+    p = fmtStr(serial_string, end, "------------\nYaw = ");
+    p = fmtInt(p, end, v->yawSetpoint, 3);
+    p = fmtStr(p, end, " [");
+    p = fmtInt(p, end, v->yaw, 3);
+    p = fmtStr(p, end, "] deg\nAlt = ");
+    p = fmtInt(p, end, v->heightSetpoint, 3);
+    p = fmtStr(p, end, " [");
+    p = fmtInt(p, end, v->height, 3);
+    p = fmtStr(p, end, "] pct\nMain = ");
+    p = fmtInt(p, end, v->mainDuty, 3);
+    p = fmtStr(p, end, "  pct\nTail = ");
+    p = fmtInt(p, end, v->tailDuty, 3);
+    p = fmtStr(p, end, "\nOverruns = ");
+    p = fmtUint(p, end, v->overruns, 0);
+    p = fmtStr(p, end, "\nTX dropped = ");
+    p = fmtUint(p, end, v->dropped, 0);
+    fmtStr(p, end, "\n");
+    strcpy(serial, serial_string);
+}
+
+#define OLED_FORMAT "Yaw = %3d [%3d] Alt = %3d [%3d] Main = %3d  pct Tail = %3d  pct "
+#define SERIAL_FORMAT "------------\nYaw = %3d [%3d] deg\nAlt = %3d [%3d] pct\n" \
+    "Main = %3d  pct\nTail = %3d\nOverruns = %u\nTX dropped = %u\n"
+
+//*****************************************************************************
+// The same with usnprintf, into the same buffers. It reads %d and %u as a
+// long, which is the size of an int on the Tiva but not on the host.
+//*****************************************************************************
+static void buildUsnprintf(const benchValues_t *v, char *oled, char *serial)
+{
+    char string[OLED_STRING_SIZE];
+    char serial_string[SERIAL_STRING_SIZE];
+
+    usnprintf(string, sizeof(string), OLED_FORMAT, (long)v->yawSetpoint,
+              (long)v->yaw, (long)v->heightSetpoint, (long)v->height,
+              (long)v->mainDuty, (long)v->tailDuty);
+    strcpy(oled, string);
+    usnprintf(serial_string, sizeof(serial_string), SERIAL_FORMAT,
+              (long)v->yawSetpoint, (long)v->yaw, (long)v->heightSetpoint,
+              (long)v->height, (long)v->mainDuty, (long)v->tailDuty,
+              (unsigned long)v->overruns, (unsigned long)v->dropped);
+    strcpy(serial, serial_string);
+}
+
+//*****************************************************************************
+// The same with sprintf, into the buffers update_display had
+//*****************************************************************************
+static void buildSprintf(const benchValues_t *v, char *oled, char *serial)
+{
+    char string[OLD_STRING_SIZE];
+    char serial_string[OLD_STRING_SIZE];
+
+    sprintf(string, OLED_FORMAT, v->yawSetpoint, v->yaw, v->heightSetpoint,
+            v->height, v->mainDuty, v->tailDuty);
+    strcpy(oled, string);
+    sprintf(serial_string, SERIAL_FORMAT, v->yawSetpoint, v->yaw,
+            v->heightSetpoint, v->height, v->mainDuty, v->tailDuty,
+            v->overruns, v->dropped);
+    strcpy(serial, serial_string);
+}
+
+static const benchFormat_t formats[] = {
+    {"fmt",       buildFmt},
+    {"usnprintf", buildUsnprintf},
+    {"sprintf",   buildSprintf},
+};
+#define NUM_FORMATS (sizeof(formats) / sizeof(formats[0]))
+
+//*****************************************************************************
+// Readings of a flight, changing a little each frame
+//*****************************************************************************
+static void flightValues(benchValues_t *v, uint32_t i)
+{
+    v->yawSetpoint = (i / 50) * 15 % 360 - 180;
+    v->yaw = v->yawSetpoint - (int16_t)(i % 17);
+    v->heightSetpoint = (i / 80) * 10 % 100;
+    v->height = v->heightSetpoint - (int16_t)(i % 11);
+    v->mainDuty = 30 + v->heightSetpoint / 2 + i % 3;
+    v->tailDuty = 25 + v->heightSetpoint / 3 + i % 5;
+    v->overruns = i / 1000;
+    v->dropped = i / 5000;
+}
+
+//*****************************************************************************
+// Readings of any size the types hold, to try every width and truncation
+//*****************************************************************************
+static void randomValues(benchValues_t *v)
+{
+    v->yawSetpoint = (int16_t)random32();
+    v->yaw = (int16_t)random32();
+    v->heightSetpoint = (uint8_t)random32();
+    v->height = (int16_t)random32();
+    v->mainDuty = (uint16_t)random32();
+    v->tailDuty = (uint16_t)random32();
+    v->overruns = random32() >> (random32() % 32);
+    v->dropped = random32() >> (random32() % 32);
+}
+
+//*****************************************************************************
+// Fill the stack below the caller with the pattern, or find how deep into it
+// the calls since have reached. Both are called from the same place, so the
+// array lies in the same stack each time. The scan reads what earlier calls
+// left there, which the compiler takes for an uninitialised read.
+//*****************************************************************************
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+static __attribute__((noinline)) uint32_t paintStack(bool fill)
+{
+    volatile uint8_t stack[PAINT_BYTES];
+    uint32_t i;
+
+    if (fill) {
+        for (i = 0; i < PAINT_BYTES; i++) {
+            stack[i] = PAINT;
+        }
+        return 0;
+    }
+    for (i = 0; i < PAINT_BYTES && stack[i] == PAINT; i++) {
+    }
+    return PAINT_BYTES - i;
+}
+#pragma GCC diagnostic pop
+
+// The depth of a frame built the given way, less that of none being built
+static uint32_t measureStack(const benchFormat_t *format)
+{
+    char oled[OLD_STRING_SIZE];
+    char serial[OLD_STRING_SIZE];
+    benchValues_t v;
+    uint32_t baseline;
+
+    flightValues(&v, 12345);
+    paintStack(true);
+    baseline = paintStack(false);
+    paintStack(true);
+    format->build(&v, oled, serial);
+    return paintStack(false) - baseline;
+}
+
+//*****************************************************************************
+// Check the three ways write the same text, with sprintf's cut to the
+// buffers the others have
+//*****************************************************************************
+static int checkFormats(void)
+{
+    char oled[NUM_FORMATS][OLD_STRING_SIZE];
+    char serial[NUM_FORMATS][OLD_STRING_SIZE];
+    benchValues_t v;
+    uint32_t bad = 0;
+    uint32_t i, j;
+
+    for (i = 0; i < CHECK_FRAMES; i++) {
+        if (i < CHECK_FRAMES / 2) {
+            flightValues(&v, i);
+        } else {
+            randomValues(&v);
+        }
+        for (j = 0; j < NUM_FORMATS; j++) {
+            formats[j].build(&v, oled[j], serial[j]);
+            oled[j][OLED_STRING_SIZE - 1] = '\0';
+            serial[j][SERIAL_STRING_SIZE - 1] = '\0';
+        }
+        for (j = 1; j < NUM_FORMATS; j++) {
+            if (strcmp(oled[j], oled[0]) != 0
+                    || strcmp(serial[j], serial[0]) != 0) {
+                if (bad++ == 0) {
+                    fprintf(stderr, "formatbench: %s and %s differ at frame"
+                            " %u:\n%s\n%s\n%s%s", formats[0].name,
+                            formats[j].name, i, oled[0], oled[j], serial[0],
+                            serial[j]);
+                }
+            }
+        }
+    }
+    fprintf(stderr, "formatbench: %u frames %s\n", CHECK_FRAMES,
+            bad ? "differ" : "match in all three ways");
+    return bad ? 1 : 0;
+}
+
+//*****************************************************************************
+// Time building frames each way, and measure the stack
+//*****************************************************************************
+static void timeFormat(const benchFormat_t *format, uint32_t frames)
+{
+    struct timespec start, end;
+    char oled[OLD_STRING_SIZE];
+    char serial[OLD_STRING_SIZE];
+    benchValues_t v;
+    double seconds;
+    uint32_t i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < frames; i++) {
+        flightValues(&v, i);
+        format->build(&v, oled, serial);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    printf("formatbench: %-9s %9.1f %8u\n", format->name,
+           seconds * 1e9 / frames, measureStack(format));
+}
+
+static void usage(const char *name, int status)
+{
+    fprintf(status ? stderr : stdout,
+        "usage: %s [options]\n"
+        "  -c         check the three ways write the same text\n"
+        "  -n frames  frames timed each way (default %u)\n"
+        "  -h         show this list\n",
+        name, DEFAULT_FRAMES);
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t frames = DEFAULT_FRAMES;
+    int check = 0;
+    int opt;
+    uint32_t i;
+
+    while ((opt = getopt(argc, argv, "cn:h")) != -1) {
+        switch (opt) {
+            case 'c': check = 1; break;
+            case 'n': frames = strtoul(optarg, NULL, 10); break;
+            case 'h': usage(argv[0], 0);
+            default: usage(argv[0], 2);
+        }
+    }
+    if (optind != argc || frames == 0) {
+        usage(argv[0], 2);
+    }
+
+    if (check) {
+        return checkFormats();
+    }
+    printf("formatbench: OLED line and serial frame, host ns and stack bytes\n");
+    printf("formatbench: format      ns/frame    stack\n");
+    for (i = 0; i < NUM_FORMATS; i++) {
+        timeFormat(&formats[i], frames);
+    }
+    return 0;
+}
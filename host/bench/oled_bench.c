@@ -0,0 +1,200 @@
+//*****************************************************************************
+//
+// oled_bench.c - Measures what each OLED frame costs to send, as the bytes
+//                cbOledSent counts and the time the SSI3 transfer takes,
+//                with only the dirty columns sent and with the whole
+//                display, as every update used to be.
+//
+// Usage:  heli_oledbench [-c] [-n frames]
+//
+// The firmware is set up by initAll on the simulated peripherals, and
+// display_oled draws the status line of a canned flight once per OLED task
+// period. Each frame is timed from the draw until OrbitOledUpdateBusy
+// clears, at the SSI rate OrbitOledHostInit sets. -c checks that cbOledSent
+// counts the bytes the simulated display received, and that its memory
+// matches the frame buffer after every frame, and fails if not.
+//
+// The SSI transfer runs from its interrupt, so the time it takes is not
+// taken from the tasks. On the rig, the OledUpdate section of the profile
+// (profile.h) gives the cycles OrbitOledUpdate takes to start it.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "sim.h"
+#include "inits.h"
+#include "display.h"
+#include "inc/hw_ints.h"
+#include "OrbitOled.h"
+
+#define DEFAULT_FRAMES 500      // 100 s at the OLED task's rate
+#define OLED_RATE_HZ 5          // As in heli_main.c
+#define INIT_HEIGHT 2000        // ADC counts at the bottom of the range
+#define STEP_PS (SIM_PS_PER_SEC / 1000000)      // 1 us
+
+// The frame buffer and send count, from OrbitOled.c
+extern char rgbOledBmp[];
+extern uint32_t cbOledSent;
+
+typedef struct {
+    const char *name;
+    bool full;                  // Send the whole display every frame
+    uint32_t totalBytes;
+    uint32_t maxBytes;
+    uint64_t totalPs;
+    uint64_t maxPs;
+    uint32_t irqs;
+    uint32_t bad;               // Frames the display did not match
+} benchMode_t;
+
+static benchMode_t modes[] = {
+    {"full",  true},
+    {"dirty", false},
+};
+#define NUM_MODES (sizeof(modes) / sizeof(modes[0]))
+
+//*****************************************************************************
+// Whether the simulated display holds the frame buffer
+//*****************************************************************************
+static bool displayMatches(void)
+{
+    uint32_t page, col;
+
+    for (page = 0; page < cpagOledMax; page++) {
+        for (col = 0; col < ccolOledMax; col++) {
+            if (simOledByte(page, col)
+                    != (uint8_t)rgbOledBmp[page * ccolOledMax + col]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//*****************************************************************************
+// Run the SSI until the update in progress has been sent
+//*****************************************************************************
+static void waitForUpdate(void)
+{
+    while (OrbitOledUpdateBusy()) {
+        simWaitUntil(simNow() + STEP_PS);
+    }
+}
+
+//*****************************************************************************
+// Draw frame i of the canned flight, which climbs and turns in steps with
+// the measurements following, and measure what sending it takes
+//*****************************************************************************
+static void sendFrame(benchMode_t *mode, uint32_t i)
+{
+    int16_t yawSetpoint = (i / 50) * 15 % 360 - 180;
+    uint8_t heightSetpoint = (i / 80) * 10 % 100;
+    int16_t yaw = yawSetpoint - (int16_t)(15 * (50 - i % 50) / 50);
+    int16_t height = heightSetpoint - (int16_t)(10 * (80 - i % 80) / 80);
+    uint16_t mainDuty = 30 + heightSetpoint / 2 + i % 3;
+    uint16_t tailDuty = 25 + heightSetpoint / 3 + i % 5;
+    uint32_t bytes = cbOledSent;
+    uint32_t dataBytes = simOledDataBytes();
+    uint32_t irqs = simIrqCount(INT_SSI3);
+    uint64_t start = simNow();
+    uint64_t ps;
+
+    if (mode->full) {
+        OrbitOledMarkAllDirty();
+    }
+    display_oled(INIT_HEIGHT - height * 10, INIT_HEIGHT, yaw, yawSetpoint,
+                 heightSetpoint, mainDuty, tailDuty);
+    waitForUpdate();
+
+    bytes = cbOledSent - bytes;
+    ps = simNow() - start;
+    mode->totalBytes += bytes;
+    mode->totalPs += ps;
+    if (bytes > mode->maxBytes) {
+        mode->maxBytes = bytes;
+    }
+    if (ps > mode->maxPs) {
+        mode->maxPs = ps;
+    }
+    mode->irqs += simIrqCount(INT_SSI3) - irqs;
+    if (simOledDataBytes() - dataBytes != bytes || !displayMatches()) {
+        if (mode->bad++ == 0) {
+            fprintf(stderr, "oledbench: %s frame %u counted %u bytes, the"
+                    " display received %u%s\n", mode->name, i, bytes,
+                    simOledDataBytes() - dataBytes,
+                    displayMatches() ? "" : " and differs from the buffer");
+        }
+    }
+    simWaitUntil(start + SIM_PS_PER_SEC / OLED_RATE_HZ);
+}
+
+static void usage(const char *name, int status)
+{
+    fprintf(status ? stderr : stdout,
+        "usage: %s [options]\n"
+        "  -c         check the counted bytes and the display after each frame\n"
+        "  -n frames  frames drawn in each mode (default %u)\n"
+        "  -h         show this list\n",
+        name, DEFAULT_FRAMES);
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t frames = DEFAULT_FRAMES;
+    int check = 0;
+    int failed = 0;
+    int opt;
+    uint32_t i, j;
+
+    while ((opt = getopt(argc, argv, "cn:h")) != -1) {
+        switch (opt) {
+            case 'c': check = 1; break;
+            case 'n': frames = strtoul(optarg, NULL, 10); break;
+            case 'h': usage(argv[0], 0);
+            default: usage(argv[0], 2);
+        }
+    }
+    if (optind != argc || frames == 0) {
+        usage(argv[0], 2);
+    }
+
+    IntMasterDisable();
+    initAll();
+    simSetEndTime(SIM_NEVER);
+    IntMasterEnable();
+    waitForUpdate();            // The first update paints the whole display
+
+    printf("oledbench: %u frames of the status line at %u Hz\n", frames,
+           OLED_RATE_HZ);
+    printf("oledbench: update  bytes/frame   max  xfer us   max us"
+           "  irq/frame\n");
+    for (i = 0; i < NUM_MODES; i++) {
+        benchMode_t *mode = &modes[i];
+        benchMode_t first = {mode->name, mode->full};
+
+        // Start from the first frame, not the last of the mode before
+        sendFrame(&first, 0);
+        failed |= first.bad != 0;
+        for (j = 0; j < frames; j++) {
+            sendFrame(mode, j);
+        }
+        printf("oledbench: %-6s %12.1f %5u %8.1f %8.1f %10.1f\n", mode->name,
+               (double)mode->totalBytes / frames, mode->maxBytes,
+               (double)mode->totalPs / frames * 1e6 / SIM_PS_PER_SEC,
+               (double)mode->maxPs * 1e6 / SIM_PS_PER_SEC,
+               (double)mode->irqs / frames);
+        failed |= mode->bad != 0;
+    }
+    fflush(stdout);
+    if (check) {
+        fprintf(stderr, "oledbench: %u frames in each mode %s\n", frames,
+                failed ? "failed" : "sent as counted and match the buffer");
+        return failed;
+    }
+    return 0;
+}
@@ -0,0 +1,366 @@
+//*****************************************************************************
+//
+// pid_bench.c - Times the PID control law and checks its duties against a
+//               golden trace. Built twice, as heli_pidbench with the float
+//               control law and as heli_pidbench_fixed with PID_FIXED_POINT,
+//               so the two number formats are run on the same inputs.
+//
+// Usage:  heli_pidbench [-t] [-g golden] [-e tolerance] [-n ticks]
+//
+// The inputs are a canned flight: altitude and yaw setpoint steps, with the
+// measurements settling a little short of them through first order lags,
+// plus some noise, all worked out in whole numbers so every build sees the
+// same sequence.
+// Both controllers are set up as in the firmware but with gains of their
+// own, so a retune does not change the trace, and the altitude KI is set to
+// 0 and back part way through. -t writes the duties every TRACE_STEP ticks
+// to standard output, and -g compares them with a trace written by -t,
+// failing if any differs by more than the tolerance. Without either, the
+// control ticks are timed.
+//
+// The timing also runs the double precision PIDUpdate the firmware had
+// before, on the same inputs, as a common reference for the two builds. It
+// is reported in ns and in cycles of the time stamp counter, which runs at
+// the processor's nominal clock. The timing is of the host build, so it only
+// compares the kernels. On the rig, the pidUpdate section of the profile
+// (profile.h) gives the cycles a control tick takes.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC
+#endif
+#include "PID.h"
+
+#define RATE_HZ 500             // As CONTROL_RATE_HZ
+#define TRACE_TICKS 5000        // 10 s of canned flight
+#define TRACE_STEP 10           // Ticks between trace lines
+#define YAW_TICKS_PER_REV 448
+#define DEFAULT_TICKS 20000000  // Ticks timed
+
+//*****************************************************************************
+// Canned flight
+//*****************************************************************************
+typedef struct {
+    int16_t altSetpoint;        // Percent
+    int16_t yawSetpoint;        // Degrees
+    int16_t altitude;           // Percent
+    int32_t yawTicks;
+} benchInput_t;
+
+static benchInput_t inputs[TRACE_TICKS];
+
+static void makeInputs(void)
+{
+    uint32_t seed = 12345;
+    int32_t alt = 0;            // Thousandths of a percent
+    int32_t yaw = 0;            // Thousandths of a tick
+    int16_t altSetpoint = 0;
+    int16_t yawSetpoint = 0;
+    uint32_t i;
+
+    for (i = 0; i < TRACE_TICKS; i++) {
+        switch (i) {
+        case 100:  altSetpoint = 50; break;
+        case 500:  yawSetpoint = 90; break;
+        case 2000: altSetpoint = 80; break;
+        case 2500: yawSetpoint = -45; break;
+        case 3500: altSetpoint = 30; break;
+        }
+        // Each settles a little short, so the integrals have work to do
+        alt += (altSetpoint * 900 - alt) / 200;
+        yaw += (yawSetpoint * YAW_TICKS_PER_REV * 950 / 360 - yaw) / 150;
+        seed = seed * 1103515245 + 12345;
+        inputs[i].altSetpoint = altSetpoint;
+        inputs[i].yawSetpoint = yawSetpoint;
+        inputs[i].altitude = alt / 1000 + (int32_t)((seed >> 16) % 3) - 1;
+        inputs[i].yawTicks = yaw / 1000;
+    }
+}
+
+//*****************************************************************************
+// Controllers, set up as in initAll
+//*****************************************************************************
+static PIDController alt;
+static PIDController yaw;
+
+static void setUp(void)
+{
+    pidval_t dt = pidTicksToDt(1, RATE_HZ);
+
+    pidInit(&alt, PID_FROM_FLOAT(0.6f), PID_FROM_FLOAT(0.124f),
+            PID_FROM_FLOAT(0.0375f), PID_OUTPUT_MIN, PID_OUTPUT_MAX, dt);
+    pidSetAntiWindup(&alt, PID_AW_CLAMP, PID_FROM_FLOAT(8.0f));
+    pidSetDerivative(&alt, PID_D_ON_MEASUREMENT, PID_DF_BIQUAD,
+                     PID_FROM_FLOAT(10.0f));
+    pidInit(&yaw, PID_FROM_FLOAT(2.25f), PID_FROM_FLOAT(0.012f),
+            PID_FROM_FLOAT(0.675f), PID_OUTPUT_MIN, PID_OUTPUT_MAX, dt);
+    pidSetAntiWindup(&yaw, PID_AW_CONDITIONAL, PID_FROM_FLOAT(50.0f));
+    pidSetDerivative(&yaw, PID_D_ON_MEASUREMENT, PID_DF_BIQUAD,
+                     PID_FROM_FLOAT(10.0f));
+}
+
+//*****************************************************************************
+// One control tick, as controlTask and updatePID run it, with the torque
+// feedforward as a straight line
+//*****************************************************************************
+static void tick(uint32_t i)
+{
+    const benchInput_t *in = &inputs[i];
+    pidval_t yawDegrees = PID_MUL(PID_FROM_INT(in->yawTicks),
+                                  PID_FROM_FLOAT(360.0f / YAW_TICKS_PER_REV));
+
+    if (i == 1500) {
+        pidSetGains(&alt, alt.kp, 0, alt.kd);
+    } else if (i == 1750) {
+        pidSetGains(&alt, alt.kp, PID_FROM_FLOAT(0.124f), alt.kd);
+    }
+    pidUpdate(&alt, PID_FROM_INT(in->altSetpoint), PID_FROM_INT(in->altitude),
+              alt.dt);
+    yaw.feedforward = PID_MUL(alt.output, PID_FROM_FLOAT(0.795f))
+        - PID_FROM_FLOAT(1.65f);
+    pidUpdate(&yaw, PID_FROM_INT(in->yawSetpoint), yawDegrees, yaw.dt);
+}
+
+static void resetTick(void)
+{
+    pidReset(&alt);
+    pidReset(&yaw);
+}
+
+//*****************************************************************************
+// The baseline control law: PIDUpdate in double precision with its gains,
+// as PID.c had it before pidval_t. It runs both axes in one call, with no
+// anti-windup, derivative filter or feedforward, and is only timed.
+//*****************************************************************************
+typedef struct {
+    double derivative;
+    double integrated;
+    double previous;
+} baseError_t;
+
+static const float BASE_ALT_KP = 0.6;
+static const float BASE_ALT_KI = 0.0093;
+static const float BASE_ALT_KD = 0.5;
+static const float BASE_YAW_KP = 1.0;
+static const float BASE_YAW_KI = 0.0009;
+static const float BASE_YAW_KD = 2.0;
+
+static baseError_t baseAlt;
+static baseError_t baseYaw;
+static float baseControls[2];
+
+static float *baseUpdate(uint32_t deltaT, int16_t actualAlt, float actualYaw,
+                         uint8_t desiredAlt, int16_t desiredYaw,
+                         baseError_t *yawErrorState,
+                         baseError_t *altErrorState)
+{
+    double yawError = (double)desiredYaw - (double)actualYaw;
+    double altError = (double)desiredAlt - (double)actualAlt;
+    float yawControl, altControl;
+
+    yawErrorState->integrated += yawError * (double)deltaT;
+    altErrorState->integrated += altError * (double)deltaT;
+    yawErrorState->derivative = (yawError - yawErrorState->previous)
+        / (double)deltaT;
+    altErrorState->derivative = (altError - altErrorState->previous)
+        / (double)deltaT;
+
+    yawControl = yawError * BASE_YAW_KP
+        + BASE_YAW_KI * yawErrorState->integrated
+        + BASE_YAW_KD * yawErrorState->derivative;
+    yawControl = (yawControl < 5) ? 5 : (yawControl > 95) ? 95 : yawControl;
+    altControl = altError * BASE_ALT_KP
+        + BASE_ALT_KI * altErrorState->integrated
+        + BASE_ALT_KD * altErrorState->derivative;
+    altControl = (altControl < 5) ? 5 : (altControl > 95) ? 95 : altControl;
+
+    yawErrorState->previous = yawError;
+    altErrorState->previous = altError;
+    baseControls[0] = yawControl;
+    baseControls[1] = altControl;
+    return baseControls;
+}
+
+static void baseTick(uint32_t i)
+{
+    const benchInput_t *in = &inputs[i];
+
+    baseUpdate(1, in->altitude, in->yawTicks * (360.0f / YAW_TICKS_PER_REV),
+               in->altSetpoint, in->yawSetpoint, &baseYaw, &baseAlt);
+}
+
+static void resetBaseTick(void)
+{
+    memset(&baseAlt, 0, sizeof(baseAlt));
+    memset(&baseYaw, 0, sizeof(baseYaw));
+}
+
+//*****************************************************************************
+// Trace and golden comparison
+//*****************************************************************************
+static void writeTrace(void)
+{
+    uint32_t i;
+
+    setUp();
+    for (i = 0; i < TRACE_TICKS; i++) {
+        tick(i);
+        if (i % TRACE_STEP == 0) {
+            printf("%u %.4f %.4f\n", i, PID_TO_FLOAT(alt.output),
+                   PID_TO_FLOAT(yaw.output));
+        }
+    }
+}
+
+static int checkTrace(const char *path, double tolerance)
+{
+    FILE *golden = fopen(path, "r");
+    unsigned int line;
+    double altGolden, yawGolden, diff;
+    double worst = 0;
+    uint32_t worstTick = 0;
+    uint32_t over = 0;
+    uint32_t compared = 0;
+    uint32_t i;
+
+    if (!golden) {
+        perror(path);
+        return 1;
+    }
+    setUp();
+    for (i = 0; i < TRACE_TICKS; i++) {
+        tick(i);
+        if (i % TRACE_STEP != 0) {
+            continue;
+        }
+        if (fscanf(golden, "%u %lf %lf", &line, &altGolden, &yawGolden) != 3
+                || line != i) {
+            fprintf(stderr, "pidbench: %s ends or differs at tick %u\n",
+                    path, i);
+            fclose(golden);
+            return 1;
+        }
+        diff = fmax(fabs(PID_TO_FLOAT(alt.output) - altGolden),
+                    fabs(PID_TO_FLOAT(yaw.output) - yawGolden));
+        if (diff > worst) {
+            worst = diff;
+            worstTick = i;
+        }
+        over += diff > tolerance;
+        compared++;
+    }
+    fclose(golden);
+
+    fprintf(stderr, "pidbench: %u ticks compared with %s, largest difference"
+            " %.4f%% at tick %u, %u over %g%%\n",
+            compared, path, worst, worstTick, over, tolerance);
+    return over ? 1 : 0;
+}
+
+//*****************************************************************************
+// Timing
+//*****************************************************************************
+static void timeKernel(const char *name, void (*run)(uint32_t),
+                       void (*reset)(void), uint32_t ticks)
+{
+    struct timespec start, end;
+    double seconds;
+    uint64_t cycles = 0;
+    uint32_t i, j;
+
+    reset();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+#ifdef HAVE_TSC
+    cycles = __rdtsc();
+#endif
+    for (i = 0, j = 0; i < ticks; i++) {
+        run(j);
+        if (++j == TRACE_TICKS) {
+            j = 0;
+            reset();
+        }
+    }
+#ifdef HAVE_TSC
+    cycles = __rdtsc() - cycles;
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    printf("pidbench: %-21s %8.1f %10.1f\n", name, seconds * 1e9 / ticks,
+           (double)cycles / ticks);
+}
+
+static void timeTicks(uint32_t ticks)
+{
+    volatile float sink;
+
+    setUp();
+    printf("pidbench: %u ticks of both controllers\n", ticks);
+    printf("pidbench: control law              ns/tick  TSC cycles\n");
+#ifdef PID_FIXED_POINT
+    timeKernel("Q16.16 fixed point", tick, resetTick, ticks);
+#else
+    timeKernel("float", tick, resetTick, ticks);
+#endif
+    timeKernel("double, as before", baseTick, resetBaseTick, ticks);
+    sink = PID_TO_FLOAT(alt.output + yaw.output) + baseControls[0]
+        + baseControls[1];
+    (void)sink;
+}
+
+static void usage(const char *name, int status)
+{
+    fprintf(status ? stderr : stdout,
+        "usage: %s [options]\n"
+        "  -t          write the trace of the duties\n"
+        "  -g file     compare the duties with a trace written by -t\n"
+        "  -e percent  largest difference -g allows (default 0.001)\n"
+        "  -n ticks    control ticks timed (default %u)\n"
+        "  -h          show this list\n",
+        name, DEFAULT_TICKS);
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *goldenPath = NULL;
+    double tolerance = 0.001;
+    uint32_t ticks = DEFAULT_TICKS;
+    int trace = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "tg:e:n:h")) != -1) {
+        switch (opt) {
+            case 't': trace = 1; break;
+            case 'g': goldenPath = optarg; break;
+            case 'e': tolerance = atof(optarg); break;
+            case 'n': ticks = strtoul(optarg, NULL, 10); break;
+            case 'h': usage(argv[0], 0);
+            default: usage(argv[0], 2);
+        }
+    }
+    if (optind != argc || ticks == 0) {
+        usage(argv[0], 2);
+    }
+
+    makeInputs();
+    if (trace) {
+        writeTrace();
+        return 0;
+    }
+    if (goldenPath) {
+        return checkTrace(goldenPath, tolerance);
+    }
+    timeTicks(ticks);
+    return 0;
+}
@@ -0,0 +1,185 @@
+//*****************************************************************************
+//
+// sched_bench.c - Measures how late the task scheduler starts each task.
+//                 The firmware's scheduler and control tick run on the
+//                 simulated peripherals with a task table like the one in
+//                 heli_main.c, whose tasks stand in for the real ones by
+//                 taking a given time.
+//
+// Usage:  heli_schedbench [-s seconds] [-l percent]
+//
+// Each task takes between half and all of its cost, at random, every time
+// it runs. The costs are the budgets of the firmware's task table, and -l
+// scales them all.
+//
+// A task is released every period from the first control tick, and its
+// start is compared with its latest release. The mean and largest delays
+// are its jitter, and releases it was still pending for when the next came
+// are counted as missed. The scheduler is cooperative, so a long task holds
+// back the tasks of the next tick, including control, and a task released
+// while the loop overran keeps the later phase.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "sim.h"
+#include "inits.h"
+#include "control_tick.h"
+#include "scheduler.h"
+#include "torque_ff.h"
+
+#define DEFAULT_SECONDS 20
+#define CPU_HZ 20000000         // As set by initClock
+
+//*****************************************************************************
+// What each task takes, and when it started
+//*****************************************************************************
+typedef struct {
+    uint32_t costUs;
+    uint64_t release;           // Release of the latest start, in ps
+    uint32_t missed;            // Releases passed over
+    double totalLate;           // us
+    double maxLate;             // us
+} benchStats_t;
+
+static uint64_t tickStart;      // Time of control tick 0, in ps
+static uint64_t tickPs;         // Control tick period, in ps
+static uint64_t endPs;
+static uint32_t loadPercent = 100;
+static uint32_t seed = 12345;
+
+static void runBenchTask(uint32_t i);
+
+#define BENCH_TASK(n) static void benchTask##n(void) { runBenchTask(n); }
+BENCH_TASK(0) BENCH_TASK(1) BENCH_TASK(2) BENCH_TASK(3) BENCH_TASK(4)
+BENCH_TASK(5) BENCH_TASK(6) BENCH_TASK(7) BENCH_TASK(8)
+
+// Rates and budgets as in heli_main.c, highest priority first
+static task_t tasks[] = {
+//   name       function     rate              budget us
+    {"control", benchTask0, CONTROL_RATE_HZ,  200},
+    {"buttons", benchTask1, 100,              50},
+    {"state",   benchTask2, 50,               50},
+    {"ramp",    benchTask3, 4,                50},
+    {"oled",    benchTask4, 5,                3000},
+    {"serial",  benchTask5, 2,                2000},
+    {"command", benchTask6, 20,               2000},
+    {"recorder", benchTask7, 20,              2000},
+    {"ffcal",   benchTask8, FF_CAL_RATE_HZ,   2000},
+};
+#define NUM_TASKS (sizeof(tasks) / sizeof(tasks[0]))
+
+static benchStats_t stats[NUM_TASKS];
+
+//*****************************************************************************
+// Print the jitter of each task, at the end of the run
+//*****************************************************************************
+static void report(void)
+{
+    double seconds = (double)(endPs - tickStart) / SIM_PS_PER_SEC;
+    uint32_t i;
+
+    printf("schedbench: %.0f s, costs at %u%%, each run taking 50 to 100%%"
+           " of its cost\n", seconds, loadPercent);
+    printf("schedbench: task       Hz cost us    runs  missed  mean us"
+           "  max us\n");
+    for (i = 0; i < NUM_TASKS; i++) {
+        task_t *task = &tasks[i];
+        benchStats_t *s = &stats[i];
+        printf("schedbench: %-8s %4u %7u %7u %7u %8.1f %7.1f\n",
+               task->name, task->rateHz, s->costUs, task->runs,
+               s->missed,
+               task->runs ? s->totalLate / task->runs : 0, s->maxLate);
+    }
+    fflush(stdout);
+}
+
+//*****************************************************************************
+// Note how late the task started against its ideal releases, then take its
+// time. The control task ends the run.
+//*****************************************************************************
+static void runBenchTask(uint32_t i)
+{
+    benchStats_t *s = &stats[i];
+    uint64_t now = simNow();
+    uint64_t period = tickPs * tasks[i].period;
+    uint64_t release;
+    uint32_t passed;
+    double late;
+    uint32_t cycles;
+
+    if (i == 0 && now >= endPs) {
+        report();
+        exit(0);
+    }
+
+    // Every task is first due at tick 1. A start a period or more after its
+    // release is for a later one, the scheduler having passed over those
+    // in between while the task was still pending.
+    release = tasks[i].runs ? s->release + period : tickStart + tickPs;
+    passed = (uint32_t)((now - release) / period);
+    s->missed += passed;
+    release += passed * period;
+    s->release = release;
+    late = (double)(now - release) * 1e6 / SIM_PS_PER_SEC;
+    s->totalLate += late;
+    if (late > s->maxLate) {
+        s->maxLate = late;
+    }
+
+    seed = seed * 1103515245 + 12345;
+    cycles = (uint64_t)s->costUs * (CPU_HZ / 1000000)
+        * (50 + (seed >> 16) % 51) / 100;
+    SysCtlDelay(cycles / 3);
+}
+
+static void usage(const char *name, int status)
+{
+    fprintf(status ? stderr : stdout,
+        "usage: %s [options]\n"
+        "  -s seconds  simulated time to run for (default %u)\n"
+        "  -l percent  scale every task's cost (default 100)\n"
+        "  -h          show this list\n",
+        name, DEFAULT_SECONDS);
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    double seconds = DEFAULT_SECONDS;
+    int opt;
+    uint32_t i;
+
+    while ((opt = getopt(argc, argv, "s:l:h")) != -1) {
+        switch (opt) {
+            case 's': seconds = atof(optarg); break;
+            case 'l': loadPercent = strtoul(optarg, NULL, 10); break;
+            case 'h': usage(argv[0], 0);
+            default: usage(argv[0], 2);
+        }
+    }
+    if (optind != argc || seconds <= 0) {
+        usage(argv[0], 2);
+    }
+
+    for (i = 0; i < NUM_TASKS; i++) {
+        stats[i].costUs = tasks[i].budgetUs * loadPercent / 100;
+    }
+
+    // Set up as main does, with the bench's task table
+    IntMasterDisable();
+    initAll();
+    simSetEndTime(SIM_NEVER);
+    initControlTick(CONTROL_RATE_HZ);
+    tickStart = simNow();
+    tickPs = SIM_PS_PER_SEC / CONTROL_RATE_HZ;
+    endPs = tickStart + (uint64_t)(seconds * SIM_PS_PER_SEC);
+    initScheduler(tasks, NUM_TASKS);
+    IntMasterEnable();
+
+    runScheduler();
+}
@@ -0,0 +1,411 @@
+//*****************************************************************************
+//
+// yaw_bench.c - Drives the yaw decoder in yaw.c with synthetic encoder
+//               waveforms on the simulated PB0/PB1, some with glitches
+//               injected, and checks the count and error total against a
+//               4x quadrature decode worked out here. Then times the GPIO
+//               interrupt handler and finds the fastest encoder each
+//               backend can follow.
+//
+// Usage:  heli_yawbench [-c] [-n edges] [-i read,total]
+//
+// The waveforms follow a true position that wanders back and forth:
+//   clean   every edge, one pin at a time
+//   spikes  adds short pulses on one pin, which count one way and back
+//   missed  loses edges, so both pins change between interrupts
+//   noise   adds pulses on both pins at once, each two illegal transitions
+// A legal transition moves the count by one and an illegal one, with both
+// pins changed, is counted as an error and dropped. Each waveform's count
+// and errors must match that decode, and the clean and spiky ones must end
+// at the true position. -c fails if any do not.
+//
+// The handler is timed on the host, against one that only clears the
+// interrupt, so the time only compares versions of the decoder. On the rig,
+// the readYaw section of the profile (profile.h) gives its cycles.
+//
+// The edge rate sweep spins the encoder at a rising rate, with its
+// channels PHASE_ERROR out of quadrature so every other edge comes early.
+// The GPIO backend takes ISR_CYCLES to handle an edge and reads the pins
+// ISR_READ_CYCLES in, so edges that come before the read are seen together
+// and edges after it interrupt again once the handler returns. -i sets the
+// two from the profile of the rig. The QEI backend has no handler per edge;
+// it is modelled as the same decode with the pins sampled every cycle. A
+// backend follows a rate if it counts every edge with no errors.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+#include "inits.h"
+#include "inc/hw_ints.h"
+
+#define WAVE_EDGES 100000       // Edges of true motion in each waveform
+#define DEFAULT_EDGES 2000000   // Edges timed
+#define TIMING_RUNS 5           // Goes at timing them
+#define GLITCH_PER_MILLE 5      // Chance of a glitch at each edge
+#define RATE_EDGES 20000        // Edges at each rate of the sweep
+#define CPU_HZ 20000000         // As set by initClock
+#define PHASE_ERROR 0.2         // Of the time between edges
+#define ISR_READ_CYCLES 40      // Exception entry and the interrupt clear
+#define ISR_CYCLES 100          // The whole handler, entry to return
+
+//*****************************************************************************
+// A waveform, and the results of decoding it
+//*****************************************************************************
+typedef enum {WAVE_CLEAN, WAVE_SPIKES, WAVE_MISSED, WAVE_NOISE} wave_t;
+
+static const char *waveNames[] = {"clean", "spikes", "missed", "noise"};
+
+typedef struct {
+    uint32_t edges;             // Interrupting pin changes
+    uint32_t glitches;          // Glitches injected
+    int32_t truePos;            // Where the encoder really ends up
+    int32_t tableTicks;         // Count from the 4x decode
+    uint32_t tableErrors;       // Illegal transitions in the 4x decode
+    int32_t ticks;              // Count from yaw.c
+    uint32_t errors;            // Errors counted by yaw.c
+} waveResult_t;
+
+static uint32_t seed = 12345;
+
+static uint32_t randomBelow(uint32_t n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % n;
+}
+
+//*****************************************************************************
+// AB state of a position, as readYawState returns it with A in bit 1. The
+// sequence 00, 01, 11, 10 counts up.
+//*****************************************************************************
+static uint8_t stateOf(int32_t position)
+{
+    static const uint8_t gray[4] = {0, 1, 3, 2};
+    return gray[position & 3];
+}
+
+//*****************************************************************************
+// The 4x decode of a change of AB state: the number of positions moved
+// forward, from 0 to 3, where 2 is illegal and 3 is one back
+//*****************************************************************************
+static uint8_t quadStep(uint8_t from, uint8_t to)
+{
+    static const uint8_t index[4] = {0, 1, 3, 2};   // Position of each state
+    return (index[to] - index[from]) & 3;
+}
+
+//*****************************************************************************
+// Put an AB state on the pins, raising the decoder's interrupt for any
+// change
+//*****************************************************************************
+static uint8_t pinState;
+
+static void setPins(uint8_t state)
+{
+    pinState = state;
+    simGpioSetInput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1,
+                    ((state & 2) ? GPIO_PIN_0 : 0)
+                    | ((state & 1) ? GPIO_PIN_1 : 0));
+}
+
+//*****************************************************************************
+// Put an AB state on the pins and follow it with the 4x decode
+//*****************************************************************************
+static void drive(uint8_t state, waveResult_t *result)
+{
+    uint8_t step;
+
+    if (state == pinState) {
+        return;
+    }
+    step = quadStep(pinState, state);
+    if (step == 2) {
+        result->tableErrors++;
+    } else {
+        result->tableTicks += (step == 1) ? 1 : -1;
+    }
+    result->edges++;
+    setPins(state);
+}
+
+//*****************************************************************************
+// Move the true position WAVE_EDGES times, a run of steps in one direction
+// at a time, glitching the pins on the way as the waveform asks
+//*****************************************************************************
+static void runWave(wave_t wave, waveResult_t *result)
+{
+    int32_t position = 0;
+    int32_t direction = 1;
+    int32_t startTicks;
+    uint32_t startErrors;
+    uint32_t i;
+
+    // Back to position 0 before counting
+    drive(stateOf(position), result);
+    *result = (waveResult_t){0};
+    startTicks = getYawTicks();
+    startErrors = getYawErrorCount();
+
+    for (i = 0; i < WAVE_EDGES; i++) {
+        if (randomBelow(50) == 0) {
+            direction = -direction;
+        }
+        position += direction;
+        if (randomBelow(1000) >= GLITCH_PER_MILLE || wave == WAVE_CLEAN) {
+            drive(stateOf(position), result);
+            continue;
+        }
+        result->glitches++;
+        switch (wave) {
+        case WAVE_SPIKES:
+            drive(stateOf(position), result);
+            drive(pinState ^ (randomBelow(2) ? 2 : 1), result);
+            drive(stateOf(position), result);
+            break;
+        case WAVE_MISSED:
+            // This edge comes in with the next one
+            position += direction;
+            i++;
+            drive(stateOf(position), result);
+            break;
+        case WAVE_NOISE:
+            drive(stateOf(position), result);
+            drive(pinState ^ 3, result);
+            drive(stateOf(position), result);
+            break;
+        default:
+            break;
+        }
+    }
+    result->truePos = position;
+    result->ticks = getYawTicks() - startTicks;
+    result->errors = getYawErrorCount() - startErrors;
+}
+
+//*****************************************************************************
+// Decode each waveform and compare
+//*****************************************************************************
+static int checkWaves(void)
+{
+    waveResult_t r;
+    int failed = 0;
+    wave_t wave;
+
+    printf("yawbench: waveform   edges glitches  errors   ticks    true"
+           "   table\n");
+    for (wave = WAVE_CLEAN; wave <= WAVE_NOISE; wave++) {
+        int bad;
+
+        runWave(wave, &r);
+        bad = r.ticks != r.tableTicks || r.errors != r.tableErrors
+            || ((wave == WAVE_CLEAN || wave == WAVE_SPIKES)
+                && r.ticks != r.truePos);
+        printf("yawbench: %-8s %7u %8u %7u %7d %7d %7d%s\n",
+               waveNames[wave], r.edges, r.glitches, r.errors, r.ticks,
+               r.truePos, r.tableTicks, bad ? "  differs" : "");
+        failed |= bad;
+    }
+    return failed;
+}
+
+//*****************************************************************************
+// Time the decoder's handler over clean edges. Interrupts are masked and the
+// handler called directly, to leave out the simulator's dispatch, and the
+// time of a handler that only clears the interrupt is taken off. The best
+// of a few goes at each is kept.
+//*****************************************************************************
+static void clearOnly(void)
+{
+    GPIOIntClear(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+}
+
+static double timeHandler(void (*handler)(void), uint32_t edges)
+{
+    struct timespec start, end;
+    int32_t position = 0;
+    uint32_t i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < edges; i++) {
+        position += (i & 0x400) ? -1 : 1;
+        setPins(stateOf(position));
+        handler();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec))
+        / edges;
+}
+
+static void timeDecoder(uint32_t edges)
+{
+    void (*decoder)(void) = simIrqHandler(INT_GPIOB);
+    double decoderNs = 1e9;
+    double baselineNs = 1e9;
+    double t;
+    uint32_t i;
+
+    IntMasterDisable();
+    for (i = 0; i < TIMING_RUNS; i++) {
+        t = timeHandler(decoder, edges);
+        decoderNs = (t < decoderNs) ? t : decoderNs;
+        t = timeHandler(clearOnly, edges);
+        baselineNs = (t < baselineNs) ? t : baselineNs;
+    }
+    setPins(stateOf(0));
+    initYawSensor();
+    IntMasterEnable();
+    printf("yawbench: readYaw %.1f ns per edge on the host\n",
+           decoderNs - baselineNs);
+}
+
+//*****************************************************************************
+// Spin the encoder forward RATE_EDGES edges at rateHz and return whether
+// the backend counted every one with no errors. The pins are read
+// readCycles after the handler starts, and it takes busyCycles in all. With
+// gpio the reads are readYaw's, otherwise they are decoded here as the QEI
+// would.
+//*****************************************************************************
+static bool trackRate(double rateHz, double readCycles, double busyCycles,
+                      bool gpio)
+{
+    double spacing = CPU_HZ / rateHz;
+    double nextEdge = spacing * (1 - PHASE_ERROR);
+    double busyUntil = 0;
+    double start;
+    int32_t position = 0;
+    int32_t startTicks;
+    uint32_t startErrors;
+    int32_t ticks = 0;
+    uint32_t errors = 0;
+    uint8_t seen;
+    uint32_t k = 0;
+
+    setPins(stateOf(position));
+    if (gpio) {
+        initYawSensor();
+    } else {
+        GPIOIntRegister(GPIO_PORTB_BASE, clearOnly);
+    }
+    startTicks = getYawTicks();
+    startErrors = getYawErrorCount();
+    seen = pinState;
+
+    while (k < RATE_EDGES) {
+        start = (nextEdge > busyUntil) ? nextEdge : busyUntil;
+        IntMasterDisable();
+        while (k < RATE_EDGES && nextEdge <= start + readCycles) {
+            setPins(stateOf(++position));
+            k++;
+            nextEdge += spacing * ((k & 1) ? 1 + PHASE_ERROR : 1 - PHASE_ERROR);
+        }
+        if (!gpio) {
+            uint8_t step = quadStep(seen, pinState);
+            if (step == 2) {
+                errors++;
+            } else {
+                ticks += (step == 3) ? -1 : step;
+            }
+            seen = pinState;
+        }
+        IntMasterEnable();
+        busyUntil = start + busyCycles;
+    }
+    if (gpio) {
+        ticks = getYawTicks() - startTicks;
+        errors = getYawErrorCount() - startErrors;
+    }
+    return ticks == position && errors == 0;
+}
+
+//*****************************************************************************
+// Find the fastest rate each backend follows, in steps of 1, 2 and 5
+//*****************************************************************************
+static void sweepBackend(const char *name, double readCycles,
+                         double busyCycles, bool gpio)
+{
+    static const double steps[] = {1, 2, 5};
+    double decade = 1000;
+    double rate = decade;
+    double tracked = 0;
+    uint32_t i = 0;
+
+    while (rate <= CPU_HZ && trackRate(rate, readCycles, busyCycles, gpio)) {
+        tracked = rate;
+        if (++i % 3 == 0) {
+            decade *= 10;
+        }
+        rate = steps[i % 3] * decade;
+    }
+    printf("yawbench: %s follows %.0f edges/s (%.0f rev/s), not %.0f\n",
+           name, tracked, tracked / YAW_TICKS_PER_REV, rate);
+}
+
+static void sweepRates(uint32_t readCycles, uint32_t busyCycles)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "GPIO, %u cycle handler reading at %u,",
+             busyCycles, readCycles);
+    sweepBackend(name, readCycles, busyCycles, true);
+    sweepBackend("QEI, sampling every cycle,", 1, 1, false);
+    initYawSensor();
+}
+
+static void usage(const char *name, int status)
+{
+    fprintf(status ? stderr : stdout,
+        "usage: %s [options]\n"
+        "  -c             only check the decoder against the 4x decode\n"
+        "  -n edges       edges timed in each go (default %u)\n"
+        "  -i read,total  cycles into the handler the pins are read, and\n"
+        "                 its whole length (default %u,%u)\n"
+        "  -h             show this list\n",
+        name, DEFAULT_EDGES, ISR_READ_CYCLES, ISR_CYCLES);
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t edges = DEFAULT_EDGES;
+    uint32_t readCycles = ISR_READ_CYCLES;
+    uint32_t busyCycles = ISR_CYCLES;
+    int check = 0;
+    int failed;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "cn:i:h")) != -1) {
+        switch (opt) {
+            case 'c': check = 1; break;
+            case 'n': edges = strtoul(optarg, NULL, 10); break;
+            case 'i':
+                if (sscanf(optarg, "%u,%u", &readCycles, &busyCycles) != 2) {
+                    usage(argv[0], 2);
+                }
+                break;
+            case 'h': usage(argv[0], 0);
+            default: usage(argv[0], 2);
+        }
+    }
+    if (optind != argc || edges == 0 || readCycles > busyCycles) {
+        usage(argv[0], 2);
+    }
+
+    // Start the encoder at 00 before the decoder reads it
+    simGpioSetInput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1, 0);
+    initYawSensor();
+
+    failed = checkWaves();
+    if (check) {
+        fprintf(stderr, "yawbench: decoder %s the 4x decode\n",
+                failed ? "differs from" : "matches");
+        return failed;
+    }
+    timeDecoder(edges);
+    sweepRates(readCycles, busyCycles);
+    return failed;
+}
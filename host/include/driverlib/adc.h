@@ -0,0 +1,42 @@
+//*****************************************************************************
+//
+// adc.h - Host build: ADC API, implemented by the simulator. Only sample
+//         sequence 3 with a single step is modelled.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ADC_H__
+#define __DRIVERLIB_ADC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADC_TRIGGER_PROCESSOR   0x00000000
+#define ADC_TRIGGER_TIMER       0x00000005
+#define ADC_TRIGGER_PWM0        0x00000006
+#define ADC_TRIGGER_PWM1        0x00000007
+#define ADC_TRIGGER_PWM2        0x00000008
+#define ADC_TRIGGER_PWM3        0x00000009
+
+#define ADC_CTL_IE              0x00000040
+#define ADC_CTL_END             0x00000020
+#define ADC_CTL_CH0             0x00000000
+#define ADC_CTL_CH9             0x00000009
+
+extern void ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                                 uint32_t ui32Trigger, uint32_t ui32Priority);
+extern void ADCSequenceStepConfigure(uint32_t ui32Base,
+                                     uint32_t ui32SequenceNum,
+                                     uint32_t ui32Step, uint32_t ui32Config);
+extern void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCSequenceDMAEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern int32_t ADCSequenceDataGet(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                                  uint32_t *pui32Buffer);
+extern void ADCProcessorTrigger(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCIntRegister(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                           void (*pfnHandler)(void));
+extern void ADCIntEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCIntDisable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCIntClear(uint32_t ui32Base, uint32_t ui32SequenceNum);
+
+#endif // __DRIVERLIB_ADC_H__
@@ -0,0 +1,20 @@
+//*****************************************************************************
+//
+// interrupt.h - Host build: NVIC API, implemented by the simulator
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_INTERRUPT_H__
+#define __DRIVERLIB_INTERRUPT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern bool IntMasterEnable(void);
+extern bool IntMasterDisable(void);
+extern void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void));
+extern void IntEnable(uint32_t ui32Interrupt);
+extern void IntDisable(uint32_t ui32Interrupt);
+extern void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority);
+
+#endif // __DRIVERLIB_INTERRUPT_H__
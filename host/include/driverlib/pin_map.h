@@ -0,0 +1,21 @@
+//*****************************************************************************
+//
+// pin_map.h - Host build: pin mux selections. The simulator does not model
+//             the pin mux, so these only need to be distinct.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_PIN_MAP_H__
+#define __DRIVERLIB_PIN_MAP_H__
+
+#define GPIO_PA0_U0RX           0x00000001
+#define GPIO_PA1_U0TX           0x00000401
+#define GPIO_PC4_IDX1           0x00021006
+#define GPIO_PC5_M0PWM7         0x00021404
+#define GPIO_PC5_PHA1           0x00021406
+#define GPIO_PC6_PHB1           0x00021806
+#define GPIO_PD0_SSI3CLK        0x00030001
+#define GPIO_PD3_SSI3TX         0x00030C01
+#define GPIO_PF1_M1PWM5         0x00050405
+
+#endif // __DRIVERLIB_PIN_MAP_H__
@@ -0,0 +1,62 @@
+//*****************************************************************************
+//
+// pwm.h - Host build: PWM API, implemented by the simulator
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_PWM_H__
+#define __DRIVERLIB_PWM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PWM_GEN_0               0x00000040
+#define PWM_GEN_1               0x00000080
+#define PWM_GEN_2               0x000000C0
+#define PWM_GEN_3               0x00000100
+
+#define PWM_OUT_0               0x00000040
+#define PWM_OUT_1               0x00000041
+#define PWM_OUT_2               0x00000082
+#define PWM_OUT_3               0x00000083
+#define PWM_OUT_4               0x000000C4
+#define PWM_OUT_5               0x000000C5
+#define PWM_OUT_6               0x00000106
+#define PWM_OUT_7               0x00000107
+
+#define PWM_OUT_0_BIT           0x00000001
+#define PWM_OUT_1_BIT           0x00000002
+#define PWM_OUT_2_BIT           0x00000004
+#define PWM_OUT_3_BIT           0x00000008
+#define PWM_OUT_4_BIT           0x00000010
+#define PWM_OUT_5_BIT           0x00000020
+#define PWM_OUT_6_BIT           0x00000040
+#define PWM_OUT_7_BIT           0x00000080
+
+#define PWM_GEN_MODE_DOWN       0x00000000
+#define PWM_GEN_MODE_UP_DOWN    0x00000002
+#define PWM_GEN_MODE_NO_SYNC    0x00000000
+
+#define PWM_TR_CNT_ZERO         0x00000100
+#define PWM_TR_CNT_LOAD         0x00000200
+#define PWM_TR_CNT_AU           0x00000400
+#define PWM_TR_CNT_AD           0x00000800
+#define PWM_TR_CNT_BU           0x00001000
+#define PWM_TR_CNT_BD           0x00002000
+
+extern void PWMGenConfigure(uint32_t ui32Base, uint32_t ui32Gen,
+                            uint32_t ui32Config);
+extern void PWMGenPeriodSet(uint32_t ui32Base, uint32_t ui32Gen,
+                            uint32_t ui32Period);
+extern uint32_t PWMGenPeriodGet(uint32_t ui32Base, uint32_t ui32Gen);
+extern void PWMGenEnable(uint32_t ui32Base, uint32_t ui32Gen);
+extern void PWMGenDisable(uint32_t ui32Base, uint32_t ui32Gen);
+extern void PWMPulseWidthSet(uint32_t ui32Base, uint32_t ui32PWMOut,
+                             uint32_t ui32Width);
+extern uint32_t PWMPulseWidthGet(uint32_t ui32Base, uint32_t ui32PWMOut);
+extern void PWMOutputState(uint32_t ui32Base, uint32_t ui32PWMOutBits,
+                           bool bEnable);
+extern void PWMGenIntTrigEnable(uint32_t ui32Base, uint32_t ui32Gen,
+                                uint32_t ui32IntTrig);
+
+#endif // __DRIVERLIB_PWM_H__
@@ -0,0 +1,10 @@
+//*****************************************************************************
+//
+// rom.h - Host build: there is no ROM copy of driverlib on the host
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ROM_H__
+#define __DRIVERLIB_ROM_H__
+
+#endif // __DRIVERLIB_ROM_H__
@@ -0,0 +1,30 @@
+//*****************************************************************************
+//
+// rom_map.h - Host build: every MAP_ call goes to the simulated driverlib
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ROM_MAP_H__
+#define __DRIVERLIB_ROM_MAP_H__
+
+#define MAP_IntDisable                  IntDisable
+#define MAP_IntEnable                   IntEnable
+#define MAP_IntMasterDisable            IntMasterDisable
+#define MAP_IntMasterEnable             IntMasterEnable
+#define MAP_SysCtlPeripheralEnable      SysCtlPeripheralEnable
+#define MAP_SysCtlPeripheralPresent     SysCtlPeripheralPresent
+#define MAP_UARTCharGet                 UARTCharGet
+#define MAP_UARTCharGetNonBlocking      UARTCharGetNonBlocking
+#define MAP_UARTCharPut                 UARTCharPut
+#define MAP_UARTCharPutNonBlocking      UARTCharPutNonBlocking
+#define MAP_UARTCharsAvail              UARTCharsAvail
+#define MAP_UARTConfigSetExpClk         UARTConfigSetExpClk
+#define MAP_UARTEnable                  UARTEnable
+#define MAP_UARTFIFOLevelSet            UARTFIFOLevelSet
+#define MAP_UARTIntClear                UARTIntClear
+#define MAP_UARTIntDisable              UARTIntDisable
+#define MAP_UARTIntEnable               UARTIntEnable
+#define MAP_UARTIntStatus               UARTIntStatus
+#define MAP_UARTSpaceAvail              UARTSpaceAvail
+
+#endif // __DRIVERLIB_ROM_MAP_H__
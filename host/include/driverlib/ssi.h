@@ -0,0 +1,36 @@
+//*****************************************************************************
+//
+// ssi.h - Host build: SSI API, implemented by the simulator
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_SSI_H__
+#define __DRIVERLIB_SSI_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SSI_TXFF                0x00000008
+#define SSI_RXFF                0x00000004
+#define SSI_RXTO                0x00000002
+#define SSI_RXOR                0x00000001
+
+#define SSI_FRF_MOTO_MODE_0     0x00000000
+#define SSI_MODE_MASTER         0x00000000
+#define SSI_CLOCK_SYSTEM        0x00000000
+
+extern void SSIConfigSetExpClk(uint32_t ui32Base, uint32_t ui32SSIClk,
+                               uint32_t ui32Protocol, uint32_t ui32Mode,
+                               uint32_t ui32BitRate, uint32_t ui32DataWidth);
+extern void SSIClockSourceSet(uint32_t ui32Base, uint32_t ui32Source);
+extern void SSIEnable(uint32_t ui32Base);
+extern void SSIDisable(uint32_t ui32Base);
+extern void SSIDataPut(uint32_t ui32Base, uint32_t ui32Data);
+extern void SSIDataGet(uint32_t ui32Base, uint32_t *pui32Data);
+extern int32_t SSIDataGetNonBlocking(uint32_t ui32Base, uint32_t *pui32Data);
+extern bool SSIBusy(uint32_t ui32Base);
+extern void SSIIntRegister(uint32_t ui32Base, void (*pfnHandler)(void));
+extern void SSIIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags);
+extern void SSIIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags);
+
+#endif // __DRIVERLIB_SSI_H__
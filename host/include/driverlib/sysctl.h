@@ -0,0 +1,49 @@
+//*****************************************************************************
+//
+// sysctl.h - Host build: system control API, implemented by the simulator
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYSCTL_PERIPH_ADC0      0xf0003800
+#define SYSCTL_PERIPH_GPIOA     0xf0000800
+#define SYSCTL_PERIPH_GPIOB     0xf0000801
+#define SYSCTL_PERIPH_GPIOC     0xf0000802
+#define SYSCTL_PERIPH_GPIOD     0xf0000803
+#define SYSCTL_PERIPH_GPIOE     0xf0000804
+#define SYSCTL_PERIPH_GPIOF     0xf0000805
+#define SYSCTL_PERIPH_PWM0      0xf0004000
+#define SYSCTL_PERIPH_PWM1      0xf0004001
+#define SYSCTL_PERIPH_QEI1      0xf0004401
+#define SYSCTL_PERIPH_SSI3      0xf0001c03
+#define SYSCTL_PERIPH_TIMER0    0xf0000400
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+#define SYSCTL_PERIPH_UART0     0xf0001800
+#define SYSCTL_PERIPH_UART1     0xf0001801
+#define SYSCTL_PERIPH_UART2     0xf0001802
+#define SYSCTL_PERIPH_UDMA      0xf0000c00
+
+#define SYSCTL_SYSDIV_1         0x07800000
+#define SYSCTL_SYSDIV_10        0x04C00000
+#define SYSCTL_USE_PLL          0x00000000
+#define SYSCTL_USE_OSC          0x00003800
+#define SYSCTL_OSC_MAIN         0x00000000
+#define SYSCTL_XTAL_16MHZ       0x00000540
+#define SYSCTL_PWMDIV_1         0x00000000
+#define SYSCTL_PWMDIV_2         0x00100000
+
+extern void SysCtlClockSet(uint32_t ui32Config);
+extern uint32_t SysCtlClockGet(void);
+extern void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralPresent(uint32_t ui32Peripheral);
+extern void SysCtlPWMClockSet(uint32_t ui32Config);
+extern void SysCtlDelay(uint32_t ui32Count);
+extern void SysCtlSleep(void);
+
+#endif // __DRIVERLIB_SYSCTL_H__
@@ -0,0 +1,20 @@
+//*****************************************************************************
+//
+// systick.h - Host build: SysTick API, implemented by the simulator
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_SYSTICK_H__
+#define __DRIVERLIB_SYSTICK_H__
+
+#include <stdint.h>
+
+extern void SysTickEnable(void);
+extern void SysTickDisable(void);
+extern void SysTickIntRegister(void (*pfnHandler)(void));
+extern void SysTickIntEnable(void);
+extern void SysTickIntDisable(void);
+extern void SysTickPeriodSet(uint32_t ui32Period);
+extern uint32_t SysTickValueGet(void);
+
+#endif // __DRIVERLIB_SYSTICK_H__
@@ -0,0 +1,46 @@
+//*****************************************************************************
+//
+// udma.h - Host build: uDMA API. The simulator does not move data with the
+//          uDMA, so ADC_USE_DMA builds link but receive no samples.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_UDMA_H__
+#define __DRIVERLIB_UDMA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UDMA_PRI_SELECT         0x00000000
+#define UDMA_ALT_SELECT         0x00000020
+
+#define UDMA_ATTR_USEBURST      0x00000001
+#define UDMA_ATTR_ALTSELECT     0x00000002
+#define UDMA_ATTR_HIGH_PRIORITY 0x00000004
+#define UDMA_ATTR_REQMASK       0x00000008
+
+#define UDMA_MODE_STOP          0x00000000
+#define UDMA_MODE_PINGPONG      0x00000003
+
+#define UDMA_SIZE_16            0x11000000
+#define UDMA_SRC_INC_NONE       0x0c000000
+#define UDMA_DST_INC_16         0x40000000
+#define UDMA_ARB_1              0x00000000
+
+#define UDMA_CHANNEL_ADC3       17
+#define UDMA_CH17_ADC0_3        0x00000011
+
+extern void uDMAEnable(void);
+extern void uDMAControlBaseSet(void *pControlTable);
+extern void uDMAChannelAssign(uint32_t ui32Mapping);
+extern void uDMAChannelAttributeDisable(uint32_t ui32ChannelNum,
+                                        uint32_t ui32Attr);
+extern void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex,
+                                  uint32_t ui32Control);
+extern void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex,
+                                   uint32_t ui32Mode, void *pvSrcAddr,
+                                   void *pvDstAddr, uint32_t ui32TransferSize);
+extern void uDMAChannelEnable(uint32_t ui32ChannelNum);
+extern uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex);
+
+#endif // __DRIVERLIB_UDMA_H__
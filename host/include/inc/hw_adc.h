@@ -0,0 +1,12 @@
+//*****************************************************************************
+//
+// hw_adc.h - Host build: ADC register offsets
+//
+//*****************************************************************************
+
+#ifndef __HW_ADC_H__
+#define __HW_ADC_H__
+
+#define ADC_O_SSFIFO3           0x000000A8
+
+#endif // __HW_ADC_H__
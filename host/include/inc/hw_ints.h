@@ -0,0 +1,28 @@
+//*****************************************************************************
+//
+// hw_ints.h - Host build: interrupt numbers of the TM4C123GH6PM
+//
+//*****************************************************************************
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define FAULT_SYSTICK           15
+#define INT_GPIOA               16
+#define INT_GPIOB               17
+#define INT_GPIOC               18
+#define INT_GPIOD               19
+#define INT_GPIOE               20
+#define INT_UART0               21
+#define INT_UART1               22
+#define INT_QEI0                29
+#define INT_ADC0SS3             33
+#define INT_TIMER0A             35
+#define INT_TIMER1A             37
+#define INT_GPIOF               46
+#define INT_UART2               49
+#define INT_QEI1                54
+#define INT_SSI3                74
+#define NUM_INTERRUPTS          155
+
+#endif // __HW_INTS_H__
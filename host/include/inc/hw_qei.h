@@ -0,0 +1,13 @@
+//*****************************************************************************
+//
+// hw_qei.h - Host build: QEI register offsets and bits
+//
+//*****************************************************************************
+
+#ifndef __HW_QEI_H__
+#define __HW_QEI_H__
+
+#define QEI_O_CTL               0x00000000
+#define QEI_CTL_INVI            0x00000400
+
+#endif // __HW_QEI_H__
@@ -0,0 +1,13 @@
+//*****************************************************************************
+//
+// hw_ssi.h - Host build: SSI register offsets and bits
+//
+//*****************************************************************************
+
+#ifndef __HW_SSI_H__
+#define __HW_SSI_H__
+
+#define SSI_O_CR1               0x00000004
+#define SSI_CR1_EOT             0x00000010
+
+#endif // __HW_SSI_H__
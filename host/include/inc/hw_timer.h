@@ -0,0 +1,12 @@
+//*****************************************************************************
+//
+// hw_timer.h - Host build: timer register offsets
+//
+//*****************************************************************************
+
+#ifndef __HW_TIMER_H__
+#define __HW_TIMER_H__
+
+#define TIMER_O_TAV             0x00000050
+
+#endif // __HW_TIMER_H__
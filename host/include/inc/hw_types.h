@@ -0,0 +1,17 @@
+//*****************************************************************************
+//
+// hw_types.h - Host build: register access macros. Registers are backed by
+//              simulator storage rather than real memory-mapped hardware.
+//
+//*****************************************************************************
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+
+extern volatile uint32_t *simRegister(uint32_t addr);
+
+#define HWREG(x)                (*simRegister(x))
+
+#endif // __HW_TYPES_H__
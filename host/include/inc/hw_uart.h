@@ -0,0 +1,10 @@
+//*****************************************************************************
+//
+// hw_uart.h - Host build: UART register definitions (none are used directly)
+//
+//*****************************************************************************
+
+#ifndef __HW_UART_H__
+#define __HW_UART_H__
+
+#endif // __HW_UART_H__
@@ -0,0 +1,18 @@
+//*****************************************************************************
+//
+// tm4c123gh6pm.h - Host build: the direct register names used by the
+//                  firmware, routed to simulator storage
+//
+//*****************************************************************************
+
+#ifndef __TM4C123GH6PM_H__
+#define __TM4C123GH6PM_H__
+
+#include "inc/hw_types.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_gpio.h"
+
+#define GPIO_PORTF_LOCK_R       HWREG(GPIO_PORTF_BASE + GPIO_O_LOCK)
+#define GPIO_PORTF_CR_R         HWREG(GPIO_PORTF_BASE + GPIO_O_CR)
+
+#endif // __TM4C123GH6PM_H__
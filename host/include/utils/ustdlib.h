@@ -0,0 +1,7 @@
+//*****************************************************************************
+//
+// ustdlib.h - Host build: the firmware carries its own copy of ustdlib
+//
+//*****************************************************************************
+
+#include "../../../Heli_Assignment/ustdlib.h"
@@ -0,0 +1,426 @@
+//*****************************************************************************
+//
+// replay.c - Replays a sensor log from the rig through the firmware on the
+//            simulated microcontroller. The firmware is built with
+//            SENSOR_LOG and SLOG_REPLAY, so its logging hooks call in here
+//            in place of sensor_log.c.
+//
+//            The log is read from HELI_REPLAY. Before each task runs, the
+//            events logged up to that task are fed back in order: ADC
+//            samples through the ADC interrupt, encoder and reference edges
+//            through the GPIO interrupts, and switch and button changes as
+//            pin levels. The duties the control law sets are compared with
+//            the logged ones, or with those of another build written to
+//            HELI_REPLAY_DUTIES and read back from HELI_REPLAY_REF.
+//
+//            Each interrupt is replayed between tasks, where on the rig it
+//            may have come in part way through one. Events are only ever
+//            moved later, never reordered.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "buttons4.h"
+#include "sensor_log.h"
+#include "telemetry_frame.h"
+
+#define FRAME_MAX (2 + SLOG_PAYLOAD_SIZE + 2)
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+static uint8_t *events;         // Logged events, in order
+static size_t numBytes;
+static size_t next;             // Next event to replay
+static bool ended;
+
+// Gaps in the log, after which the replay cannot be exact
+static uint32_t badFrames;
+static uint32_t lostFrames;
+static uint32_t lostEvents;
+static size_t firstGap = SIZE_MAX;
+
+static uint32_t adcSamples;
+static uint32_t yawEdges;
+static uint32_t taskRuns;
+static uint32_t taskDiffs;      // Tasks run out of the logged order
+static uint32_t tickDiffs;      // Ticks that came at a different time
+
+// Duty comparison
+static FILE *dutiesOut;
+static uint8_t (*refDuties)[2]; // From HELI_REPLAY_REF, else from the log
+static uint32_t numRefDuties;
+static uint32_t controlRuns;
+static uint8_t loggedDuties[2]; // Only logged when they change
+static uint32_t compared;
+static uint32_t differing;
+static uint32_t maxMainDiff;
+static uint32_t maxTailDiff;
+static uint32_t firstDiff;
+static double firstDiffTime;
+static uint8_t firstDiffDuties[4];
+
+//*****************************************************************************
+// Read the log, keeping the events of every frame that passes its CRC
+//*****************************************************************************
+static void appendEvents(const uint8_t *data, size_t len)
+{
+    events = realloc(events, numBytes + len);
+    if (!events) {
+        fprintf(stderr, "replay: out of memory\n");
+        exit(1);
+    }
+    memcpy(&events[numBytes], data, len);
+    numBytes += len;
+}
+
+static void markGap(void)
+{
+    if (firstGap == SIZE_MAX) {
+        firstGap = numBytes;
+    }
+}
+
+static void readFrame(const uint8_t *in, size_t len)
+{
+    static bool started;
+    static uint16_t expected;
+    uint8_t raw[FRAME_MAX];
+    int32_t rawLen = telemCobsDecode(in, len, raw, FRAME_MAX);
+    uint16_t sequence;
+    uint32_t i;
+
+    if (rawLen < 4 || telemCrc16(raw, rawLen - 2)
+            != (raw[rawLen - 2] | (raw[rawLen - 1] << 8))) {
+        badFrames++;
+        markGap();
+        return;
+    }
+    sequence = raw[0] | (raw[1] << 8);
+    if (started && sequence != expected) {
+        lostFrames += (uint16_t)(sequence - expected);
+        markGap();
+    }
+    started = true;
+    expected = sequence + 1;
+
+    // Check the events are whole before keeping them
+    for (i = 2; i < rawLen - 2; i += slogEventSize(raw[i])) {
+        if (slogEventSize(raw[i]) == 0) {
+            badFrames++;
+            markGap();
+            return;
+        }
+    }
+    appendEvents(&raw[2], rawLen - 4);
+}
+
+static void readLog(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    uint8_t frame[2 * FRAME_MAX];
+    size_t len = 0;
+    int c;
+
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    while ((c = getc(file)) != EOF) {
+        if (c == 0) {
+            if (len) {
+                readFrame(frame, len);
+            }
+            len = 0;
+        } else if (len < sizeof(frame)) {
+            frame[len++] = c;
+        }
+    }
+    fclose(file);
+    if (numBytes < slogEventSize(SLOG_START) || events[0] != SLOG_START) {
+        fprintf(stderr, "replay: %s does not start at power up\n", path);
+        exit(1);
+    }
+    if (events[1] != SLOG_VERSION) {
+        fprintf(stderr, "replay: %s is log version %u, not %u\n", path,
+                events[1], SLOG_VERSION);
+        exit(1);
+    }
+}
+
+//*****************************************************************************
+// Read the duties of another build, as written to HELI_REPLAY_DUTIES
+//*****************************************************************************
+static void readRefDuties(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char line[64];
+    unsigned run, mainDuty, tailDuty;
+
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%u,%u,%u", &run, &mainDuty, &tailDuty) != 3) {
+            continue;
+        }
+        refDuties = realloc(refDuties, (numRefDuties + 1) * sizeof(*refDuties));
+        if (!refDuties) {
+            fprintf(stderr, "replay: out of memory\n");
+            exit(1);
+        }
+        refDuties[numRefDuties][0] = mainDuty;
+        refDuties[numRefDuties][1] = tailDuty;
+        numRefDuties++;
+    }
+    fclose(file);
+}
+
+//*****************************************************************************
+// Drive the inputs
+//*****************************************************************************
+static void setInputs(uint8_t inputs)
+{
+    simGpioSetInput(GPIO_PORTA_BASE, GPIO_PIN_7,
+                    (inputs & SLOG_IN_SWITCH) ? GPIO_PIN_7 : 0);
+    simGpioSetInput(UP_BUT_PORT_BASE, UP_BUT_PIN,
+                    (inputs & SLOG_IN_UP) ? UP_BUT_PIN : 0);
+    simGpioSetInput(DOWN_BUT_PORT_BASE, DOWN_BUT_PIN,
+                    (inputs & SLOG_IN_DOWN) ? DOWN_BUT_PIN : 0);
+    simGpioSetInput(LEFT_BUT_PORT_BASE, LEFT_BUT_PIN,
+                    (inputs & SLOG_IN_LEFT) ? LEFT_BUT_PIN : 0);
+    simGpioSetInput(RIGHT_BUT_PORT_BASE, RIGHT_BUT_PIN,
+                    (inputs & SLOG_IN_RIGHT) ? RIGHT_BUT_PIN : 0);
+}
+
+static void setEncoder(uint8_t state)
+{
+    simGpioSetInput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1,
+                    ((state & 2) ? GPIO_PIN_0 : 0) | ((state & 1) ? GPIO_PIN_1 : 0));
+}
+
+//*****************************************************************************
+// Summary, printed when the log runs out or the run ends
+//*****************************************************************************
+static void replaySummary(void)
+{
+    fprintf(stderr, "replay: %zu of %zu event bytes, %u ADC samples, "
+            "%u encoder edges, %u task runs\n", next, numBytes, adcSamples,
+            yawEdges, taskRuns);
+    if (badFrames || lostFrames || lostEvents) {
+        fprintf(stderr, "replay: log has %u bad frames, %u lost frames and "
+                "%u lost events, not exact after event byte %zu\n",
+                badFrames, lostFrames, lostEvents, firstGap);
+    }
+    if (taskDiffs || tickDiffs) {
+        fprintf(stderr, "replay: %u tasks out of the logged order, %u "
+                "ticks at a different time\n", taskDiffs, tickDiffs);
+    }
+    fprintf(stderr, "replay: duties %u compared, %u differ, max difference "
+            "main %u tail %u\n", compared, differing, maxMainDiff, maxTailDiff);
+    if (differing) {
+        fprintf(stderr, "replay: first difference at control run %u, %.3f s: "
+                "main %u tail %u, was %u and %u\n", firstDiff, firstDiffTime,
+                firstDiffDuties[0], firstDiffDuties[1], firstDiffDuties[2],
+                firstDiffDuties[3]);
+    } else if (compared) {
+        fprintf(stderr, "replay: duties match exactly\n");
+    }
+    if (dutiesOut) {
+        fclose(dutiesOut);
+    }
+}
+
+//*****************************************************************************
+// Feed back the events up to the next tick or task, ending the run at the
+// end of the log
+//*****************************************************************************
+static void replayEvents(void)
+{
+    uint8_t type;
+
+    while (next < numBytes && !ended) {
+        type = events[next];
+        switch (type) {
+            case SLOG_TICK:
+            case SLOG_TASK:
+                return;
+            case SLOG_START:
+                ended = true;   // The board was reset
+                continue;
+            case SLOG_ADC:
+                adcSamples++;
+                simAdcInject(events[next + 1] | (events[next + 2] << 8));
+                break;
+            case SLOG_YAW:
+                yawEdges++;
+                setEncoder(events[next + 1]);
+                break;
+            case SLOG_YAW_REF:
+                simGpioSetInput(GPIO_PORTC_BASE, GPIO_PIN_4, 0);
+                simGpioSetInput(GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_PIN_4);
+                break;
+            case SLOG_INPUTS:
+                setInputs(events[next + 1]);
+                break;
+            case SLOG_LOST:
+                lostEvents += events[next + 1] | (events[next + 2] << 8);
+                if (firstGap == SIZE_MAX) {
+                    firstGap = next;
+                }
+                break;
+        }
+        next += slogEventSize(type);
+    }
+    simFinish();
+}
+
+//*****************************************************************************
+// Hooks called by the firmware
+//*****************************************************************************
+void slogInit(void)
+{
+    if (!getenv("HELI_SIM_SECONDS")) {
+        simSetEndTime(SIM_NEVER);
+    }
+    next = slogEventSize(SLOG_START);
+}
+
+void slogAdc(uint16_t value)
+{
+}
+
+void slogYaw(uint8_t state)
+{
+}
+
+void slogYawRef(void)
+{
+}
+
+void slogTick(uint32_t elapsed)
+{
+    uint32_t logged = 1;
+
+    replayEvents();
+    if (events[next] == SLOG_TICK) {
+        logged = events[next + 1];
+        next += slogEventSize(SLOG_TICK);
+    }
+    if (logged != (elapsed > UINT8_MAX ? UINT8_MAX : elapsed)) {
+        tickDiffs++;
+    }
+}
+
+// A task run out of order skips the log ahead to its next run
+void slogTask(uint8_t index)
+{
+    bool skipped = false;
+
+    taskRuns++;
+    replayEvents();
+    while (events[next] != SLOG_TASK || events[next + 1] != index) {
+        skipped = true;
+        next += slogEventSize(events[next]);
+        replayEvents();
+    }
+    next += slogEventSize(SLOG_TASK);
+    if (skipped) {
+        taskDiffs++;
+    }
+}
+
+// Logged duties follow the control task's run, before the next task. With
+// none logged, the duties were left as they were.
+void slogDuty(uint16_t mainDuty, uint16_t tailDuty)
+{
+    uint8_t was[2] = {0, 0};
+    bool found = false;
+    uint32_t mainDiff;
+    uint32_t tailDiff;
+    size_t i;
+
+    if (refDuties) {
+        if (controlRuns < numRefDuties) {
+            memcpy(was, refDuties[controlRuns], sizeof(was));
+            found = true;
+        }
+    } else {
+        for (i = next; i < numBytes && events[i] != SLOG_TASK;
+                i += slogEventSize(events[i])) {
+            if (events[i] == SLOG_DUTY) {
+                loggedDuties[0] = events[i + 1];
+                loggedDuties[1] = events[i + 2];
+                break;
+            }
+        }
+        memcpy(was, loggedDuties, sizeof(was));
+        found = true;
+    }
+    if (dutiesOut) {
+        fprintf(dutiesOut, "%u,%u,%u\n", controlRuns, mainDuty, tailDuty);
+    }
+    controlRuns++;
+    if (!found) {
+        return;
+    }
+
+    mainDiff = abs((int32_t)mainDuty - was[0]);
+    tailDiff = abs((int32_t)tailDuty - was[1]);
+    if ((mainDiff || tailDiff) && !differing++) {
+        firstDiff = controlRuns - 1;
+        firstDiffTime = simSeconds();
+        firstDiffDuties[0] = mainDuty;
+        firstDiffDuties[1] = tailDuty;
+        firstDiffDuties[2] = was[0];
+        firstDiffDuties[3] = was[1];
+    }
+    maxMainDiff = mainDiff > maxMainDiff ? mainDiff : maxMainDiff;
+    maxTailDiff = tailDiff > maxTailDiff ? tailDiff : maxTailDiff;
+    compared++;
+}
+
+void slogService(void)
+{
+}
+
+//*****************************************************************************
+// Read the log and set the inputs to their levels at power up
+//*****************************************************************************
+static __attribute__((constructor)) void replayInit(void)
+{
+    const char *path = getenv("HELI_REPLAY");
+    const char *refPath = getenv("HELI_REPLAY_REF");
+    const char *dutiesPath = getenv("HELI_REPLAY_DUTIES");
+
+    if (!path) {
+        fprintf(stderr, "replay: set HELI_REPLAY to a sensor log\n");
+        exit(1);
+    }
+    readLog(path);
+    if (refPath) {
+        readRefDuties(refPath);
+    }
+    if (dutiesPath) {
+        dutiesOut = fopen(dutiesPath, "w");
+        if (!dutiesOut) {
+            perror(dutiesPath);
+            exit(1);
+        }
+        fprintf(dutiesOut, "run,main,tail\n");
+    }
+    simAdcInjectOnly();
+    setInputs(events[2]);
+    setEncoder(events[3]);
+    simGpioSetInput(GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_PIN_4);
+    atexit(replaySummary);
+}
@@ -0,0 +1,700 @@
+//*****************************************************************************
+//
+// rig.c - Physics model of the heli rig. The main rotor lifts the heli
+//         against a weight that grows with height, and both rotors spin up
+//         with a lag. The tail rotor turns the heli one way and the main
+//         rotor's reaction torque the other. Height is read through the
+//         ADC with noise, and yaw through the 448 tick per revolution
+//         quadrature encoder and the reference slot. The main rotor's
+//         switching can add noise to the ADC too, more while its pulse is
+//         on and most just after an edge. It is off by default, so flights
+//         compare with those flown before it was modelled.
+//
+//         The firmware runs unchanged against it, so the real pidUpdate,
+//         determineState and PWM code close the loop. A script switches
+//         the heli on and presses the buttons, and each setpoint step is
+//         measured for rise time, overshoot and settling time. The run
+//         ends with a line of costs, and HELI_RIG_GAINS sets the PID gains
+//         the firmware flies with, for the tuning tool in host/tune.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include <math.h>
+#include <string.h>
+#include "rig.h"
+#include "sim.h"
+#include "inits.h"
+#include "torque_ff.h"
+#include "gain_schedule.h"
+
+#define FLYING 2                // enum State in heli_main.c
+#define LANDING 3
+#define DOWN_HEIGHT 1.0f        // Landed below this height, percent
+#define EDGE_GAP_PS 20000000    // 20 us between encoder edges
+#define PRESS_TIME 0.06f        // Button hold, longer than the debounce
+#define PRESS_REPEAT 0.2f       // Time between repeated presses
+#define TRACE_HZ 100
+#define SETTLE_BAND 0.05f       // Of the step size
+#define STEP_MERGE 0.5f         // s
+#define MAX_EVENTS 128
+#define NOISE_TAU 0.05f         // s, duty changes quicker than this are noise
+#define EDGE_TAU 20e-6          // s, ringing after a switching edge
+#define DUTY_MIN 5.01f          // Duties at the PID output limits, percent
+#define DUTY_MAX 94.99f
+#define DEFAULT_SCRIPT \
+    "0.5:on 10:up*5 25:left*6 35:down*3 50:right*6 60:off"
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+rigParams_t rigParams = {
+    .hoverDuty = 35,
+    .hoverSlope = 10,
+    .altGain = 0.08f,
+    .altDamping = 2.5f,
+    .mainLag = 0.3f,
+    .tailLag = 0.15f,
+    .tailGain = 6,
+    .torqueGain = 4.5f,
+    .yawDamping = 2,
+    .yawRef = 10,
+    .groundCounts = 2500,
+    .swingCounts = 1000,        // 0.8 V, MAX_VOLTAGE_SWING in display.c
+    .noiseCounts = 4,
+    .pulseNoise = 0,
+    .edgeNoise = 0,
+};
+
+static const struct {
+    const char *name;
+    float *value;
+} paramNames[] = {
+    {"hover", &rigParams.hoverDuty},     {"hover_slope", &rigParams.hoverSlope},
+    {"alt_gain", &rigParams.altGain},    {"alt_damping", &rigParams.altDamping},
+    {"main_lag", &rigParams.mainLag},    {"tail_lag", &rigParams.tailLag},
+    {"tail_gain", &rigParams.tailGain},  {"torque_gain", &rigParams.torqueGain},
+    {"yaw_damping", &rigParams.yawDamping}, {"yaw_ref", &rigParams.yawRef},
+    {"ground", &rigParams.groundCounts}, {"swing", &rigParams.swingCounts},
+    {"noise", &rigParams.noiseCounts},
+    {"pulse_noise", &rigParams.pulseNoise},
+    {"edge_noise", &rigParams.edgeNoise},
+};
+
+static const struct {
+    const char *name;
+    pidval_t *gain;
+} gainNames[] = {
+    {"alt_kp", &ALT_KP}, {"alt_ki", &ALT_KI}, {"alt_kd", &ALT_KD},
+    {"yaw_kp", &YAW_KP}, {"yaw_ki", &YAW_KI}, {"yaw_kd", &YAW_KD},
+    {"alt_kb", &ALT_KB}, {"yaw_kb", &YAW_KB},
+    {"alt_dfc", &ALT_D_CUTOFF}, {"yaw_dfc", &YAW_D_CUTOFF},
+    {"ff_slope", &FF_SLOPE}, {"ff_offset", &FF_OFFSET},
+};
+
+// Anti-windup and derivative of each axis, set as a gain by the enum value,
+// and the torque feedforward and gain scheduling, 0 for off
+static const struct {
+    const char *name;
+    uint8_t *mode;
+    uint8_t numModes;
+} modeNames[] = {
+    {"alt_aw", &ALT_ANTI_WINDUP, PID_AW_NUM_MODES},
+    {"yaw_aw", &YAW_ANTI_WINDUP, PID_AW_NUM_MODES},
+    {"alt_dsrc", &ALT_D_SOURCE, PID_D_NUM_SOURCES},
+    {"yaw_dsrc", &YAW_D_SOURCE, PID_D_NUM_SOURCES},
+    {"alt_df", &ALT_D_FILTER, PID_DF_NUM_FILTERS},
+    {"yaw_df", &YAW_D_FILTER, PID_DF_NUM_FILTERS},
+    {"ff", &TORQUE_FF, 2},
+    {"gs", &GAIN_SCHEDULE, 2},
+    {"adc_phase", &PWM_ADC_PHASE, 100},
+};
+
+// Firmware state the measurements follow
+extern uint8_t state;
+extern uint8_t height_setpoint;
+
+// Rig state
+static float height;            // 0 at the bottom to 1 at the top
+static float climbRate;         // /s
+static float yaw;               // deg from the start
+static float yawRate;           // deg/s
+static float mainSpeed;         // Rotor speeds, as the duty they settle at
+static float tailSpeed;
+static int32_t encoderTicks;    // Ticks the encoder has signalled
+static int32_t refTick;
+static uint64_t rngState = 1;
+
+// Script of switch and button changes
+typedef struct {
+    float time;
+    uint32_t port;
+    uint8_t pin;
+    uint8_t level;
+} rigEvent_t;
+
+static rigEvent_t events[MAX_EVENTS];
+static uint32_t numEvents;
+static uint32_t nextEventIndex;
+
+static uint64_t nextStep;
+static uint64_t nextEdge = SIM_NEVER;
+static uint64_t stepPs;
+
+// Step measurement
+typedef struct {
+    rigStep_t step;
+    bool active;
+    float setpoint;
+    float start;                // Actual value when the step started
+    float changed;              // Time of the last setpoint change
+    float t10;
+    float peak;                 // Furthest past the target, in steps
+    float lastOutside;          // Last time outside the settling band
+} rigTracker_t;
+
+static rigTracker_t altTracker = {{'a'}};
+static rigTracker_t yawTracker = {{'y'}};
+static rigStep_t steps[RIG_MAX_STEPS];
+static uint32_t numSteps;
+
+// Costs over the flight, for comparing gains
+static float altIae;            // Integral of the absolute error, % s
+static float yawIae;            // deg s
+static float dutyChange;        // Total of the duty changes, %
+static float dutyNoise;         // Integral of the squared duty noise, %^2 s
+static float saturatedTime;     // Time either duty is at a limit
+static float mainTrend;         // Duties smoothed over NOISE_TAU, which the
+static float tailTrend;         // noise is measured from
+static float flyingTime;
+static float lastMain;
+static float lastTail;
+static float landingStart = -1;
+static float landingTime = -1;  // From switching off to being down
+
+static FILE *trace;
+static uint32_t traceCount;
+
+static uint32_t adcSamples;
+static uint32_t adcInPulse;     // Taken while the main rotor pulse was on
+static double adcNoise;         // Sum of the squared noise, counts^2
+
+//*****************************************************************************
+// Gaussian noise from a xorshift generator, so runs repeat exactly
+//*****************************************************************************
+static float uniform(void)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return ((rngState >> 11) + 0.5f) / 9007199254740992.0f;
+}
+
+static float gaussian(void)
+{
+    return sqrtf(-2 * logf(uniform())) * cosf(2 * (float)M_PI * uniform());
+}
+
+//*****************************************************************************
+// Outputs of the rig
+//*****************************************************************************
+float rigHeight(void)
+{
+    return height * 100;
+}
+
+float rigYaw(void)
+{
+    return yaw - refTick * (360.0f / YAW_TICKS_PER_REV);
+}
+
+static uint16_t rigAdcSample(void)
+{
+    float clean = rigParams.groundCounts - height * rigParams.swingCounts;
+    float noise = rigParams.noiseCounts * gaussian();
+    bool inPulse = simPwmOutputHigh(PWM_MAIN_BASE, PWM_MAIN_OUTNUM);
+    float counts;
+
+    if (inPulse && rigParams.pulseNoise) {
+        noise += rigParams.pulseNoise * gaussian();
+    }
+    if (rigParams.edgeNoise) {
+        noise += rigParams.edgeNoise * gaussian()
+            * expf(-simPwmSinceEdge(PWM_MAIN_BASE, PWM_MAIN_OUTNUM) / EDGE_TAU);
+    }
+    adcSamples++;
+    adcInPulse += inPulse;
+    adcNoise += noise * noise;
+
+    counts = clean + noise;
+    return counts < 0 ? 0 : (uint16_t)(counts + 0.5f);
+}
+
+//*****************************************************************************
+// Drive the encoder channels and reference slot for encoderTicks. Channel A
+// is PB0 and B is PB1, and the reference is low over one tick.
+//*****************************************************************************
+static void driveEncoder(void)
+{
+    static const uint8_t quadrature[4] = {0x0, 0x1, 0x3, 0x2};
+    uint8_t code = quadrature[encoderTicks & 3];
+
+    simGpioSetInput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1,
+                    ((code & 2) ? GPIO_PIN_0 : 0) | ((code & 1) ? GPIO_PIN_1 : 0));
+    simGpioSetInput(GPIO_PORTC_BASE, GPIO_PIN_4,
+                    encoderTicks == refTick ? 0 : GPIO_PIN_4);
+}
+
+//*****************************************************************************
+// Move the encoder one tick toward the yaw, one edge per event so the
+// interrupt sees every edge. QEI1 counts the same edges.
+//*****************************************************************************
+static void stepEncoder(void)
+{
+    int32_t target = (int32_t)floorf(yaw * (YAW_TICKS_PER_REV / 360.0f));
+
+    if (target != encoderTicks) {
+        int32_t edge = target > encoderTicks ? 1 : -1;
+        encoderTicks += edge;
+        driveEncoder();
+        simQeiMove(edge, encoderTicks == refTick);
+    }
+    nextEdge = target != encoderTicks ? simNow() + EDGE_GAP_PS : SIM_NEVER;
+}
+
+//*****************************************************************************
+// Advance the physics by dt
+//*****************************************************************************
+static void integrate(float dt)
+{
+    float mainDuty = simPwmDuty(PWM_MAIN_BASE, PWM_MAIN_OUTNUM);
+    float tailDuty = simPwmDuty(PWM_TAIL_BASE, PWM_TAIL_OUTNUM);
+    float hover = rigParams.hoverDuty + rigParams.hoverSlope * height;
+    float climbAccel;
+    float yawAccel;
+
+    mainSpeed += (mainDuty - mainSpeed) * dt / rigParams.mainLag;
+    tailSpeed += (tailDuty - tailSpeed) * dt / rigParams.tailLag;
+
+    climbAccel = rigParams.altGain * (mainSpeed - hover)
+        - rigParams.altDamping * climbRate;
+    climbRate += climbAccel * dt;
+    height += climbRate * dt;
+    if (height <= 0) {
+        height = 0;
+        climbRate = climbRate < 0 ? 0 : climbRate;
+    } else if (height >= 1) {
+        height = 1;
+        climbRate = climbRate > 0 ? 0 : climbRate;
+    }
+
+    yawAccel = rigParams.tailGain * tailSpeed
+        - rigParams.torqueGain * mainSpeed - rigParams.yawDamping * yawRate;
+    yawRate += yawAccel * dt;
+    yaw += yawRate * dt;
+}
+
+//*****************************************************************************
+// Step measurement. A step starts when the setpoint changes in flight and
+// ends at the next change or when the heli stops flying. Changes less than
+// STEP_MERGE apart, as from a run of button presses, make one step.
+// Progress is measured from where the heli was when the step started.
+//*****************************************************************************
+static void endStep(rigTracker_t *tracker)
+{
+    rigStep_t *step = &tracker->step;
+
+    if (!tracker->active) {
+        return;
+    }
+    tracker->active = false;
+    step->overshoot = tracker->peak * 100;
+    step->settling = tracker->lastOutside < simSeconds() - 1.5f / RIG_STEP_HZ
+        ? tracker->lastOutside - step->time : -1;
+    if (numSteps < RIG_MAX_STEPS) {
+        steps[numSteps++] = *step;
+    }
+}
+
+static void track(rigTracker_t *tracker, float setpoint, float actual,
+                  bool flying)
+{
+    rigStep_t *step = &tracker->step;
+    float now = simSeconds();
+    float progress;
+
+    if (!flying) {
+        endStep(tracker);
+        tracker->setpoint = setpoint;
+        return;
+    }
+    if (setpoint != tracker->setpoint) {
+        if (!tracker->active || now - tracker->changed > STEP_MERGE) {
+            endStep(tracker);
+            tracker->active = true;
+            tracker->start = actual;
+            step->time = now;
+            step->from = tracker->setpoint;
+        }
+        step->to = setpoint;
+        step->rise = -1;
+        tracker->t10 = -1;
+        tracker->peak = 0;
+        tracker->changed = now;
+        tracker->setpoint = setpoint;
+    }
+    if (!tracker->active || step->to == tracker->start) {
+        return;
+    }
+    progress = (actual - tracker->start) / (step->to - tracker->start);
+    if (tracker->t10 < 0 && progress >= 0.1f) {
+        tracker->t10 = now;
+    }
+    if (step->rise < 0 && tracker->t10 >= 0 && progress >= 0.9f) {
+        step->rise = now - tracker->t10;
+    }
+    if (progress - 1 > tracker->peak) {
+        tracker->peak = progress - 1;
+    }
+    if (fabsf(progress - 1) > SETTLE_BAND) {
+        tracker->lastOutside = now;
+    }
+}
+
+//*****************************************************************************
+// Accumulate the costs of one physics step
+//*****************************************************************************
+static void addCosts(float dt)
+{
+    static uint8_t lastState;
+    float mainDuty = simPwmDuty(PWM_MAIN_BASE, PWM_MAIN_OUTNUM);
+    float tailDuty = simPwmDuty(PWM_TAIL_BASE, PWM_TAIL_OUTNUM);
+
+    if (state == FLYING) {
+        altIae += fabsf(height_setpoint - rigHeight()) * dt;
+        yawIae += fabsf(yaw_setpoint - rigYaw()) * dt;
+        dutyChange += fabsf(mainDuty - lastMain) + fabsf(tailDuty - lastTail);
+        dutyNoise += ((mainDuty - mainTrend) * (mainDuty - mainTrend)
+                      + (tailDuty - tailTrend) * (tailDuty - tailTrend)) * dt;
+        if (mainDuty <= DUTY_MIN || mainDuty >= DUTY_MAX
+                || tailDuty <= DUTY_MIN || tailDuty >= DUTY_MAX) {
+            saturatedTime += dt;
+        }
+        flyingTime += dt;
+    }
+    mainTrend += (mainDuty - mainTrend) * dt / NOISE_TAU;
+    tailTrend += (tailDuty - tailTrend) * dt / NOISE_TAU;
+    if (state == LANDING && lastState != LANDING) {
+        landingStart = simSeconds();
+        landingTime = -1;
+    } else if (landingStart >= 0 && landingTime < 0 && state != FLYING
+               && rigHeight() < DOWN_HEIGHT) {
+        landingTime = simSeconds() - landingStart;
+    }
+    lastState = state;
+    lastMain = mainDuty;
+    lastTail = tailDuty;
+}
+
+static void writeTrace(void)
+{
+    if (trace && traceCount++ % (RIG_STEP_HZ / TRACE_HZ) == 0) {
+        fprintf(trace, "%.3f,%.2f,%u,%.2f,%d,%.1f,%.1f,%u\n", simSeconds(),
+                rigHeight(), height_setpoint, rigYaw(), yaw_setpoint,
+                simPwmDuty(PWM_MAIN_BASE, PWM_MAIN_OUTNUM),
+                simPwmDuty(PWM_TAIL_BASE, PWM_TAIL_OUTNUM), state);
+    }
+}
+
+//*****************************************************************************
+// Device
+//*****************************************************************************
+static uint64_t rigNextEvent(void)
+{
+    uint64_t next = nextStep < nextEdge ? nextStep : nextEdge;
+    uint64_t script;
+
+    if (nextEventIndex < numEvents) {
+        script = (uint64_t)(events[nextEventIndex].time * SIM_PS_PER_SEC);
+        next = script < next ? script : next;
+    }
+    return next;
+}
+
+static void rigService(void)
+{
+    while (nextEventIndex < numEvents && (uint64_t)(events[nextEventIndex].time
+            * SIM_PS_PER_SEC) <= simNow()) {
+        rigEvent_t *event = &events[nextEventIndex++];
+        simGpioSetInput(event->port, event->pin, event->level);
+    }
+    if (nextStep <= simNow()) {
+        bool flying = state == FLYING;
+
+        integrate(1.0f / RIG_STEP_HZ);
+        nextStep += stepPs;
+        track(&altTracker, height_setpoint, rigHeight(), flying);
+        track(&yawTracker, yaw_setpoint, rigYaw(), flying);
+        addCosts(1.0f / RIG_STEP_HZ);
+        writeTrace();
+    }
+    stepEncoder();
+}
+
+static const simDevice_t rigDevice = {"rig", rigNextEvent, rigService};
+
+//*****************************************************************************
+// Script. Entries are "time:action" or "time:action*count", separated by
+// spaces or commas, where the action is on, off, up, down, left or right.
+//*****************************************************************************
+static void addEvent(float time, uint32_t port, uint8_t pin, uint8_t level)
+{
+    uint32_t i = numEvents;
+
+    if (numEvents == MAX_EVENTS) {
+        fprintf(stderr, "rig: too many script events\n");
+        exit(1);
+    }
+    while (i > 0 && events[i - 1].time > time) {
+        events[i] = events[i - 1];
+        i--;
+    }
+    events[i].time = time;
+    events[i].port = port;
+    events[i].pin = pin;
+    events[i].level = level;
+    numEvents++;
+}
+
+static void addPresses(float time, int count, uint32_t port, uint8_t pin,
+                       bool normal)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        addEvent(time + i * PRESS_REPEAT, port, pin, normal ? 0 : pin);
+        addEvent(time + i * PRESS_REPEAT + PRESS_TIME, port, pin,
+                 normal ? pin : 0);
+    }
+}
+
+static void parseScript(const char *script)
+{
+    char action[8];
+    float time;
+    int count;
+    int used;
+
+    while (*script) {
+        count = 1;
+        if (sscanf(script, " %f:%7[a-z]%n", &time, action, &used) < 2) {
+            fprintf(stderr, "rig: bad script at \"%s\"\n", script);
+            exit(1);
+        }
+        script += used;
+        if (*script == '*') {
+            count = strtol(script + 1, (char **)&script, 10);
+        }
+        script += strspn(script, " ,");
+
+        if (strcmp(action, "on") == 0) {
+            addEvent(time, GPIO_PORTA_BASE, GPIO_PIN_7, GPIO_PIN_7);
+        } else if (strcmp(action, "off") == 0) {
+            addEvent(time, GPIO_PORTA_BASE, GPIO_PIN_7, 0);
+        } else if (strcmp(action, "up") == 0) {
+            addPresses(time, count, UP_BUT_PORT_BASE, UP_BUT_PIN,
+                       UP_BUT_NORMAL);
+        } else if (strcmp(action, "down") == 0) {
+            addPresses(time, count, DOWN_BUT_PORT_BASE, DOWN_BUT_PIN,
+                       DOWN_BUT_NORMAL);
+        } else if (strcmp(action, "left") == 0) {
+            addPresses(time, count, LEFT_BUT_PORT_BASE, LEFT_BUT_PIN,
+                       LEFT_BUT_NORMAL);
+        } else if (strcmp(action, "right") == 0) {
+            addPresses(time, count, RIGHT_BUT_PORT_BASE, RIGHT_BUT_PIN,
+                       RIGHT_BUT_NORMAL);
+        } else {
+            fprintf(stderr, "rig: unknown action \"%s\"\n", action);
+            exit(1);
+        }
+    }
+}
+
+//*****************************************************************************
+// Settings of the form "name=value,..."
+//*****************************************************************************
+static bool setParam(const char *name, float value)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(paramNames) / sizeof(paramNames[0]); i++) {
+        if (strcmp(name, paramNames[i].name) == 0) {
+            *paramNames[i].value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool setGain(const char *name, float value)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(gainNames) / sizeof(gainNames[0]); i++) {
+        if (strcmp(name, gainNames[i].name) == 0) {
+            *gainNames[i].gain = PID_FROM_FLOAT(value);
+            return true;
+        }
+    }
+    for (i = 0; i < sizeof(modeNames) / sizeof(modeNames[0]); i++) {
+        if (strcmp(name, modeNames[i].name) == 0 && value >= 0
+                && value < modeNames[i].numModes) {
+            *modeNames[i].mode = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Scale each parameter by a random factor within 1 +/- spread, for a rig
+// that differs from the model in unknown ways
+static void spreadParams(float spread)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(paramNames) / sizeof(paramNames[0]); i++) {
+        *paramNames[i].value *= 1 + spread * (2 * uniform() - 1);
+    }
+}
+
+static void parseSettings(const char *text, bool (*set)(const char *, float))
+{
+    char name[16];
+    float value;
+    int used;
+
+    while (sscanf(text, " %15[a-z_]=%f%n", name, &value, &used) == 2) {
+        if (!set(name, value)) {
+            fprintf(stderr, "rig: unknown setting \"%s\"\n", name);
+            exit(1);
+        }
+        text += used;
+        text += strspn(text, " ,");
+    }
+    if (*text) {
+        fprintf(stderr, "rig: bad setting at \"%s\"\n", text);
+        exit(1);
+    }
+}
+
+//*****************************************************************************
+// Print the step responses when the run ends
+//*****************************************************************************
+static void printSeconds(const char *name, float seconds)
+{
+    if (seconds < 0) {
+        fprintf(stderr, " %s -", name);
+    } else {
+        fprintf(stderr, " %s %.2f s", name, seconds);
+    }
+}
+
+static float maxOvershoot(char axis)
+{
+    float overshoot = 0;
+    uint32_t i;
+
+    for (i = 0; i < numSteps; i++) {
+        if (steps[i].axis == axis && steps[i].overshoot > overshoot) {
+            overshoot = steps[i].overshoot;
+        }
+    }
+    return overshoot;
+}
+
+static void rigSummary(void)
+{
+    uint32_t i;
+
+    endStep(&altTracker);
+    endStep(&yawTracker);
+    for (i = 0; i < numSteps; i++) {
+        rigStep_t *step = &steps[i];
+        fprintf(stderr, "rig: %s step %g to %g at %.2f s:",
+                step->axis == 'a' ? "alt" : "yaw", step->from, step->to,
+                step->time);
+        printSeconds("rise", step->rise);
+        fprintf(stderr, " overshoot %.1f%%", step->overshoot);
+        printSeconds("settling", step->settling);
+        fputc('\n', stderr);
+    }
+
+    fprintf(stderr, "rig: gains");
+    for (i = 0; i < sizeof(gainNames) / sizeof(gainNames[0]); i++) {
+        fprintf(stderr, " %s %g", gainNames[i].name,
+                PID_TO_FLOAT(*gainNames[i].gain));
+    }
+    for (i = 0; i < sizeof(modeNames) / sizeof(modeNames[0]); i++) {
+        fprintf(stderr, " %s %u", modeNames[i].name, *modeNames[i].mode);
+    }
+    fputc('\n', stderr);
+    fprintf(stderr, "rig: cost alt_iae %.1f yaw_iae %.1f alt_overshoot %.1f "
+            "yaw_overshoot %.1f effort %.2f noise %.3f saturated %.1f "
+            "landing %.2f steps %u\n", altIae, yawIae, maxOvershoot('a'),
+            maxOvershoot('y'), flyingTime > 0 ? dutyChange / flyingTime : 0,
+            flyingTime > 0 ? sqrtf(dutyNoise / flyingTime) : 0,
+            flyingTime > 0 ? 100 * saturatedTime / flyingTime : 0,
+            landingTime, numSteps);
+    fprintf(stderr, "rig: adc %u samples, %.1f%% in the main rotor pulse, "
+            "noise %.2f counts RMS\n", adcSamples,
+            adcSamples ? 100.0 * adcInPulse / adcSamples : 0,
+            adcSamples ? sqrt(adcNoise / adcSamples) : 0);
+    if (trace) {
+        fclose(trace);
+    }
+}
+
+//*****************************************************************************
+// Read the settings from the environment and attach the rig
+//*****************************************************************************
+static __attribute__((constructor)) void rigInit(void)
+{
+    const char *params = getenv("HELI_RIG");
+    const char *script = getenv("HELI_RIG_SCRIPT");
+    const char *seed = getenv("HELI_RIG_SEED");
+    const char *tracePath = getenv("HELI_RIG_TRACE");
+    const char *gains = getenv("HELI_RIG_GAINS");
+    const char *spread = getenv("HELI_RIG_SPREAD");
+
+    if (seed) {
+        rngState = (strtoull(seed, 0, 0) + 1) * 0x9E3779B97F4A7C15ull;
+    }
+    if (params) {
+        parseSettings(params, setParam);
+    }
+    if (spread) {
+        spreadParams(strtof(spread, 0));
+    }
+    if (gains) {
+        parseSettings(gains, setGain);
+    }
+    parseScript(script ? script : DEFAULT_SCRIPT);
+    if (tracePath) {
+        trace = fopen(tracePath, "w");
+        if (!trace) {
+            perror(tracePath);
+            exit(1);
+        }
+        fprintf(trace, "time,alt,alt_sp,yaw,yaw_sp,main,tail,state\n");
+    }
+
+    stepPs = SIM_PS_PER_SEC / RIG_STEP_HZ;
+    nextStep = stepPs;
+    refTick = (int32_t)floorf(rigParams.yawRef * (YAW_TICKS_PER_REV / 360.0f));
+    driveEncoder();
+    simAdcSetSource(rigAdcSample);
+    simAddDevice(&rigDevice);
+    atexit(rigSummary);
+}
@@ -0,0 +1,66 @@
+//*****************************************************************************
+//
+// rig.h - Physics model of the heli rig, run against the firmware on the
+//         simulated microcontroller. The model reads the rotor PWM duties
+//         and drives the altitude ADC, the yaw encoder and reference, the
+//         mode switch and the buttons.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef RIG_H_
+#define RIG_H_
+
+#include <stdint.h>
+
+#define RIG_STEP_HZ 1000        // Physics update rate
+#define RIG_MAX_STEPS 64        // Setpoint steps measured in one run
+
+//*****************************************************************************
+// Rig parameters. Each can be set with HELI_RIG="name=value,...", using the
+// names in rig.c.
+//*****************************************************************************
+typedef struct {
+    float hoverDuty;    // Main duty to hover at the bottom, percent
+    float hoverSlope;   // Extra main duty to hover at the top, percent
+    float altGain;      // Climb acceleration per percent over hover, /s^2
+    float altDamping;   // Climb drag, /s
+    float mainLag;      // Main rotor spin up time constant, s
+    float tailLag;      // Tail rotor spin up time constant, s
+    float tailGain;     // Yaw acceleration per percent of tail, deg/s^2
+    float torqueGain;   // Yaw acceleration per percent of main, deg/s^2
+    float yawDamping;   // Yaw drag, /s
+    float yawRef;       // Reference slot angle from the start, deg
+    float groundCounts; // ADC reading at the bottom
+    float swingCounts;  // ADC fall from the bottom to the top
+    float noiseCounts;  // ADC noise standard deviation
+    float pulseNoise;   // Extra noise while the main rotor pulse is on
+    float edgeNoise;    // Extra noise at a main rotor switching edge, dying
+                        // away over EDGE_TAU
+} rigParams_t;
+
+//*****************************************************************************
+// Response to one setpoint step, measured while flying. Times are from the
+// step, in seconds, and negative if never reached.
+//*****************************************************************************
+typedef struct {
+    char axis;          // 'a' for altitude, 'y' for yaw
+    float time;         // Time of the step
+    float from;
+    float to;
+    float rise;         // 10% to 90% of the step
+    float overshoot;    // Percent of the step
+    float settling;     // To stay within 5% of the step
+} rigStep_t;
+
+extern rigParams_t rigParams;
+
+//*****************************************************************************
+// True height in percent and yaw from the reference in degrees
+//*****************************************************************************
+float rigHeight(void);
+float rigYaw(void);
+
+#endif /* RIG_H_ */
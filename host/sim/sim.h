@@ -0,0 +1,83 @@
+//*****************************************************************************
+//
+// sim.h - Simulated TM4C123 peripherals for the host build. The firmware
+//         calls the driverlib API as it would on the board; these calls let
+//         host code drive the inputs and observe the outputs.
+//
+//         Time only passes when the firmware sleeps or spins on a
+//         peripheral, so a run is deterministic and much faster than real
+//         time.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_PS_PER_SEC 1000000000000ull
+#define SIM_NEVER UINT64_MAX
+
+//*****************************************************************************
+// A simulated device. nextEvent returns the time in ps of the device's next
+// timed event, or SIM_NEVER. service is called once that time is reached
+// and must move the next event past the current time.
+//*****************************************************************************
+typedef struct {
+    const char *name;
+    uint64_t (*nextEvent)(void);
+    void (*service)(void);
+} simDevice_t;
+
+//*****************************************************************************
+// Time
+//*****************************************************************************
+uint64_t simNow(void);                  // Simulated time in ps
+double simSeconds(void);                // Simulated time in seconds
+uint64_t simCyclesToPs(uint64_t cycles); // At the current system clock
+void simWaitUntil(uint64_t ps);         // Run time forward to ps
+void simSetEndTime(uint64_t ps);        // In place of HELI_SIM_SECONDS
+void simAddDevice(const simDevice_t *device);
+
+//*****************************************************************************
+// Interrupts. A device line is asserted while asserted() returns true, and
+// the handler runs when the line and the NVIC are both enabled.
+//*****************************************************************************
+void simIrqLine(uint32_t irq, bool (*asserted)(void));
+void simDispatch(void);
+uint32_t simIrqCount(uint32_t irq);
+void (*simIrqHandler(uint32_t irq))(void);     // As registered, or 0
+
+//*****************************************************************************
+// Inputs
+//*****************************************************************************
+void simGpioSetInput(uint32_t port, uint8_t pins, uint8_t value);
+void simAdcSetInput(uint16_t counts);
+void simAdcSetSource(uint16_t (*source)(void));
+void simAdcInjectOnly(void);            // Ignore the triggers, for a replay
+void simAdcInject(uint16_t counts);     // A conversion now
+void simUartReceive(const char *text);
+void simQeiSet(uint32_t position, int32_t velocity);
+void simQeiMove(int32_t edges, bool index);     // Count edges, or the index
+
+//*****************************************************************************
+// Outputs
+//*****************************************************************************
+uint8_t simGpioGetOutput(uint32_t port);
+float simPwmDuty(uint32_t base, uint32_t pwmOut);   // Percent, 0 if off
+bool simPwmOutputHigh(uint32_t base, uint32_t pwmOut);
+double simPwmSinceEdge(uint32_t base, uint32_t pwmOut);     // Seconds
+uint8_t simOledByte(uint8_t page, uint8_t col);
+uint32_t simOledDataBytes(void);
+void simOledPrint(void);
+
+//*****************************************************************************
+// End the run with a summary. Called when HELI_SIM_SECONDS have passed.
+//*****************************************************************************
+void simFinish(void);
+
+#endif /* SIM_H_ */
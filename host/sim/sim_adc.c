@@ -0,0 +1,277 @@
+//*****************************************************************************
+//
+// sim_adc.c - Simulated ADC0 sample sequence 3, with one step. Conversions
+//             are started by the processor, a timer or a PWM generator and
+//             each takes a microsecond. With DMA enabled, the uDMA channel
+//             copies each sample into ping-pong buffers and the ADC
+//             interrupt signals a finished buffer. A replay can ignore the
+//             triggers and inject each sample instead.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "sim_internal.h"
+#include "inc/hw_ints.h"
+#include "driverlib/adc.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/udma.h"
+
+#define CONVERSION_PS 1000000   // 1 MSPS
+#define FIFO_SIZE 1             // Sequence 3 has a one sample FIFO
+#define DEFAULT_COUNTS 2500     // About 2 V, a landed rig
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+static uint32_t trigger;
+static bool enabled;
+static bool im;
+static bool ris;
+static uint32_t fifo;
+static uint32_t fifoCount;
+static uint64_t conversionEnd = SIM_NEVER;
+static uint16_t inputCounts = DEFAULT_COUNTS;
+static uint16_t (*source)(void);
+static bool injectOnly;         // Samples only come from simAdcInject
+
+// uDMA channel 17, as its primary and alternate control structures
+typedef struct {
+    uint32_t mode;
+    uint16_t *buffer;
+    uint32_t size;
+    uint32_t count;
+} simDmaTransfer_t;
+
+static bool dmaRequests;        // Sequence 3 raises uDMA requests
+static bool dmaEnabled;         // Channel enabled
+static bool dmaDone;            // Completion interrupt, ignores the mask
+static simDmaTransfer_t transfers[2];
+static uint32_t activeTransfer;
+static uint32_t dmaDropped;     // Samples with neither buffer armed
+
+//*****************************************************************************
+// Inputs
+//*****************************************************************************
+void simAdcSetInput(uint16_t counts)
+{
+    inputCounts = counts;
+}
+
+void simAdcSetSource(uint16_t (*sampleSource)(void))
+{
+    source = sampleSource;
+}
+
+static void startConversion(void)
+{
+    if (enabled && !injectOnly && conversionEnd == SIM_NEVER) {
+        conversionEnd = simNow() + CONVERSION_PS;
+    }
+}
+
+void simAdcTimerTrigger(void)
+{
+    if (trigger == ADC_TRIGGER_TIMER) {
+        startConversion();
+    }
+}
+
+void simAdcPwmTrigger(uint32_t gen)
+{
+    if (trigger == ADC_TRIGGER_PWM0 + gen) {
+        startConversion();
+    }
+}
+
+//*****************************************************************************
+// Copy a sample to the active buffer. A full buffer stops, raises the
+// completion interrupt and hands over to the other one.
+//*****************************************************************************
+static void dmaTransfer(uint16_t counts)
+{
+    simDmaTransfer_t *transfer = &transfers[activeTransfer];
+
+    if (transfer->mode == UDMA_MODE_STOP) {
+        dmaDropped++;
+        return;
+    }
+    transfer->buffer[transfer->count++] = counts;
+    if (transfer->count == transfer->size) {
+        transfer->mode = UDMA_MODE_STOP;
+        activeTransfer ^= 1;
+        dmaDone = true;
+    }
+}
+
+void simAdcSummary(void)
+{
+    if (dmaDropped) {
+        fprintf(stderr, "sim: %u ADC samples lost with no DMA buffer armed\n",
+                dmaDropped);
+    }
+}
+
+//*****************************************************************************
+// Device
+//*****************************************************************************
+static uint64_t adcNextEvent(void)
+{
+    return conversionEnd;
+}
+
+static void convert(uint16_t counts)
+{
+    counts = counts > 4095 ? 4095 : counts;
+    if (dmaRequests && dmaEnabled) {
+        dmaTransfer(counts);
+        return;
+    }
+    fifo = counts;
+    fifoCount = FIFO_SIZE;
+    ris = true;
+}
+
+static void adcService(void)
+{
+    conversionEnd = SIM_NEVER;
+    convert(source ? source() : inputCounts);
+}
+
+void simAdcInjectOnly(void)
+{
+    injectOnly = true;
+}
+
+void simAdcInject(uint16_t counts)
+{
+    convert(counts);
+    simDispatch();
+}
+
+static const simDevice_t adcDevice = {"adc", adcNextEvent, adcService};
+
+static bool adcLine(void)
+{
+    return (ris && im) || dmaDone;
+}
+
+static SIM_CONSTRUCTOR void simAdcInit(void)
+{
+    simAddDevice(&adcDevice);
+    simIrqLine(INT_ADC0SS3, adcLine);
+}
+
+//*****************************************************************************
+// Driverlib API
+//*****************************************************************************
+void ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                          uint32_t ui32Trigger, uint32_t ui32Priority)
+{
+    trigger = ui32Trigger;
+}
+
+void ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                              uint32_t ui32Step, uint32_t ui32Config)
+{
+}
+
+void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    enabled = true;
+}
+
+void ADCSequenceDMAEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    dmaRequests = true;
+}
+
+int32_t ADCSequenceDataGet(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                           uint32_t *pui32Buffer)
+{
+    int32_t count = fifoCount;
+
+    if (fifoCount) {
+        *pui32Buffer = fifo;
+        fifoCount = 0;
+    }
+    return count;
+}
+
+void ADCProcessorTrigger(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    startConversion();
+}
+
+void ADCIntRegister(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                    void (*pfnHandler)(void))
+{
+    IntRegister(INT_ADC0SS3, pfnHandler);
+    IntEnable(INT_ADC0SS3);
+}
+
+void ADCIntEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    im = true;
+    simDispatch();
+}
+
+void ADCIntDisable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    im = false;
+}
+
+void ADCIntClear(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    ris = false;
+    dmaDone = false;
+}
+
+//*****************************************************************************
+// uDMA
+//*****************************************************************************
+void uDMAEnable(void)
+{
+}
+
+void uDMAControlBaseSet(void *pControlTable)
+{
+}
+
+void uDMAChannelAssign(uint32_t ui32Mapping)
+{
+}
+
+void uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+}
+
+void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex,
+                           uint32_t ui32Control)
+{
+}
+
+// Only 16 bit transfers from the ADC FIFO to memory are modelled
+void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex,
+                            uint32_t ui32Mode, void *pvSrcAddr,
+                            void *pvDstAddr, uint32_t ui32TransferSize)
+{
+    simDmaTransfer_t *transfer
+        = &transfers[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0];
+
+    transfer->mode = ui32Mode;
+    transfer->buffer = pvDstAddr;
+    transfer->size = ui32TransferSize;
+    transfer->count = 0;
+}
+
+void uDMAChannelEnable(uint32_t ui32ChannelNum)
+{
+    dmaEnabled = true;
+}
+
+uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex)
+{
+    return transfers[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0].mode;
+}
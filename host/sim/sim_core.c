@@ -0,0 +1,437 @@
+//*****************************************************************************
+//
+// sim_core.c - Time, interrupts, register storage, system control and
+//              SysTick of the simulated microcontroller
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include <string.h>
+#include <time.h>
+#include "sim_internal.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+
+#define SIM_MAX_DEVICES 16
+#define SIM_REGISTERS 256           // Registers the firmware can touch directly
+#define SIM_STORM_LIMIT 100000      // Handlers run with no time passing
+#define SIM_DEFAULT_SECONDS 10
+#define PIOSC_HZ 16000000           // Clock out of reset
+#define PLL_HZ 200000000            // PLL output after the fixed divide by 2
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+static uint64_t now;                // Simulated time in ps
+static uint64_t endTime;
+static uint32_t clockHz = PIOSC_HZ;
+static uint32_t pwmDivider = 1;
+static struct timespec wallStart;
+
+static const simDevice_t *devices[SIM_MAX_DEVICES];
+static uint32_t numDevices;
+
+static void (*vectors[NUM_INTERRUPTS])(void);
+static bool (*lines[NUM_INTERRUPTS])(void);
+static bool nvicEnabled[NUM_INTERRUPTS];
+static uint8_t priorities[NUM_INTERRUPTS];
+static uint32_t irqCounts[NUM_INTERRUPTS];
+static bool masterEnabled = true;   // PRIMASK is clear out of reset
+static bool inHandler;
+
+static struct {
+    uint32_t addr;
+    volatile uint32_t value;
+} registers[SIM_REGISTERS];
+static uint32_t numRegisters;
+
+static uint32_t sysTickPeriod;
+static bool sysTickEnabled;
+static bool sysTickIntEnabled;
+static bool sysTickPending;
+static uint64_t sysTickStart;
+static uint64_t sysTickNext = SIM_NEVER;
+
+//*****************************************************************************
+// Read the run settings from the environment
+//*****************************************************************************
+static SIM_CONSTRUCTOR void simInit(void)
+{
+    const char *seconds = getenv("HELI_SIM_SECONDS");
+    const char *rx = getenv("HELI_SIM_RX");
+    double runSeconds = seconds ? atof(seconds) : SIM_DEFAULT_SECONDS;
+
+    endTime = (uint64_t)(runSeconds * SIM_PS_PER_SEC);
+    if (rx) {
+        simUartReceive(rx);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+}
+
+//*****************************************************************************
+// Time
+//*****************************************************************************
+uint64_t simNow(void)
+{
+    return now;
+}
+
+double simSeconds(void)
+{
+    return (double)now / SIM_PS_PER_SEC;
+}
+
+uint32_t simClockHz(void)
+{
+    return clockHz;
+}
+
+uint32_t simPwmClockHz(void)
+{
+    return clockHz / pwmDivider;
+}
+
+void simSetEndTime(uint64_t ps)
+{
+    endTime = ps;
+}
+
+uint64_t simCyclesToPs(uint64_t cycles)
+{
+    return cycles * (SIM_PS_PER_SEC / clockHz);
+}
+
+void simAddDevice(const simDevice_t *device)
+{
+    if (numDevices == SIM_MAX_DEVICES) {
+        SIM_FATAL("too many devices");
+    }
+    devices[numDevices++] = device;
+}
+
+//*****************************************************************************
+// The time of the next SysTick or device event
+//*****************************************************************************
+static uint64_t nextEvent(void)
+{
+    uint64_t next = sysTickNext;
+    uint32_t i;
+
+    for (i = 0; i < numDevices; i++) {
+        uint64_t t = devices[i]->nextEvent();
+        if (t < next) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+//*****************************************************************************
+// Handle the events due now
+//*****************************************************************************
+static void serviceEvents(void)
+{
+    uint32_t i;
+
+    while (sysTickNext <= now) {
+        sysTickPending = sysTickIntEnabled;
+        sysTickNext += simCyclesToPs(sysTickPeriod);
+    }
+    for (i = 0; i < numDevices; i++) {
+        if (devices[i]->nextEvent() <= now) {
+            devices[i]->service();
+        }
+    }
+}
+
+//*****************************************************************************
+// Run time forward to ps, one event at a time, taking interrupts as they
+// come due
+//*****************************************************************************
+void simWaitUntil(uint64_t ps)
+{
+    uint64_t next;
+
+    while ((next = nextEvent()) <= ps) {
+        if (next > now) {
+            now = next;
+        }
+        if (now >= endTime) {
+            simFinish();
+        }
+        serviceEvents();
+        simDispatch();
+    }
+    if (ps > now) {
+        now = ps;
+    }
+    if (now >= endTime) {
+        simFinish();
+    }
+    simDispatch();
+}
+
+//*****************************************************************************
+// Interrupts
+//*****************************************************************************
+void simIrqLine(uint32_t irq, bool (*asserted)(void))
+{
+    lines[irq] = asserted;
+}
+
+uint32_t simIrqCount(uint32_t irq)
+{
+    return irqCounts[irq];
+}
+
+void (*simIrqHandler(uint32_t irq))(void)
+{
+    return vectors[irq];
+}
+
+static bool irqPending(uint32_t irq)
+{
+    if (vectors[irq] == 0) {
+        return false;
+    }
+    if (irq == FAULT_SYSTICK) {
+        return sysTickPending;
+    }
+    return nvicEnabled[irq] && lines[irq] && lines[irq]();
+}
+
+//*****************************************************************************
+// Run the handlers of the pending interrupts, highest priority first. The
+// handlers do not nest, as nothing else runs while one is in progress.
+//*****************************************************************************
+void simDispatch(void)
+{
+    uint32_t storm = 0;
+
+    if (inHandler) {
+        return;
+    }
+    inHandler = true;
+    while (masterEnabled) {
+        uint32_t irq;
+        int32_t next = -1;
+
+        for (irq = 0; irq < NUM_INTERRUPTS; irq++) {
+            if (irqPending(irq)
+                    && (next < 0 || priorities[irq] < priorities[next])) {
+                next = irq;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        if (++storm > SIM_STORM_LIMIT) {
+            SIM_FATAL("interrupt %d is never cleared", next);
+        }
+        if (next == FAULT_SYSTICK) {
+            sysTickPending = false;
+        }
+        irqCounts[next]++;
+        vectors[next]();
+    }
+    inHandler = false;
+}
+
+bool IntMasterEnable(void)
+{
+    bool wasDisabled = !masterEnabled;
+
+    masterEnabled = true;
+    simDispatch();
+    return wasDisabled;
+}
+
+bool IntMasterDisable(void)
+{
+    bool wasDisabled = !masterEnabled;
+
+    masterEnabled = false;
+    return wasDisabled;
+}
+
+void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+    vectors[ui32Interrupt] = pfnHandler;
+}
+
+void IntEnable(uint32_t ui32Interrupt)
+{
+    nvicEnabled[ui32Interrupt] = true;
+    simDispatch();
+}
+
+void IntDisable(uint32_t ui32Interrupt)
+{
+    nvicEnabled[ui32Interrupt] = false;
+}
+
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+    priorities[ui32Interrupt] = ui8Priority;
+}
+
+//*****************************************************************************
+// Registers the firmware accesses through HWREG. Each address gets its own
+// storage on first use, so writes read back but have no side effects.
+//*****************************************************************************
+volatile uint32_t *simRegister(uint32_t addr)
+{
+    uint32_t i;
+
+    for (i = 0; i < numRegisters; i++) {
+        if (registers[i].addr == addr) {
+            return &registers[i].value;
+        }
+    }
+    if (numRegisters == SIM_REGISTERS) {
+        SIM_FATAL("too many registers");
+    }
+    registers[numRegisters].addr = addr;
+    return &registers[numRegisters++].value;
+}
+
+//*****************************************************************************
+// System control. Only the PLL divider of the clock setting is modelled.
+//*****************************************************************************
+void SysCtlClockSet(uint32_t ui32Config)
+{
+    if (ui32Config & SYSCTL_USE_OSC) {
+        clockHz = PIOSC_HZ;
+    } else {
+        clockHz = PLL_HZ / (((ui32Config >> 23) & 0xF) + 1);
+    }
+}
+
+uint32_t SysCtlClockGet(void)
+{
+    return clockHz;
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    return true;
+}
+
+bool SysCtlPeripheralPresent(uint32_t ui32Peripheral)
+{
+    return true;
+}
+
+// SYSCTL_PWMDIV_n sets USEPWMDIV and the divider as a power of two from 2
+void SysCtlPWMClockSet(uint32_t ui32Config)
+{
+    pwmDivider = (ui32Config & 0x00100000) ? 2u << ((ui32Config >> 17) & 7) : 1;
+}
+
+void SysCtlDelay(uint32_t ui32Count)
+{
+    simWaitUntil(now + simCyclesToPs(3ull * ui32Count));
+}
+
+//*****************************************************************************
+// Sleep until the next event. The processor wakes on a pending interrupt
+// even with interrupts masked, so this never runs a handler itself unless
+// they are enabled.
+//*****************************************************************************
+void SysCtlSleep(void)
+{
+    uint64_t next = nextEvent();
+
+    if (next == SIM_NEVER) {
+        SIM_FATAL("sleeping with nothing to wake up");
+    }
+    simWaitUntil(next);
+}
+
+//*****************************************************************************
+// SysTick
+//*****************************************************************************
+static void sysTickRestart(void)
+{
+    sysTickStart = now;
+    sysTickNext = (sysTickEnabled && sysTickPeriod)
+        ? now + simCyclesToPs(sysTickPeriod) : SIM_NEVER;
+}
+
+void SysTickEnable(void)
+{
+    sysTickEnabled = true;
+    sysTickRestart();
+}
+
+void SysTickDisable(void)
+{
+    sysTickEnabled = false;
+    sysTickRestart();
+}
+
+void SysTickIntRegister(void (*pfnHandler)(void))
+{
+    IntRegister(FAULT_SYSTICK, pfnHandler);
+}
+
+void SysTickIntEnable(void)
+{
+    sysTickIntEnabled = true;
+}
+
+void SysTickIntDisable(void)
+{
+    sysTickIntEnabled = false;
+}
+
+void SysTickPeriodSet(uint32_t ui32Period)
+{
+    sysTickPeriod = ui32Period;
+    sysTickRestart();
+}
+
+uint32_t SysTickValueGet(void)
+{
+    if (!sysTickEnabled || sysTickPeriod == 0) {
+        return 0;
+    }
+    return sysTickPeriod - 1
+        - (uint32_t)((now - sysTickStart) / simCyclesToPs(1) % sysTickPeriod);
+}
+
+//*****************************************************************************
+// End the run with a summary on stderr, leaving stdout to the UART
+//*****************************************************************************
+void simFinish(void)
+{
+    struct timespec wallEnd;
+    double wall;
+
+    fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+    wall = (wallEnd.tv_sec - wallStart.tv_sec)
+        + (wallEnd.tv_nsec - wallStart.tv_nsec) / 1e9;
+    fprintf(stderr, "sim: %.3f s simulated in %.3f s", simSeconds(), wall);
+    if (wall > 0) {
+        fprintf(stderr, " (%.0fx real time)", simSeconds() / wall);
+    }
+    fprintf(stderr, "\nsim: %u SysTick interrupts\n", irqCounts[FAULT_SYSTICK]);
+    simPwmSummary();
+    simAdcSummary();
+    simUartSummary();
+    simSsiSummary();
+    if (getenv("HELI_SIM_OLED")) {
+        simOledPrint();
+    }
+    exit(0);
+}
@@ -0,0 +1,251 @@
+//*****************************************************************************
+//
+// sim_gpio.c - Simulated GPIO ports A to F. Inputs float to their pull
+//              resistors until the simulation drives them, and a driven
+//              change raises the edge interrupts the port is set up for.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "sim_internal.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+
+#define NUM_PORTS 6
+
+typedef struct {
+    uint32_t base;
+    uint32_t irq;
+    uint8_t dir;        // 1 for an output
+    uint8_t afsel;      // 1 for a peripheral function
+    uint8_t data;       // Output levels
+    uint8_t driven;     // Inputs driven by the simulation
+    uint8_t input;      // Levels of the driven inputs
+    uint8_t pur;        // Pull ups
+    uint8_t pdr;        // Pull downs
+    uint8_t ibe;        // Interrupt on both edges
+    uint8_t iev;        // Interrupt on the rising edge
+    uint8_t im;         // Interrupt mask
+    uint8_t ris;        // Raw interrupt status
+    uint8_t pctl[8];    // Peripheral function of each pin, 0 if none
+} simPort_t;
+
+static simPort_t ports[NUM_PORTS] = {
+    {GPIO_PORTA_BASE, INT_GPIOA}, {GPIO_PORTB_BASE, INT_GPIOB},
+    {GPIO_PORTC_BASE, INT_GPIOC}, {GPIO_PORTD_BASE, INT_GPIOD},
+    {GPIO_PORTE_BASE, INT_GPIOE}, {GPIO_PORTF_BASE, INT_GPIOF},
+};
+
+//*****************************************************************************
+// Find a port from its base address
+//*****************************************************************************
+static simPort_t *getPort(uint32_t base)
+{
+    uint32_t i;
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        if (ports[i].base == base) {
+            return &ports[i];
+        }
+    }
+    SIM_FATAL("no GPIO port at 0x%08x", base);
+}
+
+//*****************************************************************************
+// The level on each pin
+//*****************************************************************************
+static uint8_t pinLevels(const simPort_t *port)
+{
+    uint8_t inputs = ~port->dir & ~port->afsel;
+
+    return (port->dir & port->data)
+        | (inputs & port->driven & port->input)
+        | (inputs & ~port->driven & port->pur);
+}
+
+#define PORT_LINE(n) \
+    static bool port##n##Line(void) { return ports[n].ris & ports[n].im; }
+PORT_LINE(0) PORT_LINE(1) PORT_LINE(2) PORT_LINE(3) PORT_LINE(4) PORT_LINE(5)
+
+static SIM_CONSTRUCTOR void simGpioInit(void)
+{
+    bool (*portLines[NUM_PORTS])(void) = {
+        port0Line, port1Line, port2Line, port3Line, port4Line, port5Line
+    };
+    uint32_t i;
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        simIrqLine(ports[i].irq, portLines[i]);
+    }
+}
+
+//*****************************************************************************
+// Drive input pins, raising the interrupts of any edges
+//*****************************************************************************
+void simGpioSetInput(uint32_t base, uint8_t pins, uint8_t value)
+{
+    simPort_t *port = getPort(base);
+    uint8_t before = pinLevels(port);
+    uint8_t after;
+    uint8_t changed;
+
+    port->driven |= pins;
+    port->input = (port->input & ~pins) | (value & pins);
+    after = pinLevels(port);
+    changed = before ^ after;
+    port->ris |= changed & (port->ibe | ~(after ^ port->iev));
+    simDispatch();
+}
+
+uint8_t simGpioGetOutput(uint32_t base)
+{
+    simPort_t *port = getPort(base);
+
+    return port->dir & port->data;
+}
+
+//*****************************************************************************
+// Pin configuration
+//*****************************************************************************
+void GPIODirModeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32PinIO)
+{
+    simPort_t *port = getPort(ui32Port);
+
+    port->dir = (ui32PinIO == GPIO_DIR_MODE_OUT)
+        ? port->dir | ui8Pins : port->dir & ~ui8Pins;
+    port->afsel = (ui32PinIO == GPIO_DIR_MODE_HW)
+        ? port->afsel | ui8Pins : port->afsel & ~ui8Pins;
+}
+
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins,
+                      uint32_t ui32Strength, uint32_t ui32PadType)
+{
+    simPort_t *port = getPort(ui32Port);
+
+    port->pur = (ui32PadType == GPIO_PIN_TYPE_STD_WPU)
+        ? port->pur | ui8Pins : port->pur & ~ui8Pins;
+    port->pdr = (ui32PadType == GPIO_PIN_TYPE_STD_WPD)
+        ? port->pdr | ui8Pins : port->pdr & ~ui8Pins;
+}
+
+//*****************************************************************************
+// Mux a pin to a peripheral. A pin already muxed to another peripheral would
+// be taken from it without a word on the Tiva, so that is fatal here.
+//*****************************************************************************
+void GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+    uint32_t portIndex = (ui32PinConfig >> 16) & 0xff;
+    uint32_t pin = ((ui32PinConfig >> 8) & 0xff) / 4;
+    uint8_t function = ui32PinConfig & 0xf;
+    simPort_t *port;
+
+    if (portIndex >= NUM_PORTS || pin >= 8) {
+        SIM_FATAL("no pin for configuration 0x%08x", ui32PinConfig);
+    }
+    port = &ports[portIndex];
+    if (port->pctl[pin] && port->pctl[pin] != function) {
+        SIM_FATAL("P%c%u muxed to function %u is taken for function %u",
+                  'A' + portIndex, pin, port->pctl[pin], function);
+    }
+    port->pctl[pin] = function;
+}
+
+void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_IN);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+}
+
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_OUT);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+}
+
+static void pinTypeHardware(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_HW);
+}
+
+void GPIOPinTypePWM(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    pinTypeHardware(ui32Port, ui8Pins);
+}
+
+void GPIOPinTypeQEI(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    pinTypeHardware(ui32Port, ui8Pins);
+}
+
+void GPIOPinTypeSSI(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    pinTypeHardware(ui32Port, ui8Pins);
+}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    pinTypeHardware(ui32Port, ui8Pins);
+}
+
+//*****************************************************************************
+// Pin data
+//*****************************************************************************
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    return pinLevels(getPort(ui32Port)) & ui8Pins;
+}
+
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    simPort_t *port = getPort(ui32Port);
+
+    port->data = (port->data & ~ui8Pins) | (ui8Val & ui8Pins);
+}
+
+//*****************************************************************************
+// Interrupts. Level interrupt types are treated as the matching edge.
+//*****************************************************************************
+void GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType)
+{
+    simPort_t *port = getPort(ui32Port);
+
+    port->ibe = (ui32IntType == GPIO_BOTH_EDGES)
+        ? port->ibe | ui8Pins : port->ibe & ~ui8Pins;
+    port->iev = (ui32IntType & GPIO_RISING_EDGE)
+        ? port->iev | ui8Pins : port->iev & ~ui8Pins;
+}
+
+void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    getPort(ui32Port)->im |= ui32IntFlags;
+    simDispatch();
+}
+
+void GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    getPort(ui32Port)->im &= ~ui32IntFlags;
+}
+
+uint32_t GPIOIntStatus(uint32_t ui32Port, bool bMasked)
+{
+    simPort_t *port = getPort(ui32Port);
+
+    return bMasked ? port->ris & port->im : port->ris;
+}
+
+void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    getPort(ui32Port)->ris &= ~ui32IntFlags;
+}
+
+void GPIOIntRegister(uint32_t ui32Port, void (*pfnIntHandler)(void))
+{
+    simPort_t *port = getPort(ui32Port);
+
+    IntRegister(port->irq, pfnIntHandler);
+    IntEnable(port->irq);
+}
@@ -0,0 +1,39 @@
+//*****************************************************************************
+//
+// sim_internal.h - Shared state of the simulated peripherals
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef SIM_INTERNAL_H_
+#define SIM_INTERNAL_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+
+#define SIM_CONSTRUCTOR __attribute__((constructor))
+
+// Stop the run on a firmware or simulator error
+#define SIM_FATAL(...) do { \
+        fprintf(stderr, "sim: " __VA_ARGS__); \
+        fputc('\n', stderr); \
+        exit(1); \
+    } while (0)
+
+uint32_t simClockHz(void);
+uint32_t simPwmClockHz(void);
+
+// Summaries of each peripheral, printed by simFinish
+void simPwmSummary(void);
+void simAdcSummary(void);
+void simUartSummary(void);
+void simSsiSummary(void);
+
+// ADC conversions started by a timer timeout or a PWM generator
+void simAdcTimerTrigger(void);
+void simAdcPwmTrigger(uint32_t gen);
+
+#endif /* SIM_INTERNAL_H_ */
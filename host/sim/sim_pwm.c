@@ -0,0 +1,344 @@
+//*****************************************************************************
+//
+// sim_pwm.c - Simulated PWM modules 0 and 1. Each generator counts from
+//             when it is enabled, down from the load value or up to it and
+//             back down, with its outputs set by the comparators as
+//             PWMGenConfigure sets them up in TivaWare. The ADC triggers of
+//             module 0 fire as the count passes zero, the load value or a
+//             comparator, and the rig model reads where in its pulse an
+//             output is to add the motor switching noise.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "sim_internal.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/pwm.h"
+
+#define NUM_MODULES 2
+#define NUM_GENS 4
+#define NUM_OUTS 8
+#define TRIGGER_MASK 0x3F00     // PWM_TR_CNT_ZERO to PWM_TR_CNT_BD
+#define NO_EDGE_SECONDS 1.0     // Time since an edge of a steady output
+
+typedef struct {
+    uint32_t base;
+    uint32_t period[NUM_GENS];
+    bool upDown[NUM_GENS];      // Counts up to the load value and back
+    bool genEnabled[NUM_GENS];
+    uint64_t genStart[NUM_GENS];        // When the count last started
+    uint32_t width[NUM_OUTS];
+    uint32_t outEnabled;        // PWM_OUT_n_BIT of the enabled outputs
+    uint32_t triggers[NUM_GENS];        // PWM_TR_CNT_* ADC triggers
+    uint64_t nextTrigger[NUM_GENS];
+} simPwm_t;
+
+static simPwm_t modules[NUM_MODULES] = {
+    {PWM0_BASE, .nextTrigger = {SIM_NEVER, SIM_NEVER, SIM_NEVER, SIM_NEVER}},
+    {PWM1_BASE},
+};
+
+static simPwm_t *getModule(uint32_t base)
+{
+    uint32_t i;
+
+    for (i = 0; i < NUM_MODULES; i++) {
+        if (modules[i].base == base) {
+            return &modules[i];
+        }
+    }
+    SIM_FATAL("no PWM module at 0x%08x", base);
+}
+
+// PWM_GEN_n is (n + 1) << 6, and PWM_OUT_n is its generator's PWM_GEN | n
+static uint32_t genIndex(uint32_t gen)
+{
+    return ((gen & ~7u) >> 6) - 1;
+}
+
+//*****************************************************************************
+// Duty cycle in percent of an output, or 0 when it is off
+//*****************************************************************************
+float simPwmDuty(uint32_t base, uint32_t pwmOut)
+{
+    simPwm_t *module = getModule(base);
+    uint32_t out = pwmOut & 7;
+    uint32_t gen = genIndex(pwmOut);
+
+    if (!(module->outEnabled & (1u << out)) || !module->genEnabled[gen]
+            || module->period[gen] == 0) {
+        return 0;
+    }
+    return module->width[out] * 100.0f / module->period[gen];
+}
+
+void simPwmSummary(void)
+{
+    uint32_t i;
+    uint32_t out;
+
+    for (i = 0; i < NUM_MODULES; i++) {
+        for (out = 0; out < NUM_OUTS; out++) {
+            if (modules[i].outEnabled & (1u << out)) {
+                fprintf(stderr, "sim: PWM%u output %u at %.1f%%\n", i, out,
+                        simPwmDuty(modules[i].base,
+                                   ((out / 2 + 1) << 6) | out));
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+// Waveform. Times are in PWM clocks from the start of a period. In up/down
+// mode the period is twice the load value: the count goes up from zero and
+// back, and PWMPulseWidthSet puts each comparator at the load value less
+// half the width, with its output high while the count is above it. That
+// centres the pulse on the load value. In down mode the count goes down
+// from the load value, and the output is high from the start of the period
+// until the count reaches the load value less the width.
+//*****************************************************************************
+static uint64_t clockPs(void)
+{
+    return SIM_PS_PER_SEC / simPwmClockHz();
+}
+
+static uint32_t periodPosition(const simPwm_t *module, uint32_t gen)
+{
+    return ((simNow() - module->genStart[gen]) / clockPs())
+        % module->period[gen];
+}
+
+// Where an output goes high and low again, within a period
+static void pulseEdges(const simPwm_t *module, uint32_t out, uint32_t *rise,
+                       uint32_t *fall)
+{
+    uint32_t gen = out / 2;
+    uint32_t period = module->period[gen];
+    uint32_t width = module->width[out] < period ? module->width[out] : period;
+
+    if (module->upDown[gen]) {
+        *rise = (period - width) / 2;
+        *fall = period - *rise;
+    } else {
+        *rise = 0;
+        *fall = width;
+    }
+}
+
+// Time a trigger fires within a period, or false if it never does
+static bool triggerTime(const simPwm_t *module, uint32_t gen, uint32_t trigger,
+                        uint32_t *time)
+{
+    uint32_t rise, fall;
+    uint32_t period = module->period[gen];
+
+    switch (trigger) {
+    case PWM_TR_CNT_ZERO:
+        *time = module->upDown[gen] ? 0 : period - 1;
+        return true;
+    case PWM_TR_CNT_LOAD:
+        *time = module->upDown[gen] ? period / 2 : 0;
+        return true;
+    case PWM_TR_CNT_AU:
+    case PWM_TR_CNT_BU:
+        pulseEdges(module, gen * 2 + (trigger == PWM_TR_CNT_BU), &rise, &fall);
+        *time = rise;
+        return module->upDown[gen];
+    case PWM_TR_CNT_AD:
+    case PWM_TR_CNT_BD:
+        pulseEdges(module, gen * 2 + (trigger == PWM_TR_CNT_BD), &rise, &fall);
+        *time = fall;
+        return true;
+    }
+    return false;
+}
+
+static bool outputRunning(const simPwm_t *module, uint32_t out)
+{
+    uint32_t gen = out / 2;
+
+    return (module->outEnabled & (1u << out)) && module->genEnabled[gen]
+        && module->period[gen];
+}
+
+bool simPwmOutputHigh(uint32_t base, uint32_t pwmOut)
+{
+    simPwm_t *module = getModule(base);
+    uint32_t out = pwmOut & 7;
+    uint32_t rise, fall, now;
+
+    if (!outputRunning(module, out)) {
+        return false;
+    }
+    pulseEdges(module, out, &rise, &fall);
+    now = periodPosition(module, out / 2);
+    return now >= rise && now < fall;
+}
+
+double simPwmSinceEdge(uint32_t base, uint32_t pwmOut)
+{
+    simPwm_t *module = getModule(base);
+    uint32_t out = pwmOut & 7;
+    uint32_t period, rise, fall, now, since;
+
+    if (!outputRunning(module, out)) {
+        return NO_EDGE_SECONDS;
+    }
+    period = module->period[out / 2];
+    pulseEdges(module, out, &rise, &fall);
+    if (fall - rise == 0 || fall - rise == period) {
+        return NO_EDGE_SECONDS;
+    }
+    now = periodPosition(module, out / 2);
+    since = (now + period - rise) % period;
+    if ((now + period - fall) % period < since) {
+        since = (now + period - fall) % period;
+    }
+    return (double)since / simPwmClockHz();
+}
+
+//*****************************************************************************
+// Device. Only module 0 is wired to the ADC.
+//*****************************************************************************
+static uint64_t triggerAfter(const simPwm_t *module, uint32_t gen,
+                             uint64_t after)
+{
+    uint64_t periodPs = module->period[gen] * clockPs();
+    uint64_t start = module->genStart[gen]
+        + (after - module->genStart[gen]) / periodPs * periodPs;
+    uint64_t next = SIM_NEVER;
+    uint64_t at;
+    uint32_t trigger, time;
+
+    for (trigger = PWM_TR_CNT_ZERO; trigger <= PWM_TR_CNT_BD; trigger <<= 1) {
+        if ((module->triggers[gen] & trigger)
+                && triggerTime(module, gen, trigger, &time)) {
+            at = start + time * clockPs();
+            if (at <= after) {
+                at += periodPs;
+            }
+            next = at < next ? at : next;
+        }
+    }
+    return next;
+}
+
+static void restartTriggers(simPwm_t *module, uint32_t gen)
+{
+    if (module != &modules[0]) {
+        return;
+    }
+    module->nextTrigger[gen] = (module->genEnabled[gen] && module->period[gen]
+        && module->triggers[gen])
+        ? triggerAfter(module, gen, simNow()) : SIM_NEVER;
+}
+
+static uint64_t pwmNextEvent(void)
+{
+    uint64_t next = SIM_NEVER;
+    uint32_t gen;
+
+    for (gen = 0; gen < NUM_GENS; gen++) {
+        if (modules[0].nextTrigger[gen] < next) {
+            next = modules[0].nextTrigger[gen];
+        }
+    }
+    return next;
+}
+
+static void pwmService(void)
+{
+    simPwm_t *module = &modules[0];
+    uint32_t gen;
+
+    for (gen = 0; gen < NUM_GENS; gen++) {
+        while (module->nextTrigger[gen] <= simNow()) {
+            module->nextTrigger[gen]
+                = triggerAfter(module, gen, module->nextTrigger[gen]);
+            simAdcPwmTrigger(gen);
+        }
+    }
+}
+
+static const simDevice_t pwmDevice = {"pwm", pwmNextEvent, pwmService};
+
+static SIM_CONSTRUCTOR void simPwmInit(void)
+{
+    simAddDevice(&pwmDevice);
+}
+
+//*****************************************************************************
+// Driverlib API
+//*****************************************************************************
+void PWMGenConfigure(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Config)
+{
+    simPwm_t *module = getModule(ui32Base);
+
+    module->upDown[genIndex(ui32Gen)] = ui32Config & PWM_GEN_MODE_UP_DOWN;
+    restartTriggers(module, genIndex(ui32Gen));
+}
+
+void PWMGenPeriodSet(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Period)
+{
+    simPwm_t *module = getModule(ui32Base);
+
+    module->period[genIndex(ui32Gen)] = ui32Period;
+    restartTriggers(module, genIndex(ui32Gen));
+}
+
+uint32_t PWMGenPeriodGet(uint32_t ui32Base, uint32_t ui32Gen)
+{
+    return getModule(ui32Base)->period[genIndex(ui32Gen)];
+}
+
+void PWMGenEnable(uint32_t ui32Base, uint32_t ui32Gen)
+{
+    simPwm_t *module = getModule(ui32Base);
+
+    if (!module->genEnabled[genIndex(ui32Gen)]) {
+        module->genStart[genIndex(ui32Gen)] = simNow();
+    }
+    module->genEnabled[genIndex(ui32Gen)] = true;
+    restartTriggers(module, genIndex(ui32Gen));
+}
+
+void PWMGenDisable(uint32_t ui32Base, uint32_t ui32Gen)
+{
+    simPwm_t *module = getModule(ui32Base);
+
+    module->genEnabled[genIndex(ui32Gen)] = false;
+    restartTriggers(module, genIndex(ui32Gen));
+}
+
+void PWMPulseWidthSet(uint32_t ui32Base, uint32_t ui32PWMOut,
+                      uint32_t ui32Width)
+{
+    simPwm_t *module = getModule(ui32Base);
+
+    module->width[ui32PWMOut & 7] = ui32Width;
+    restartTriggers(module, genIndex(ui32PWMOut));
+}
+
+uint32_t PWMPulseWidthGet(uint32_t ui32Base, uint32_t ui32PWMOut)
+{
+    return getModule(ui32Base)->width[ui32PWMOut & 7];
+}
+
+void PWMOutputState(uint32_t ui32Base, uint32_t ui32PWMOutBits, bool bEnable)
+{
+    simPwm_t *module = getModule(ui32Base);
+
+    module->outEnabled = bEnable ? module->outEnabled | ui32PWMOutBits
+        : module->outEnabled & ~ui32PWMOutBits;
+}
+
+void PWMGenIntTrigEnable(uint32_t ui32Base, uint32_t ui32Gen,
+                         uint32_t ui32IntTrig)
+{
+    simPwm_t *module = getModule(ui32Base);
+
+    module->triggers[genIndex(ui32Gen)] |= ui32IntTrig & TRIGGER_MASK;
+    restartTriggers(module, genIndex(ui32Gen));
+}
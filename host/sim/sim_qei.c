@@ -0,0 +1,111 @@
+//*****************************************************************************
+//
+// sim_qei.c - Simulated QEI1. The position and velocity are set by the
+//             simulation rather than decoded from the encoder signals. The
+//             simulation signals the index; the error interrupt is never
+//             raised.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "sim_internal.h"
+#include "inc/hw_ints.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/qei.h"
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+static uint32_t position;
+static int32_t velocity;        // Edges per velocity period, signed
+static uint32_t im;
+static uint32_t ris;
+
+void simQeiSet(uint32_t qeiPosition, int32_t qeiVelocity)
+{
+    position = qeiPosition;
+    velocity = qeiVelocity;
+}
+
+void simQeiMove(int32_t edges, bool index)
+{
+    position += edges;
+    if (index) {
+        ris |= QEI_INTINDEX;
+        simDispatch();
+    }
+}
+
+static bool qeiLine(void)
+{
+    return ris & im;
+}
+
+static SIM_CONSTRUCTOR void simQeiInit(void)
+{
+    simIrqLine(INT_QEI1, qeiLine);
+}
+
+//*****************************************************************************
+// Driverlib API
+//*****************************************************************************
+void QEIConfigure(uint32_t ui32Base, uint32_t ui32Config,
+                  uint32_t ui32MaxPosition)
+{
+}
+
+void QEIEnable(uint32_t ui32Base)
+{
+}
+
+uint32_t QEIPositionGet(uint32_t ui32Base)
+{
+    return position;
+}
+
+void QEIPositionSet(uint32_t ui32Base, uint32_t ui32Position)
+{
+    position = ui32Position;
+}
+
+int32_t QEIDirectionGet(uint32_t ui32Base)
+{
+    return velocity < 0 ? -1 : 1;
+}
+
+void QEIVelocityConfigure(uint32_t ui32Base, uint32_t ui32PreDiv,
+                          uint32_t ui32Period)
+{
+}
+
+void QEIVelocityEnable(uint32_t ui32Base)
+{
+}
+
+uint32_t QEIVelocityGet(uint32_t ui32Base)
+{
+    return velocity < 0 ? -velocity : velocity;
+}
+
+void QEIIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    IntRegister(INT_QEI1, pfnHandler);
+    IntEnable(INT_QEI1);
+}
+
+void QEIIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    im |= ui32IntFlags;
+}
+
+uint32_t QEIIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    return bMasked ? ris & im : ris;
+}
+
+void QEIIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    ris &= ~ui32IntFlags;
+}
@@ -0,0 +1,278 @@
+//*****************************************************************************
+//
+// sim_ssi.c - Simulated SSI3 with an 8 byte transmit FIFO, and the OLED
+//             controller of the Orbit booster pack on the other end. The
+//             controller decodes the commands the Orbit driver sends and
+//             keeps the display memory, so a test can read back what is on
+//             the screen.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "sim_internal.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/ssi.h"
+#include "OrbitBoosterPackDefs.h"
+
+#define FIFO_SIZE 8
+#define OLED_PAGES 4
+#define OLED_COLS 128
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+static bool enabled;
+static uint32_t bitRate = 1000000;
+static uint32_t im;
+static uint64_t idleAt;         // Time the transmit FIFO and shifter empty
+static uint32_t rxCount;
+static uint32_t dropped;        // Bytes written while SSI3 was disabled
+
+static uint8_t oled[OLED_PAGES][OLED_COLS];
+static uint8_t page;
+static uint8_t col;
+static uint8_t command;         // Command waiting for its argument
+static uint8_t argsLeft;
+static uint32_t commandBytes;
+static uint32_t dataBytes;
+
+static uint64_t byteTime(void)
+{
+    return 8 * SIM_PS_PER_SEC / bitRate;
+}
+
+// Bytes still in the FIFO or being shifted out
+static uint32_t bytesQueued(void)
+{
+    uint64_t now = simNow();
+
+    return idleAt > now ? (idleAt - now + byteTime() - 1) / byteTime() : 0;
+}
+
+//*****************************************************************************
+// OLED controller. Commands are sent with D/C low and display data with it
+// high, both with CS low.
+//*****************************************************************************
+static uint8_t commandArgs(uint8_t cmd)
+{
+    switch (cmd) {
+        case 0x20: case 0x22: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void oledCommand(uint8_t b)
+{
+    commandBytes++;
+    if (argsLeft) {
+        argsLeft--;
+        if (command == 0x22) {
+            page = b % OLED_PAGES;      // The driver sends only the start page
+        }
+    } else if (b <= 0x0F) {
+        col = (col & 0xF0) | b;
+    } else if (b <= 0x1F) {
+        col = (col & 0x0F) | ((b & 0x0F) << 4);
+    } else if (b >= 0xB0 && b <= 0xB7) {
+        page = b % OLED_PAGES;
+    } else {
+        command = b;
+        argsLeft = commandArgs(b);
+    }
+}
+
+static void oledData(uint8_t b)
+{
+    oled[page][col % OLED_COLS] = b;
+    col = (col + 1) % OLED_COLS;
+    dataBytes++;
+}
+
+static void oledReceive(uint8_t b)
+{
+    uint8_t portD = simGpioGetOutput(GPIO_PORTD_BASE);
+
+    if (portD & nCS_OLED) {
+        return;
+    }
+    if (portD & nDC_OLED) {
+        oledData(b);
+    } else {
+        oledCommand(b);
+    }
+}
+
+uint8_t simOledByte(uint8_t pg, uint8_t column)
+{
+    return oled[pg % OLED_PAGES][column % OLED_COLS];
+}
+
+uint32_t simOledDataBytes(void)
+{
+    return dataBytes;
+}
+
+//*****************************************************************************
+// Draw the display memory on stderr, a row of pixels per line
+//*****************************************************************************
+void simOledPrint(void)
+{
+    uint32_t row;
+    uint32_t c;
+
+    for (row = 0; row < OLED_PAGES * 8; row++) {
+        for (c = 0; c < OLED_COLS; c++) {
+            fputc((oled[row / 8][c] >> (row % 8)) & 1 ? '#' : ' ', stderr);
+        }
+        fputc('\n', stderr);
+    }
+}
+
+void simSsiSummary(void)
+{
+    fprintf(stderr, "sim: OLED received %u command and %u data bytes\n",
+            commandBytes, dataBytes);
+    if (dropped) {
+        fprintf(stderr, "sim: %u bytes written to SSI3 while disabled\n",
+                dropped);
+    }
+}
+
+//*****************************************************************************
+// Device. The transmit interrupt is a level, asserted at half empty, or
+// with end of transmission mode once the last bit is out.
+//*****************************************************************************
+static uint64_t txInterruptTime(void)
+{
+    uint64_t halfFifo = (FIFO_SIZE / 2) * byteTime();
+
+    if (HWREG(SSI3_BASE + SSI_O_CR1) & SSI_CR1_EOT) {
+        return idleAt;
+    }
+    return idleAt > halfFifo ? idleAt - halfFifo : 0;
+}
+
+static uint64_t ssiNextEvent(void)
+{
+    uint64_t t;
+
+    if (!(im & SSI_TXFF)) {
+        return SIM_NEVER;
+    }
+    t = txInterruptTime();
+    return t > simNow() ? t : SIM_NEVER;
+}
+
+static void ssiService(void)
+{
+}
+
+static const simDevice_t ssiDevice = {"ssi", ssiNextEvent, ssiService};
+
+static bool ssiLine(void)
+{
+    return (im & SSI_TXFF) && txInterruptTime() <= simNow();
+}
+
+static SIM_CONSTRUCTOR void simSsiInit(void)
+{
+    simAddDevice(&ssiDevice);
+    simIrqLine(INT_SSI3, ssiLine);
+}
+
+//*****************************************************************************
+// Driverlib API. Only SSI3 is modelled.
+//*****************************************************************************
+void SSIConfigSetExpClk(uint32_t ui32Base, uint32_t ui32SSIClk,
+                        uint32_t ui32Protocol, uint32_t ui32Mode,
+                        uint32_t ui32BitRate, uint32_t ui32DataWidth)
+{
+    bitRate = ui32BitRate;
+}
+
+void SSIClockSourceSet(uint32_t ui32Base, uint32_t ui32Source)
+{
+}
+
+void SSIEnable(uint32_t ui32Base)
+{
+    enabled = true;
+}
+
+void SSIDisable(uint32_t ui32Base)
+{
+    enabled = false;
+}
+
+void SSIDataPut(uint32_t ui32Base, uint32_t ui32Data)
+{
+    uint64_t now;
+
+    if (!enabled) {
+        dropped++;
+        return;
+    }
+    if (bytesQueued() >= FIFO_SIZE) {
+        simWaitUntil(idleAt - (FIFO_SIZE - 1) * byteTime());
+    }
+    now = simNow();
+    idleAt = (idleAt > now ? idleAt : now) + byteTime();
+    if (rxCount < FIFO_SIZE) {
+        rxCount++;
+    }
+    oledReceive(ui32Data);
+}
+
+void SSIDataGet(uint32_t ui32Base, uint32_t *pui32Data)
+{
+    if (rxCount == 0) {
+        SIM_FATAL("waiting for an SSI byte that was never sent");
+    }
+    simWaitUntil(idleAt);
+    rxCount--;
+    *pui32Data = 0;
+}
+
+int32_t SSIDataGetNonBlocking(uint32_t ui32Base, uint32_t *pui32Data)
+{
+    if (rxCount == 0) {
+        return 0;
+    }
+    rxCount--;
+    *pui32Data = 0;
+    return 1;
+}
+
+bool SSIBusy(uint32_t ui32Base)
+{
+    if (idleAt > simNow()) {
+        simWaitUntil(idleAt);
+    }
+    return false;
+}
+
+void SSIIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    IntRegister(INT_SSI3, pfnHandler);
+    IntEnable(INT_SSI3);
+}
+
+void SSIIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    im |= ui32IntFlags;
+    simDispatch();
+}
+
+void SSIIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    im &= ~ui32IntFlags;
+}
@@ -0,0 +1,208 @@
+//*****************************************************************************
+//
+// sim_timer.c - Simulated general purpose timers 0 and 1, as full width
+//               periodic timers. A down counting timer times out every load
+//               cycles. An up counting timer is only read by polling, so
+//               each read advances time by a poll step.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include "sim_internal.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_timer.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/timer.h"
+
+#define NUM_TIMERS 2
+#define POLL_CYCLES 20          // Cycles for one read of the timer in a loop
+
+typedef struct {
+    uint32_t base;
+    uint32_t irq;
+    uint32_t config;
+    uint32_t load;
+    bool enabled;
+    bool adcTrigger;
+    uint32_t im;
+    uint32_t ris;
+    uint64_t start;
+    uint64_t next;
+} simTimer_t;
+
+static simTimer_t timers[NUM_TIMERS] = {
+    {TIMER0_BASE, INT_TIMER0A, .next = SIM_NEVER},
+    {TIMER1_BASE, INT_TIMER1A, .next = SIM_NEVER},
+};
+
+static simTimer_t *getTimer(uint32_t base)
+{
+    uint32_t i;
+
+    for (i = 0; i < NUM_TIMERS; i++) {
+        if (timers[i].base == base) {
+            return &timers[i];
+        }
+    }
+    SIM_FATAL("no timer at 0x%08x", base);
+}
+
+static bool countsDown(const simTimer_t *timer)
+{
+    return timer->config == TIMER_CFG_PERIODIC;
+}
+
+//*****************************************************************************
+// Start counting from now
+//*****************************************************************************
+static void restart(simTimer_t *timer)
+{
+    timer->start = simNow();
+    timer->next = (timer->enabled && countsDown(timer) && timer->load)
+        ? timer->start + simCyclesToPs(timer->load) : SIM_NEVER;
+}
+
+//*****************************************************************************
+// Device
+//*****************************************************************************
+static uint64_t timerNextEvent(void)
+{
+    return timers[0].next < timers[1].next ? timers[0].next : timers[1].next;
+}
+
+static void timerService(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < NUM_TIMERS; i++) {
+        simTimer_t *timer = &timers[i];
+        while (timer->next <= simNow()) {
+            timer->ris |= TIMER_TIMA_TIMEOUT;
+            timer->next += simCyclesToPs(timer->load);
+            if (timer->adcTrigger) {
+                simAdcTimerTrigger();
+            }
+        }
+    }
+}
+
+static const simDevice_t timerDevice = {"timer", timerNextEvent, timerService};
+
+static bool timer0Line(void)
+{
+    return timers[0].ris & timers[0].im;
+}
+
+static bool timer1Line(void)
+{
+    return timers[1].ris & timers[1].im;
+}
+
+static SIM_CONSTRUCTOR void simTimerInit(void)
+{
+    simAddDevice(&timerDevice);
+    simIrqLine(INT_TIMER0A, timer0Line);
+    simIrqLine(INT_TIMER1A, timer1Line);
+}
+
+//*****************************************************************************
+// Driverlib API
+//*****************************************************************************
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    simTimer_t *timer = getTimer(ui32Base);
+
+    timer->enabled = true;
+    restart(timer);
+}
+
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    simTimer_t *timer = getTimer(ui32Base);
+
+    timer->enabled = false;
+    restart(timer);
+}
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+    simTimer_t *timer = getTimer(ui32Base);
+
+    timer->config = ui32Config;
+    timer->enabled = false;
+    restart(timer);
+}
+
+void TimerControlTrigger(uint32_t ui32Base, uint32_t ui32Timer, bool bEnable)
+{
+    getTimer(ui32Base)->adcTrigger = bEnable;
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    simTimer_t *timer = getTimer(ui32Base);
+
+    timer->load = ui32Value;
+    restart(timer);
+}
+
+uint32_t TimerLoadGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    return getTimer(ui32Base)->load;
+}
+
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    simTimer_t *timer = getTimer(ui32Base);
+    volatile uint32_t *tav = &HWREG(ui32Base + TIMER_O_TAV);
+    uint64_t elapsed;
+
+    if (countsDown(timer)) {
+        if (!timer->enabled || timer->load == 0) {
+            return timer->load;
+        }
+        elapsed = (simNow() - timer->start) / simCyclesToPs(1);
+        return timer->load - (uint32_t)(elapsed % timer->load);
+    }
+    if (timer->enabled) {
+        *tav += POLL_CYCLES;
+        simWaitUntil(simNow() + simCyclesToPs(POLL_CYCLES));
+    }
+    return *tav;
+}
+
+void TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer,
+                      void (*pfnHandler)(void))
+{
+    simTimer_t *timer = getTimer(ui32Base);
+
+    IntRegister(timer->irq, pfnHandler);
+    IntEnable(timer->irq);
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    getTimer(ui32Base)->im |= ui32IntFlags;
+    simDispatch();
+}
+
+void TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    getTimer(ui32Base)->im &= ~ui32IntFlags;
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    getTimer(ui32Base)->ris &= ~ui32IntFlags;
+}
+
+uint32_t TimerIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    simTimer_t *timer = getTimer(ui32Base);
+
+    return bMasked ? timer->ris & timer->im : timer->ris;
+}
@@ -0,0 +1,339 @@
+//*****************************************************************************
+//
+// sim_uart.c - Simulated UARTs with 16 byte FIFOs, sending and receiving
+//              one character per ten bit times. UART0 transmits to stdout,
+//              and receives the text given to simUartReceive, which may
+//              hold parts of it back until a given time.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#include <ctype.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/uart.h"
+
+#define NUM_UARTS 3
+#define FIFO_SIZE 16
+#define TX_TRIGGER 2            // The TX interrupt asserts at 1/8 full
+#define RX_QUEUE_SIZE 1024
+#define DEFAULT_BAUD 115200
+
+typedef struct {
+    uint32_t base;
+    uint32_t irq;
+    uint32_t baud;
+    uint32_t im;
+    uint32_t ris;               // Raw status of the receive interrupts
+    uint32_t txCount;
+    uint64_t txDone;            // Time the byte being sent finishes
+    uint32_t rxFifo[FIFO_SIZE];
+    uint32_t rxRead;
+    uint32_t rxCount;
+    uint32_t sent;
+    uint32_t overruns;
+} simUart_t;
+
+static simUart_t uarts[NUM_UARTS] = {
+    {UART0_BASE, INT_UART0, DEFAULT_BAUD, 0, 0, 0, SIM_NEVER},
+    {UART1_BASE, INT_UART1, DEFAULT_BAUD, 0, 0, 0, SIM_NEVER},
+    {UART2_BASE, INT_UART2, DEFAULT_BAUD, 0, 0, 0, SIM_NEVER},
+};
+
+// Text still to arrive on UART0, and the earliest each character may
+static char rxQueue[RX_QUEUE_SIZE];
+static uint64_t rxQueueAt[RX_QUEUE_SIZE];
+static uint32_t rxQueueRead;
+static uint32_t rxQueueLength;
+static uint64_t rxNext = SIM_NEVER;
+
+static simUart_t *getUart(uint32_t base)
+{
+    uint32_t i;
+
+    for (i = 0; i < NUM_UARTS; i++) {
+        if (uarts[i].base == base) {
+            return &uarts[i];
+        }
+    }
+    SIM_FATAL("no UART at 0x%08x", base);
+}
+
+static uint64_t charTime(const simUart_t *uart)
+{
+    return 10 * SIM_PS_PER_SEC / uart->baud;
+}
+
+//*****************************************************************************
+// Queue text to arrive on UART0. The escapes \n, \r, \t, \\ and \xHH stand
+// for those characters, and \@<seconds>; holds the rest of the text back
+// until that simulated time.
+//*****************************************************************************
+void simUartReceive(const char *text)
+{
+    uint64_t at = simNow();
+    char *end;
+
+    while (*text) {
+        char c = *text++;
+
+        if (c == '\\') {
+            c = *text++;
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case '\\': break;
+                case 'x': {
+                    char hex[3] = {text[0], 0, 0};
+
+                    if (!isxdigit((unsigned char)hex[0])
+                        || !isxdigit((unsigned char)text[1])) {
+                        SIM_FATAL("bad \\x escape in UART input");
+                    }
+                    hex[1] = text[1];
+                    c = strtoul(hex, 0, 16);
+                    text += 2;
+                    break;
+                }
+                case '@':
+                    at = strtod(text, &end) * SIM_PS_PER_SEC;
+                    if (end == text || *end != ';') {
+                        SIM_FATAL("bad \\@ escape in UART input");
+                    }
+                    text = end + 1;
+                    continue;
+                default:
+                    SIM_FATAL("unknown escape \\%c in UART input", c);
+            }
+        }
+        if (rxQueueLength == RX_QUEUE_SIZE) {
+            SIM_FATAL("too much UART input");
+        }
+        rxQueueAt[rxQueueLength] = at;
+        rxQueue[rxQueueLength++] = c;
+    }
+    if (rxNext == SIM_NEVER && rxQueueRead < rxQueueLength) {
+        rxNext = simNow() + charTime(&uarts[0]);
+        if (rxNext < rxQueueAt[rxQueueRead]) {
+            rxNext = rxQueueAt[rxQueueRead];
+        }
+    }
+}
+
+void simUartSummary(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < NUM_UARTS; i++) {
+        if (uarts[i].sent || uarts[i].overruns) {
+            fprintf(stderr, "sim: UART%u sent %u bytes, %u receive overruns\n",
+                    i, uarts[i].sent, uarts[i].overruns);
+        }
+    }
+}
+
+//*****************************************************************************
+// Device
+//*****************************************************************************
+static uint64_t uartNextEvent(void)
+{
+    uint64_t next = rxNext;
+    uint32_t i;
+
+    for (i = 0; i < NUM_UARTS; i++) {
+        if (uarts[i].txDone < next) {
+            next = uarts[i].txDone;
+        }
+    }
+    return next;
+}
+
+static void uartService(void)
+{
+    simUart_t *uart0 = &uarts[0];
+    uint32_t i;
+
+    for (i = 0; i < NUM_UARTS; i++) {
+        simUart_t *uart = &uarts[i];
+        while (uart->txDone <= simNow()) {
+            uart->txCount--;
+            uart->txDone = uart->txCount
+                ? uart->txDone + charTime(uart) : SIM_NEVER;
+        }
+    }
+    if (rxNext <= simNow()) {
+        if (uart0->rxCount == FIFO_SIZE) {
+            uart0->overruns++;
+        } else {
+            uart0->rxFifo[(uart0->rxRead + uart0->rxCount) % FIFO_SIZE]
+                = (unsigned char)rxQueue[rxQueueRead];
+            uart0->rxCount++;
+        }
+        uart0->ris |= UART_INT_RX;
+        rxQueueRead++;
+        if (rxQueueRead < rxQueueLength) {
+            rxNext += charTime(uart0);
+            if (rxNext < rxQueueAt[rxQueueRead]) {
+                rxNext = rxQueueAt[rxQueueRead];
+            }
+        } else {
+            rxNext = SIM_NEVER;
+        }
+    }
+}
+
+static const simDevice_t uartDevice = {"uart", uartNextEvent, uartService};
+
+static uint32_t intStatus(const simUart_t *uart)
+{
+    return uart->ris | (uart->txCount <= TX_TRIGGER ? UART_INT_TX : 0);
+}
+
+static bool uart0Line(void)
+{
+    return intStatus(&uarts[0]) & uarts[0].im;
+}
+
+static bool uart1Line(void)
+{
+    return intStatus(&uarts[1]) & uarts[1].im;
+}
+
+static bool uart2Line(void)
+{
+    return intStatus(&uarts[2]) & uarts[2].im;
+}
+
+static SIM_CONSTRUCTOR void simUartInit(void)
+{
+    simAddDevice(&uartDevice);
+    simIrqLine(INT_UART0, uart0Line);
+    simIrqLine(INT_UART1, uart1Line);
+    simIrqLine(INT_UART2, uart2Line);
+}
+
+//*****************************************************************************
+// Driverlib API
+//*****************************************************************************
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                         uint32_t ui32Baud, uint32_t ui32Config)
+{
+    getUart(ui32Base)->baud = ui32Baud;
+}
+
+void UARTClockSourceSet(uint32_t ui32Base, uint32_t ui32Source)
+{
+}
+
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel,
+                      uint32_t ui32RxLevel)
+{
+}
+
+void UARTEnable(uint32_t ui32Base)
+{
+}
+
+void UARTDisable(uint32_t ui32Base)
+{
+}
+
+bool UARTCharsAvail(uint32_t ui32Base)
+{
+    return getUart(ui32Base)->rxCount != 0;
+}
+
+bool UARTSpaceAvail(uint32_t ui32Base)
+{
+    return getUart(ui32Base)->txCount < FIFO_SIZE;
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+    simUart_t *uart = getUart(ui32Base);
+    uint32_t c;
+
+    if (uart->rxCount == 0) {
+        return -1;
+    }
+    c = uart->rxFifo[uart->rxRead];
+    uart->rxRead = (uart->rxRead + 1) % FIFO_SIZE;
+    uart->rxCount--;
+    return c;
+}
+
+int32_t UARTCharGet(uint32_t ui32Base)
+{
+    simUart_t *uart = getUart(ui32Base);
+
+    while (uart->rxCount == 0) {
+        if (uart != &uarts[0] || rxNext == SIM_NEVER) {
+            SIM_FATAL("waiting for UART input that never comes");
+        }
+        simWaitUntil(rxNext);
+    }
+    return UARTCharGetNonBlocking(ui32Base);
+}
+
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    simUart_t *uart = getUart(ui32Base);
+
+    if (uart->txCount == FIFO_SIZE) {
+        return false;
+    }
+    if (uart->txCount++ == 0) {
+        uart->txDone = simNow() + charTime(uart);
+    }
+    uart->sent++;
+    if (uart == &uarts[0]) {
+        putchar(ucData);
+    }
+    return true;
+}
+
+void UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    simUart_t *uart = getUart(ui32Base);
+
+    while (!UARTCharPutNonBlocking(ui32Base, ucData)) {
+        simWaitUntil(uart->txDone);
+    }
+}
+
+void UARTIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    simUart_t *uart = getUart(ui32Base);
+
+    IntRegister(uart->irq, pfnHandler);
+    IntEnable(uart->irq);
+}
+
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    getUart(ui32Base)->im |= ui32IntFlags;
+    simDispatch();
+}
+
+void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    getUart(ui32Base)->im &= ~ui32IntFlags;
+}
+
+uint32_t UARTIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    simUart_t *uart = getUart(ui32Base);
+
+    return bMasked ? intStatus(uart) & uart->im : intStatus(uart);
+}
+
+void UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    getUart(ui32Base)->ris &= ~ui32IntFlags;
+}
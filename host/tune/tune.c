@@ -0,0 +1,652 @@
+//*****************************************************************************
+//
+// tune.c - Tunes the PID gains by flying the host build of the firmware on
+//          the rig model, many flights at a time across all cores
+//
+// Usage:  heli_tune [options]
+//
+// Each gain set is flown on the same set of trial rigs, each with its
+// parameters spread at random about the model and its own noise, and
+// scored on the mean cost of its flights. The cost weighs the altitude and
+// yaw integral of absolute error, the worst overshoot, the duty changes
+// per second and the time to land. A flight that misses any of the setpoint
+// steps the built in gains flew fails. By default a random search narrows in
+// on the best gains from the ones built into the firmware; -s sweeps a
+// grid instead. The best gain sets are listed on standard output, and the
+// best is written as a pid_gains.h to replace the one in Heli_Assignment.
+//
+// The gains are set in the firmware's own PID.c through HELI_RIG_GAINS,
+// so the flights use the firmware control law and not a copy of it.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <spawn.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define NUM_GAINS 6
+#define MAX_JOBS 256
+#define OUTPUT_SIZE 4096        // Enough for the summary of one flight
+#define NO_LANDING_COST 60      // Seconds charged for a flight that never lands
+
+extern char **environ;
+
+static const char *gainNames[NUM_GAINS] = {
+    "alt_kp", "alt_ki", "alt_kd", "yaw_kp", "yaw_ki", "yaw_kd"
+};
+
+static const char *headerNames[NUM_GAINS] = {
+    "PID_GAIN_ALT_KP", "PID_GAIN_ALT_KI", "PID_GAIN_ALT_KD",
+    "PID_GAIN_YAW_KP", "PID_GAIN_YAW_KI", "PID_GAIN_YAW_KD"
+};
+
+//*****************************************************************************
+// Costs of one flight, as printed by the rig, and their weights
+//*****************************************************************************
+typedef struct {
+    float altIae;
+    float yawIae;
+    float altOvershoot;
+    float yawOvershoot;
+    float effort;
+    float landing;
+    float steps;                // Setpoint steps flown
+} flightCost_t;
+
+static struct {
+    float altIae;
+    float yawIae;
+    float overshoot;
+    float effort;
+    float landing;
+} weights = {1, 0.2f, 2, 0.01f, 5};
+
+//*****************************************************************************
+// A gain set and its costs summed over the trials flown so far
+//*****************************************************************************
+typedef struct {
+    float gains[NUM_GAINS];
+    bool builtIn;               // The firmware's own gains
+    uint32_t flown;
+    uint32_t failed;
+    flightCost_t total;
+    float score;
+} candidate_t;
+
+// A flight in progress
+typedef struct {
+    pid_t pid;
+    int fd;
+    candidate_t *candidate;
+    char output[OUTPUT_SIZE];
+    size_t length;
+} job_t;
+
+//*****************************************************************************
+// Options
+//*****************************************************************************
+static const char *simPath;
+static uint32_t numJobs;
+static uint32_t numTrials = 8;
+static uint32_t population = 32;
+static uint32_t generations = 8;
+static float spread = 0.15f;
+static uint32_t seconds = 75;
+static uint32_t seed = 1;
+static uint32_t showCount = 10;
+static const char *headerPath = "pid_gains.h";
+static const char *sweepSpec;
+
+static uint64_t rngState;
+static job_t jobs[MAX_JOBS];
+static uint32_t flights;
+static float minSteps;          // Fewest steps the built in gains flew
+
+//*****************************************************************************
+// Random numbers for the search, repeatable from -r
+//*****************************************************************************
+static double uniform(void)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return ((rngState >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double gaussian(void)
+{
+    return sqrt(-2 * log(uniform())) * cos(2 * M_PI * uniform());
+}
+
+//*****************************************************************************
+// Read "name value" from a rig line into a float. Returns false if the name
+// is missing.
+//*****************************************************************************
+static bool readField(const char *line, const char *name, float *value)
+{
+    char key[32];
+    const char *at;
+
+    snprintf(key, sizeof(key), " %s ", name);
+    at = strstr(line, key);
+    return at && sscanf(at + strlen(key), "%f", value) == 1;
+}
+
+static bool parseCost(const char *output, flightCost_t *cost)
+{
+    const char *line = strstr(output, "rig: cost");
+
+    return line && readField(line, "alt_iae", &cost->altIae)
+        && readField(line, "yaw_iae", &cost->yawIae)
+        && readField(line, "alt_overshoot", &cost->altOvershoot)
+        && readField(line, "yaw_overshoot", &cost->yawOvershoot)
+        && readField(line, "effort", &cost->effort)
+        && readField(line, "landing", &cost->landing)
+        && readField(line, "steps", &cost->steps);
+}
+
+static bool parseGains(const char *output, float gains[NUM_GAINS])
+{
+    const char *line = strstr(output, "rig: gains");
+    uint32_t i;
+
+    for (i = 0; i < NUM_GAINS; i++) {
+        if (!line || !readField(line, gainNames[i], &gains[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//*****************************************************************************
+// Weighted cost of a flight. A flight that never lands is charged as if it
+// took NO_LANDING_COST seconds.
+//*****************************************************************************
+static float flightScore(const flightCost_t *cost)
+{
+    float landing = cost->landing < 0 ? NO_LANDING_COST : cost->landing;
+
+    return weights.altIae * cost->altIae + weights.yawIae * cost->yawIae
+        + weights.overshoot * (cost->altOvershoot + cost->yawOvershoot)
+        + weights.effort * cost->effort + weights.landing * landing;
+}
+
+static void addCost(candidate_t *candidate, const flightCost_t *cost)
+{
+    candidate->total.altIae += cost->altIae;
+    candidate->total.yawIae += cost->yawIae;
+    candidate->total.altOvershoot += cost->altOvershoot;
+    candidate->total.yawOvershoot += cost->yawOvershoot;
+    candidate->total.effort += cost->effort;
+    candidate->total.landing += cost->landing < 0 ? NO_LANDING_COST
+        : cost->landing;
+    candidate->score += flightScore(cost);
+    candidate->flown++;
+}
+
+static float meanScore(const candidate_t *candidate)
+{
+    return candidate->failed || !candidate->flown ? INFINITY
+        : candidate->score / candidate->flown;
+}
+
+//*****************************************************************************
+// Start one flight of a candidate on trial rig number trial. The rig and
+// gain settings replace any in the environment; HELI_RIG and
+// HELI_RIG_SCRIPT are passed on, so the model and flight can be changed.
+//*****************************************************************************
+static bool isOverridden(const char *entry)
+{
+    static const char *names[] = {
+        "HELI_SIM_SECONDS=", "HELI_SIM_OLED=", "HELI_RIG_SEED=",
+        "HELI_RIG_SPREAD=", "HELI_RIG_GAINS=", "HELI_RIG_TRACE="
+    };
+    uint32_t i;
+
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strncmp(entry, names[i], strlen(names[i])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void startFlight(job_t *job, candidate_t *candidate, uint32_t trial)
+{
+    static char **env;
+    static uint32_t envCount;
+    char settings[4][256];
+    char *argv[] = {(char *)simPath, 0};
+    posix_spawn_file_actions_t actions;
+    int fds[2];
+    uint32_t i;
+    int len;
+
+    if (!env) {
+        for (i = 0; environ[i]; i++) {
+        }
+        env = calloc(i + 5, sizeof(char *));
+        for (i = 0; environ[i]; i++) {
+            if (!isOverridden(environ[i])) {
+                env[envCount++] = environ[i];
+            }
+        }
+    }
+
+    snprintf(settings[0], sizeof(settings[0]), "HELI_SIM_SECONDS=%u", seconds);
+    snprintf(settings[1], sizeof(settings[1]), "HELI_RIG_SEED=%u",
+             seed * 1000 + trial);
+    snprintf(settings[2], sizeof(settings[2]), "HELI_RIG_SPREAD=%g", spread);
+    len = snprintf(settings[3], sizeof(settings[3]), "HELI_RIG_GAINS=");
+    for (i = 0; i < NUM_GAINS && !candidate->builtIn; i++) {
+        len += snprintf(settings[3] + len, sizeof(settings[3]) - len, "%s%s=%g",
+                        i ? "," : "", gainNames[i], candidate->gains[i]);
+    }
+    for (i = 0; i < 4; i++) {
+        env[envCount + i] = settings[i];
+    }
+    env[envCount + 4] = 0;
+
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], 2);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+    errno = posix_spawn(&job->pid, simPath, &actions, 0, argv, env);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (errno) {
+        perror(simPath);
+        exit(1);
+    }
+    job->fd = fds[0];
+    job->candidate = candidate;
+    job->length = 0;
+}
+
+//*****************************************************************************
+// Wait for a flight to end, read what it printed and score it
+//*****************************************************************************
+static void finishFlight(void)
+{
+    job_t *job = 0;
+    flightCost_t cost;
+    ssize_t got;
+    pid_t pid;
+    int status;
+    uint32_t i;
+
+    pid = wait(&status);
+    for (i = 0; i < numJobs && !job; i++) {
+        if (jobs[i].pid == pid) {
+            job = &jobs[i];
+        }
+    }
+    if (!job) {
+        return;
+    }
+    while ((got = read(job->fd, job->output + job->length,
+                       OUTPUT_SIZE - 1 - job->length)) > 0) {
+        job->length += got;
+    }
+    job->output[job->length] = 0;
+    close(job->fd);
+    job->pid = 0;
+    flights++;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0
+            || !parseCost(job->output, &cost)) {
+        job->candidate->failed++;
+        return;
+    }
+    if (job->candidate->builtIn) {
+        parseGains(job->output, job->candidate->gains);
+        if (minSteps == 0 || cost.steps < minSteps) {
+            minSteps = cost.steps;
+        }
+    } else if (cost.steps < minSteps) {
+        // Too slow to be flying when the buttons were pressed
+        job->candidate->failed++;
+        return;
+    }
+    addCost(job->candidate, &cost);
+}
+
+//*****************************************************************************
+// Fly every candidate on every trial rig, numJobs flights at a time
+//*****************************************************************************
+static void flyAll(candidate_t *candidates, uint32_t count)
+{
+    uint32_t running = 0;
+    uint32_t next = 0;
+    uint32_t i;
+
+    while (next < count * numTrials || running) {
+        if (next < count * numTrials && running < numJobs) {
+            for (i = 0; jobs[i].pid; i++) {
+            }
+            startFlight(&jobs[i], &candidates[next / numTrials],
+                        next % numTrials);
+            next++;
+            running++;
+        } else {
+            finishFlight();
+            running--;
+        }
+    }
+}
+
+// The built in gains come first, and the search starts from them
+static void flyBuiltIn(candidate_t *builtIn)
+{
+    builtIn->builtIn = true;
+    flyAll(builtIn, 1);
+    if (!isfinite(meanScore(builtIn))) {
+        fprintf(stderr, "tune: the built in gains failed to fly, is %s "
+                "built?\n", simPath);
+        exit(1);
+    }
+}
+
+//*****************************************************************************
+// Results
+//*****************************************************************************
+static int compareCandidates(const void *a, const void *b)
+{
+    float scoreA = meanScore(a);
+    float scoreB = meanScore(b);
+
+    return scoreA < scoreB ? -1 : scoreA > scoreB ? 1 : 0;
+}
+
+static void printCandidate(uint32_t rank, const candidate_t *candidate)
+{
+    const flightCost_t *total = &candidate->total;
+    float n = candidate->flown ? candidate->flown : 1;
+    uint32_t i;
+
+    printf("%4u %9.1f %7.1f %7.1f %5.1f %5.1f %7.1f %5.2f ", rank,
+           meanScore(candidate), total->altIae / n, total->yawIae / n,
+           total->altOvershoot / n, total->yawOvershoot / n,
+           total->effort / n, total->landing / n);
+    for (i = 0; i < NUM_GAINS; i++) {
+        printf(" %8.4g", candidate->gains[i]);
+    }
+    printf("%s\n", candidate->builtIn ? "  (built in)" : "");
+}
+
+static void printTable(candidate_t *ranked, uint32_t count)
+{
+    uint32_t i;
+
+    printf("rank      cost alt_iae yaw_iae alt_%% yaw_%%  effort  land ");
+    for (i = 0; i < NUM_GAINS; i++) {
+        printf(" %8s", gainNames[i]);
+    }
+    printf("\n");
+    for (i = 0; i < count && i < showCount; i++) {
+        printCandidate(i + 1, &ranked[i]);
+    }
+    for (; i < count; i++) {
+        if (ranked[i].builtIn) {
+            printCandidate(i + 1, &ranked[i]);
+        }
+    }
+}
+
+static void writeHeader(const candidate_t *best, const candidate_t *builtIn)
+{
+    FILE *out = fopen(headerPath, "w");
+    char value[32];
+    uint32_t i;
+
+    if (!out) {
+        perror(headerPath);
+        exit(1);
+    }
+    fprintf(out,
+        "//*****************************************************************************\n"
+        "//\n"
+        "// pid_gains.h - Gains of the altitude and yaw PID controllers, from\n"
+        "//               host/tune. Mean cost %.1f over %u trial rigs with a\n"
+        "//               %g spread, against %.1f for the gains it replaces.\n"
+        "//\n"
+        "//*****************************************************************************\n"
+        "\n"
+        "#ifndef PID_GAINS_H_\n"
+        "#define PID_GAINS_H_\n"
+        "\n",
+        meanScore(best), numTrials, spread, meanScore(builtIn));
+    for (i = 0; i < NUM_GAINS; i++) {
+        // A whole number needs a point to be a float constant
+        snprintf(value, sizeof(value), "%.6g", best->gains[i]);
+        fprintf(out, "#define %s %s%sf\n", headerNames[i], value,
+                strpbrk(value, ".e") ? "" : ".0");
+    }
+    fprintf(out, "\n#endif /* PID_GAINS_H_ */\n");
+    fclose(out);
+}
+
+//*****************************************************************************
+// Search. Each generation flies a population spread about the best gains so
+// far, by a factor that narrows from generation to generation.
+//*****************************************************************************
+static candidate_t *search(uint32_t *count)
+{
+    candidate_t *all = calloc(population * generations + 1, sizeof(*all));
+    candidate_t *best = &all[0];
+    uint32_t flown = 1;
+    double sigma = 0.7;         // Standard deviation of the log of the factor
+    uint32_t g;
+    uint32_t c;
+    uint32_t i;
+
+    flyBuiltIn(&all[0]);
+    for (g = 0; g < generations; g++) {
+        candidate_t *generation = &all[flown];
+
+        for (c = 0; c < population; c++) {
+            for (i = 0; i < NUM_GAINS; i++) {
+                generation[c].gains[i] = best->gains[i]
+                    * exp(sigma * gaussian());
+            }
+        }
+        flyAll(generation, population);
+        flown += population;
+        for (c = 0; c < population; c++) {
+            if (meanScore(&generation[c]) < meanScore(best)) {
+                best = &generation[c];
+            }
+        }
+        fprintf(stderr, "tune: generation %u best %.1f, %u flights\n",
+                g + 1, meanScore(best), flights);
+        sigma *= 0.75;
+    }
+    *count = flown;
+    return all;
+}
+
+//*****************************************************************************
+// Sweep. The spec is "name=first:last:steps,...", stepping each named gain
+// geometrically; the other gains stay at their built in values.
+//*****************************************************************************
+static candidate_t *sweep(uint32_t *count)
+{
+    float first[NUM_GAINS];
+    float last[NUM_GAINS];
+    uint32_t steps[NUM_GAINS];
+    const char *spec = sweepSpec;
+    candidate_t builtIn = {{0}};
+    candidate_t *all;
+    uint32_t total = 1;
+    uint32_t c;
+    uint32_t i;
+
+    for (i = 0; i < NUM_GAINS; i++) {
+        steps[i] = 1;
+    }
+    while (*spec) {
+        char name[16];
+        float from, to;
+        unsigned n;
+        int used;
+
+        if (sscanf(spec, " %15[a-z_]=%f:%f:%u%n", name, &from, &to, &n,
+                   &used) != 4 || n == 0 || from <= 0 || to <= 0) {
+            fprintf(stderr, "tune: bad sweep at \"%s\"\n", spec);
+            exit(2);
+        }
+        for (i = 0; i < NUM_GAINS && strcmp(name, gainNames[i]) != 0; i++) {
+        }
+        if (i == NUM_GAINS) {
+            fprintf(stderr, "tune: unknown gain \"%s\"\n", name);
+            exit(2);
+        }
+        first[i] = from;
+        last[i] = to;
+        steps[i] = n;
+        spec += used;
+        spec += strspn(spec, " ,");
+    }
+
+    flyBuiltIn(&builtIn);
+    for (i = 0; i < NUM_GAINS; i++) {
+        total *= steps[i];
+    }
+    all = calloc(total + 1, sizeof(*all));
+    all[0] = builtIn;
+    for (c = 0; c < total; c++) {
+        uint32_t index = c;
+        for (i = 0; i < NUM_GAINS; i++) {
+            uint32_t step = index % steps[i];
+            index /= steps[i];
+            all[c + 1].gains[i] = steps[i] == 1 ? builtIn.gains[i]
+                : first[i] * pow(last[i] / first[i],
+                                 (double)step / (steps[i] - 1));
+        }
+    }
+    flyAll(&all[1], total);
+    *count = total + 1;
+    return all;
+}
+
+//*****************************************************************************
+// Weights, from "alt_iae=1,yaw_iae=0.2,overshoot=2,effort=0.01,landing=5"
+//*****************************************************************************
+static void parseWeights(const char *text)
+{
+    char name[16];
+    float value;
+    int used;
+
+    while (sscanf(text, " %15[a-z_]=%f%n", name, &value, &used) == 2) {
+        if (strcmp(name, "alt_iae") == 0) {
+            weights.altIae = value;
+        } else if (strcmp(name, "yaw_iae") == 0) {
+            weights.yawIae = value;
+        } else if (strcmp(name, "overshoot") == 0) {
+            weights.overshoot = value;
+        } else if (strcmp(name, "effort") == 0) {
+            weights.effort = value;
+        } else if (strcmp(name, "landing") == 0) {
+            weights.landing = value;
+        } else {
+            fprintf(stderr, "tune: unknown weight \"%s\"\n", name);
+            exit(2);
+        }
+        text += used;
+        text += strspn(text, " ,");
+    }
+    if (*text) {
+        fprintf(stderr, "tune: bad weight at \"%s\"\n", text);
+        exit(2);
+    }
+}
+
+static void usage(const char *name, int status)
+{
+    fprintf(status ? stderr : stdout,
+        "usage: %s [options]\n"
+        "  -x path     heli_sim to fly (default: next to this program)\n"
+        "  -j jobs     flights at once (default: one per core)\n"
+        "  -t trials   trial rigs each gain set is flown on (default 8)\n"
+        "  -p count    gain sets per search generation (default 32)\n"
+        "  -g count    search generations (default 8)\n"
+        "  -s spec     sweep name=first:last:steps,... instead of searching\n"
+        "  -d spread   random spread of the rig parameters (default 0.15)\n"
+        "  -S seconds  length of each flight (default 75)\n"
+        "  -r seed     seed of the trial rigs and the search (default 1)\n"
+        "  -w weights  cost weights, alt_iae, yaw_iae, overshoot, effort\n"
+        "              and landing (default 1,0.2,2,0.01,5)\n"
+        "  -n count    gain sets listed (default 10)\n"
+        "  -o file     header written with the best gains (default pid_gains.h)\n"
+        "  -h          show this list\n",
+        name);
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    candidate_t *all;
+    candidate_t builtIn;
+    uint32_t count;
+    int opt;
+
+    numJobs = sysconf(_SC_NPROCESSORS_ONLN);
+    while ((opt = getopt(argc, argv, "x:j:t:p:g:s:d:S:r:w:n:o:h")) != -1) {
+        switch (opt) {
+            case 'x': simPath = optarg; break;
+            case 'j': numJobs = atoi(optarg); break;
+            case 't': numTrials = atoi(optarg); break;
+            case 'p': population = atoi(optarg); break;
+            case 'g': generations = atoi(optarg); break;
+            case 's': sweepSpec = optarg; break;
+            case 'd': spread = atof(optarg); break;
+            case 'S': seconds = atoi(optarg); break;
+            case 'r': seed = atoi(optarg); break;
+            case 'w': parseWeights(optarg); break;
+            case 'n': showCount = atoi(optarg); break;
+            case 'o': headerPath = optarg; break;
+            case 'h': usage(argv[0], 0);
+            default: usage(argv[0], 2);
+        }
+    }
+    if (optind != argc || numTrials == 0 || population == 0) {
+        usage(argv[0], 2);
+    }
+    if (numJobs < 1 || numJobs > MAX_JOBS) {
+        numJobs = numJobs < 1 ? 1 : MAX_JOBS;
+    }
+    if (!simPath) {
+        const char *slash = strrchr(argv[0], '/');
+        int dirLength = slash ? (int)(slash - argv[0] + 1) : 0;
+        char *path = malloc(dirLength + sizeof("heli_sim") + 2);
+
+        sprintf(path, "%s%.*sheli_sim", slash ? "" : "./", dirLength, argv[0]);
+        simPath = path;
+    }
+    rngState = (seed + 1ull) * 0x9E3779B97F4A7C15ull;
+
+    all = sweepSpec ? sweep(&count) : search(&count);
+    builtIn = all[0];
+    qsort(all, count, sizeof(*all), compareCandidates);
+    printTable(all, count);
+    writeHeader(&all[0], &builtIn);
+    fprintf(stderr, "tune: %u flights, best gains written to %s\n", flights,
+            headerPath);
+    return 0;
+}
@@ -0,0 +1,57 @@
+//*****************************************************************************
+//
+// telem2csv.c - Converts a captured telemetry byte stream to CSV
+//
+// Usage:  telem2csv [capture.bin] > telemetry.csv
+//
+// Reads the raw bytes received from the rig's UART0 (for example captured
+// with "cat /dev/ttyACM0 > capture.bin" after setting the port to raw mode
+// with stty) from the named file, or standard input, and writes one CSV row
+// per good frame. Error counts are reported on standard error.
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <stdio.h>
+#include "telem_decoder.h"
+
+int main(int argc, char *argv[]) {
+    FILE *in = stdin;
+    telemDecoder_t dec;
+    telemFrame_t frame;
+    int c;
+
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [capture.bin]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2 && !(in = fopen(argv[1], "rb"))) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    telemDecoderInit(&dec);
+    printf("sequence,time_ms,state,alt_setpoint,alt_pct,yaw_setpoint,yaw_deg,"
+           "main_duty,tail_duty,alt_error,alt_integral,alt_derivative,"
+           "yaw_error,yaw_integral,yaw_derivative,overruns\n");
+    while ((c = getc(in)) != EOF) {
+        if (telemDecoderPush(&dec, c, &frame)) {
+            printf("%u,%u,%u,%d,%d,%d,%.1f,%u,%u,%g,%g,%g,%g,%g,%g,%u\n",
+                   frame.sequence, frame.timeMs, frame.state,
+                   frame.altSetpoint, frame.altPercent,
+                   frame.yawSetpoint, frame.yawTenths / 10.0,
+                   frame.mainDuty, frame.tailDuty,
+                   frame.altError, frame.altIntegral, frame.altDerivative,
+                   frame.yawError, frame.yawIntegral, frame.yawDerivative,
+                   frame.overruns);
+        }
+    }
+
+    fprintf(stderr, "%u frames, %u bad, %u lost, %u unknown version\n",
+            dec.frames, dec.badFrames, dec.lostFrames, dec.badVersion);
+    if (in != stdin) {
+        fclose(in);
+    }
+    return 0;
+}
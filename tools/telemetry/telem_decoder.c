@@ -0,0 +1,69 @@
+//*****************************************************************************
+//
+// telem_decoder.c - Splits a captured UART byte stream on the zero frame
+//                   delimiters and decodes the telemetry frames
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+#include <string.h>
+#include "telem_decoder.h"
+
+//*****************************************************************************
+// Reset the decoder and its counts
+//*****************************************************************************
+void telemDecoderInit(telemDecoder_t *dec) {
+    memset(dec, 0, sizeof(*dec));
+}
+
+//*****************************************************************************
+// Collect bytes up to a delimiter, then decode them. Anything before the
+// first delimiter may be the tail of a frame, so it is dropped quietly.
+//*****************************************************************************
+bool telemDecoderPush(telemDecoder_t *dec, uint8_t byte, telemFrame_t *frame) {
+    telemResult_t result = TELEM_BAD_FRAME;
+    bool run;
+    uint16_t gap;
+
+    if (byte != 0) {
+        if (dec->len < TELEM_DECODER_BUF_SIZE) {
+            dec->buf[dec->len++] = byte;
+        } else {
+            dec->overflow = true;
+        }
+        return false;
+    }
+
+    run = dec->synced && dec->len;
+    if (run && !dec->overflow) {
+        result = telemDecode(dec->buf, dec->len, frame);
+    }
+    dec->synced = true;
+    dec->len = 0;
+    dec->overflow = false;
+    if (!run) {
+        return false;
+    }
+    if (result == TELEM_BAD_VERSION) {
+        dec->badVersion++;
+        return false;
+    }
+    if (result != TELEM_OK) {
+        dec->badFrames++;
+        return false;
+    }
+
+    // A sequence number that jumps backwards means the rig was reset, not
+    // that frames were lost.
+    if (dec->haveSequence) {
+        gap = frame->sequence - dec->lastSequence - 1;
+        if (gap < 0x8000) {
+            dec->lostFrames += gap;
+        }
+    }
+    dec->haveSequence = true;
+    dec->lastSequence = frame->sequence;
+    dec->frames++;
+    return true;
+}
@@ -0,0 +1,47 @@
+//*****************************************************************************
+//
+// telem_decoder.h - Header file for reassembling telemetry frames from a
+//                   captured UART byte stream on a PC
+//
+// Authors:  Kate Chamberlin, Josh Lowe, Robert Loomes
+// Last modified:  02/06/2018
+//
+//*****************************************************************************
+
+#ifndef TELEM_DECODER_H_
+#define TELEM_DECODER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "telemetry_frame.h"
+
+#define TELEM_DECODER_BUF_SIZE 256  // Longer runs between delimiters are junk
+
+//*****************************************************************************
+// Stream decoder state and error counts
+//*****************************************************************************
+typedef struct {
+    uint8_t buf[TELEM_DECODER_BUF_SIZE];
+    uint32_t len;
+    bool overflow;          // Current run is too long to be a frame
+    bool synced;            // A delimiter has been seen
+    uint32_t frames;        // Good frames decoded
+    uint32_t badFrames;     // Runs that failed COBS, length or CRC checks
+    uint32_t lostFrames;    // Gaps in the sequence numbers
+    uint32_t badVersion;    // Frames of a version this decoder does not know
+    bool haveSequence;
+    uint16_t lastSequence;
+} telemDecoder_t;
+
+//*****************************************************************************
+// Reset the decoder and its counts
+//*****************************************************************************
+void telemDecoderInit(telemDecoder_t *dec);
+
+//*****************************************************************************
+// Feed one received byte. Returns true when it completes a good frame, which
+// is written to frame.
+//*****************************************************************************
+bool telemDecoderPush(telemDecoder_t *dec, uint8_t byte, telemFrame_t *frame);
+
+#endif /* TELEM_DECODER_H_ */